@@ -619,6 +619,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   g_type_class_ref (gst_debug_color_flags_get_type ());
   g_type_class_ref (gst_iterator_result_get_type ());
   g_type_class_ref (gst_iterator_item_get_type ());
+  g_type_class_ref (gst_atomic_queue_flags_get_type ());
   g_type_class_ref (gst_message_type_get_type ());
   g_type_class_ref (gst_mini_object_flags_get_type ());
   g_type_class_ref (gst_pad_link_return_get_type ());
@@ -667,6 +668,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   g_type_class_ref (gst_control_source_get_type ());
   g_type_class_ref (gst_lock_flags_get_type ());
   g_type_class_ref (gst_allocator_flags_get_type ());
+  g_type_class_ref (gst_mmap_allocator_flags_get_type ());
   g_type_class_ref (gst_stream_flags_get_type ());
 
   _priv_gst_event_initialize ();
@@ -964,6 +966,7 @@ gst_deinit (void)
   gst_object_unref (clock);
 
   _priv_gst_registry_cleanup ();
+  _priv_gst_caps_cleanup ();
 
 #ifndef GST_DISABLE_TRACE
   _priv_gst_alloc_trace_deinit ();
@@ -1014,6 +1017,7 @@ gst_deinit (void)
   g_type_class_unref (g_type_class_peek (gst_debug_color_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_iterator_result_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_iterator_item_get_type ()));
+  g_type_class_unref (g_type_class_peek (gst_atomic_queue_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_message_type_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_meta_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_mini_object_flags_get_type ()));
@@ -1060,6 +1064,8 @@ gst_deinit (void)
   g_type_class_unref (g_type_class_peek (gst_toc_entry_type_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_lock_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_allocator_flags_get_type ()));
+  g_type_class_unref (g_type_class_peek (gst_mmap_allocator_flags_get_type
+          ()));
   g_type_class_unref (g_type_class_peek (gst_stream_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_debug_color_mode_get_type ()));
 
@@ -105,6 +105,7 @@ G_GNUC_INTERNAL  void  _priv_gst_buffer_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_buffer_list_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_structure_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_initialize (void);
+G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_event_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_format_initialize (void);
@@ -119,6 +120,15 @@ G_GNUC_INTERNAL  void  _priv_gst_value_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_debug_init (void);
 G_GNUC_INTERNAL  void  _priv_gst_context_initialize (void);
 
+/* release a batch of buffers to their pool */
+G_GNUC_INTERNAL  gboolean _priv_gst_buffer_can_release_batched (GstBuffer * buffer);
+G_GNUC_INTERNAL  void  _priv_gst_buffer_pool_release_buffers (GstBufferPool * pool,
+    GstBuffer ** buffers, guint n_buffers);
+
+/* meta API ids, used by GstBuffer for constant time meta lookups. 0 is
+ * returned for APIs without an id */
+G_GNUC_INTERNAL  guint _priv_gst_meta_api_get_id (GType api);
+
 /* Private registry functions */
 G_GNUC_INTERNAL
 gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
@@ -146,6 +156,18 @@ gboolean priv_gst_structure_parse_name (gchar * str, gchar **start, gchar ** end
 G_GNUC_INTERNAL
 gboolean priv_gst_structure_parse_fields (gchar *str, gchar ** end, GstStructure *structure);
 
+/* binary serialization, implemented in gstvalue.c */
+#define GST_BINARY_KIND_VALUE     'v'
+#define GST_BINARY_KIND_STRUCTURE 's'
+#define GST_BINARY_KIND_CAPS      'c'
+#define GST_BINARY_KIND_TAG_LIST  't'
+
+G_GNUC_INTERNAL
+guint8 * _priv_gst_binary_serialize   (gchar kind, gconstpointer object, gsize * size);
+
+G_GNUC_INTERNAL
+gpointer _priv_gst_binary_deserialize (gchar kind, const guint8 * data, gsize size, GValue * value);
+
 /* registry cache backends */
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const char *location);
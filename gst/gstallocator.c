@@ -36,6 +36,20 @@
  * New memory can be created with gst_memory_new_wrapped() that wraps the memory
  * allocated elsewhere.
  *
+ * Next to the default system memory allocator, an allocator with the name
+ * #GST_ALLOCATOR_SLAB is registered. It recycles freed memory blocks in
+ * per-size-class free lists and per-thread caches instead of returning them
+ * to the system and can be used for workloads that allocate many small
+ * memory blocks. It can be retrieved with gst_allocator_find() and made the
+ * default allocator with gst_allocator_set_default().
+ *
+ * On systems with mmap(), an allocator with the name #GST_ALLOCATOR_MMAP is
+ * registered that maps memory directly from the kernel. Allocators created
+ * with gst_mmap_allocator_new() can back the memory with huge pages or with
+ * a memfd that can be shared with other processes with
+ * gst_mmap_memory_get_fd(). This is mostly interesting for large video
+ * frames.
+ *
  * Last reviewed on 2012-07-09 (0.11.3)
  */
 
@@ -45,6 +59,18 @@
 
 #include "gst_private.h"
 #include "gstmemory.h"
+#include "gstatomicqueue.h"
+
+#ifdef HAVE_MMAP
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
 
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
@@ -74,6 +100,12 @@ static GstAllocator *_default_allocator;
 
 static GstAllocator *_sysmem_allocator;
 
+static GstAllocator *_slab_allocator;
+
+#ifdef HAVE_MMAP
+static GstAllocator *_mmap_allocator;
+#endif
+
 /* registered allocators */
 static GRWLock lock;
 static GHashTable *allocators;
@@ -158,6 +190,48 @@ gst_allocation_params_init (GstAllocationParams * params)
   memset (params, 0, sizeof (GstAllocationParams));
 }
 
+/**
+ * gst_allocation_params_set_numa_node:
+ * @params: a #GstAllocationParams
+ * @node: a NUMA node or -1
+ *
+ * Request memory allocated with @params to be placed on NUMA @node. Use -1
+ * to let the system decide, which is the default.
+ *
+ * Only allocators that map memory directly, such as the #GST_ALLOCATOR_MMAP
+ * allocator, can honour this request. Other allocators ignore it.
+ *
+ * Since: 1.2
+ */
+void
+gst_allocation_params_set_numa_node (GstAllocationParams * params, gint node)
+{
+  g_return_if_fail (params != NULL);
+  g_return_if_fail (node >= -1);
+
+  /* stored with an offset of 1 so that zeroed params mean no node */
+  params->ABI.abi.numa_node = node + 1;
+}
+
+/**
+ * gst_allocation_params_get_numa_node:
+ * @params: a #GstAllocationParams
+ *
+ * Get the NUMA node that was requested with
+ * gst_allocation_params_set_numa_node().
+ *
+ * Returns: the NUMA node or -1 when no node was requested.
+ *
+ * Since: 1.2
+ */
+gint
+gst_allocation_params_get_numa_node (const GstAllocationParams * params)
+{
+  g_return_val_if_fail (params != NULL, -1);
+
+  return params->ABI.abi.numa_node - 1;
+}
+
 /**
  * gst_allocation_params_copy:
  * @params: (transfer none): a #GstAllocationParams
@@ -364,13 +438,13 @@ G_DEFINE_TYPE (GstAllocatorSysmem, gst_allocator_sysmem, GST_TYPE_ALLOCATOR);
 
 /* initialize the fields */
 static inline void
-_sysmem_init (GstMemorySystem * mem, GstMemoryFlags flags,
-    GstMemory * parent, gsize slice_size,
+_sysmem_init (GstMemorySystem * mem, GstAllocator * allocator,
+    GstMemoryFlags flags, GstMemory * parent, gsize slice_size,
     gpointer data, gsize maxsize, gsize align, gsize offset, gsize size,
     gpointer user_data, GDestroyNotify notify)
 {
   gst_memory_init (GST_MEMORY_CAST (mem),
-      flags, _sysmem_allocator, parent, maxsize, align, offset, size);
+      flags, allocator, parent, maxsize, align, offset, size);
 
   mem->slice_size = slice_size;
   mem->data = data;
@@ -390,32 +464,23 @@ _sysmem_new (GstMemoryFlags flags,
   slice_size = sizeof (GstMemorySystem);
 
   mem = g_slice_alloc (slice_size);
-  _sysmem_init (mem, flags, parent, slice_size,
+  _sysmem_init (mem, _sysmem_allocator, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
   return mem;
 }
 
-/* allocate the memory and structure in one block */
-static GstMemorySystem *
-_sysmem_new_block (GstMemoryFlags flags,
-    gsize maxsize, gsize align, gsize offset, gsize size)
+/* initialize a memory block of @slice_size bytes with the structure at the
+ * start, followed by the data. @maxsize includes the extra bytes needed for
+ * @align. */
+static void
+_sysmem_init_block (GstMemorySystem * mem, GstAllocator * allocator,
+    gsize slice_size, GstMemoryFlags flags, gsize maxsize, gsize align,
+    gsize offset, gsize size)
 {
-  GstMemorySystem *mem;
-  gsize aoffset, slice_size, padding;
+  gsize aoffset, padding;
   guint8 *data;
 
-  /* ensure configured alignment */
-  align |= gst_memory_alignment;
-  /* allocate more to compensate for alignment */
-  maxsize += align;
-  /* alloc header and data in one block */
-  slice_size = sizeof (GstMemorySystem) + maxsize;
-
-  mem = g_slice_alloc (slice_size);
-  if (mem == NULL)
-    return NULL;
-
   data = (guint8 *) mem + sizeof (GstMemorySystem);
 
   /* do alignment */
@@ -432,8 +497,31 @@ _sysmem_new_block (GstMemoryFlags flags,
   if (padding && (flags & GST_MEMORY_FLAG_ZERO_PADDED))
     memset (data + offset + size, 0, padding);
 
-  _sysmem_init (mem, flags, NULL, slice_size, data, maxsize,
+  _sysmem_init (mem, allocator, flags, NULL, slice_size, data, maxsize,
       align, offset, size, NULL, NULL);
+}
+
+/* allocate the memory and structure in one block */
+static GstMemorySystem *
+_sysmem_new_block (GstMemoryFlags flags,
+    gsize maxsize, gsize align, gsize offset, gsize size)
+{
+  GstMemorySystem *mem;
+  gsize slice_size;
+
+  /* ensure configured alignment */
+  align |= gst_memory_alignment;
+  /* allocate more to compensate for alignment */
+  maxsize += align;
+  /* alloc header and data in one block */
+  slice_size = sizeof (GstMemorySystem) + maxsize;
+
+  mem = g_slice_alloc (slice_size);
+  if (mem == NULL)
+    return NULL;
+
+  _sysmem_init_block (mem, _sysmem_allocator, slice_size, flags, maxsize,
+      align, offset, size);
 
   return mem;
 }
@@ -570,6 +658,811 @@ gst_allocator_sysmem_init (GstAllocatorSysmem * allocator)
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
 }
 
+/* slab memory implementation. The data of the memory blocks, including
+ * prefix, padding and alignment, is rounded up to a power of 2 size class
+ * and the blocks are recycled in per-class free lists. Freed blocks are first
+ * kept in a small per-thread cache, which is refilled from and flushed to the
+ * global free lists. Blocks with more data than the largest class are
+ * allocated with g_slice like the system memory.
+ *
+ * The memory uses the same layout as the system memory, slice_size contains
+ * the size of the block, which is the size of the class plus the
+ * GstMemorySystem header. */
+#define SLAB_MIN_SHIFT          6
+#define SLAB_MAX_SHIFT          16
+#define SLAB_N_CLASSES          (SLAB_MAX_SHIFT - SLAB_MIN_SHIFT + 1)
+#define SLAB_MAX_SIZE           (1 << SLAB_MAX_SHIFT)
+#define SLAB_CLASS_SIZE(c)      (1 << ((c) + SLAB_MIN_SHIFT))
+#define SLAB_BLOCK_SIZE(c)      (sizeof (GstMemorySystem) + SLAB_CLASS_SIZE (c))
+/* number of blocks per class in a thread cache */
+#define SLAB_CACHE_SIZE         16
+/* max number of blocks per class in the global free list */
+#define SLAB_MAX_FREE           256
+
+typedef struct
+{
+  GstAllocator parent;
+
+  GstAtomicQueue *free_blocks[SLAB_N_CLASSES];
+  /* number of blocks in, or about to be pushed to, free_blocks */
+  gint n_free[SLAB_N_CLASSES];
+} GstAllocatorSlab;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstAllocatorSlabClass;
+
+typedef struct
+{
+  guint n_blocks[SLAB_N_CLASSES];
+  gpointer blocks[SLAB_N_CLASSES][SLAB_CACHE_SIZE];
+} GstSlabThreadCache;
+
+GType gst_allocator_slab_get_type (void);
+G_DEFINE_TYPE (GstAllocatorSlab, gst_allocator_slab, GST_TYPE_ALLOCATOR);
+
+static void _slab_thread_cache_free (GstSlabThreadCache * cache);
+
+static GPrivate slab_thread_cache =
+G_PRIVATE_INIT ((GDestroyNotify) _slab_thread_cache_free);
+
+/* the class of the blocks that hold @size bytes of data, @size must not be
+ * bigger than SLAB_MAX_SIZE */
+static inline guint
+_slab_class_for_size (gsize size)
+{
+  if (size <= SLAB_CLASS_SIZE (0))
+    return 0;
+  return g_bit_storage (size - 1) - SLAB_MIN_SHIFT;
+}
+
+/* return a block to the global free list of @cls */
+static void
+_slab_block_release (guint cls, gpointer block)
+{
+  GstAllocatorSlab *slab = (GstAllocatorSlab *) _slab_allocator;
+
+  /* reserve a place in the free list first so that concurrent releases
+   * can't push it over the limit */
+  if (g_atomic_int_add (&slab->n_free[cls], 1) < SLAB_MAX_FREE) {
+    gst_atomic_queue_push (slab->free_blocks[cls], block);
+  } else {
+    g_atomic_int_add (&slab->n_free[cls], -1);
+    g_free (block);
+  }
+}
+
+static void
+_slab_thread_cache_free (GstSlabThreadCache * cache)
+{
+  guint i;
+
+  for (i = 0; i < SLAB_N_CLASSES; i++) {
+    while (cache->n_blocks[i] > 0)
+      _slab_block_release (i, cache->blocks[i][--cache->n_blocks[i]]);
+  }
+  g_slice_free (GstSlabThreadCache, cache);
+}
+
+static inline GstSlabThreadCache *
+_slab_get_thread_cache (void)
+{
+  GstSlabThreadCache *cache;
+
+  cache = g_private_get (&slab_thread_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_slice_new0 (GstSlabThreadCache);
+    g_private_set (&slab_thread_cache, cache);
+  }
+  return cache;
+}
+
+static gpointer
+_slab_block_alloc (guint cls)
+{
+  GstAllocatorSlab *slab = (GstAllocatorSlab *) _slab_allocator;
+  GstSlabThreadCache *cache;
+  gpointer block;
+
+  cache = _slab_get_thread_cache ();
+  if (cache->n_blocks[cls] > 0)
+    return cache->blocks[cls][--cache->n_blocks[cls]];
+
+  if ((block = gst_atomic_queue_pop (slab->free_blocks[cls]))) {
+    g_atomic_int_add (&slab->n_free[cls], -1);
+    return block;
+  }
+
+  return g_malloc (SLAB_BLOCK_SIZE (cls));
+}
+
+static void
+_slab_block_free (guint cls, gpointer block)
+{
+  GstSlabThreadCache *cache;
+
+  cache = _slab_get_thread_cache ();
+  if (cache->n_blocks[cls] == SLAB_CACHE_SIZE) {
+    /* full, move half of the cache to the global free list */
+    while (cache->n_blocks[cls] > SLAB_CACHE_SIZE / 2)
+      _slab_block_release (cls, cache->blocks[cls][--cache->n_blocks[cls]]);
+  }
+  cache->blocks[cls][cache->n_blocks[cls]++] = block;
+}
+
+static GstMemorySystem *
+_slab_new_block (GstMemoryFlags flags, gsize maxsize, gsize align,
+    gsize offset, gsize size)
+{
+  GstMemorySystem *mem;
+  gsize slice_size;
+
+  /* ensure configured alignment */
+  align |= gst_memory_alignment;
+  /* allocate more to compensate for alignment */
+  maxsize += align;
+
+  if (maxsize <= SLAB_MAX_SIZE) {
+    guint cls = _slab_class_for_size (maxsize);
+
+    /* we can use the complete block */
+    maxsize = SLAB_CLASS_SIZE (cls);
+    slice_size = SLAB_BLOCK_SIZE (cls);
+    mem = _slab_block_alloc (cls);
+  } else {
+    slice_size = sizeof (GstMemorySystem) + maxsize;
+    mem = g_slice_alloc (slice_size);
+  }
+  if (mem == NULL)
+    return NULL;
+
+  _sysmem_init_block (mem, _slab_allocator, slice_size, flags, maxsize,
+      align, offset, size);
+
+  return mem;
+}
+
+static GstMemorySystem *
+_slab_copy (GstMemorySystem * mem, gssize offset, gsize size)
+{
+  GstMemorySystem *copy;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  copy = _slab_new_block (0, size, mem->mem.align, 0, size);
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
+  memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+
+  return copy;
+}
+
+static GstMemory *
+slab_alloc (GstAllocator * allocator, gsize size, GstAllocationParams * params)
+{
+  gsize maxsize = size + params->prefix + params->padding;
+
+  return (GstMemory *) _slab_new_block (params->flags,
+      maxsize, params->align, params->prefix, size);
+}
+
+static void
+slab_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstMemorySystem *dmem = (GstMemorySystem *) mem;
+  gsize slice_size;
+
+  slice_size = dmem->slice_size;
+
+#ifdef USE_POISONING
+  /* just poison the structs, not all the data */
+  memset (mem, 0xff, sizeof (GstMemorySystem));
+#endif
+
+  if (slice_size <= SLAB_BLOCK_SIZE (SLAB_N_CLASSES - 1))
+    _slab_block_free (_slab_class_for_size (slice_size -
+            sizeof (GstMemorySystem)), mem);
+  else
+    g_slice_free1 (slice_size, mem);
+}
+
+static void
+gst_allocator_slab_finalize (GObject * obj)
+{
+  g_warning ("The slab memory allocator was freed!");
+}
+
+static void
+gst_allocator_slab_class_init (GstAllocatorSlabClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstAllocatorClass *allocator_class;
+
+  gobject_class = (GObjectClass *) klass;
+  allocator_class = (GstAllocatorClass *) klass;
+
+  gobject_class->finalize = gst_allocator_slab_finalize;
+
+  allocator_class->alloc = slab_alloc;
+  allocator_class->free = slab_free;
+}
+
+static void
+gst_allocator_slab_init (GstAllocatorSlab * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+  guint i;
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "init allocator %p", allocator);
+
+  for (i = 0; i < SLAB_N_CLASSES; i++)
+    allocator->free_blocks[i] = gst_atomic_queue_new (SLAB_CACHE_SIZE);
+
+  alloc->mem_type = GST_ALLOCATOR_SYSMEM;
+  alloc->mem_map = (GstMemoryMapFunction) _sysmem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _sysmem_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _slab_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _sysmem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
+}
+
+#ifdef HAVE_MMAP
+/* mmap memory implementation */
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+
+/* the default huge page size on most platforms */
+#define HUGE_PAGE_SIZE  (2 * 1024 * 1024)
+
+/* memory policies from linux/mempolicy.h */
+#define MPOL_PREFERRED  1
+#define MPOL_F_NODE     (1 << 0)
+#define MPOL_F_ADDR     (1 << 1)
+#define MAX_NUMA_NODES  64
+
+#define ROUND_UP(n,a)   (((n) + (a) - 1) & ~((gsize) (a) - 1))
+
+typedef struct
+{
+  GstMemory mem;
+
+  /* the mapping, NULL for sub memory */
+  guint8 *map;
+  gsize map_size;
+  guint8 *data;
+  gint fd;
+} GstMemoryMmap;
+
+typedef struct
+{
+  guint64 allocated;
+  /* bytes of the allocations whose first page is on the node, only the
+   * first page is checked so that we don't fault in the whole mapping */
+  guint64 first_page_local;
+} GstMmapNumaStats;
+
+typedef struct
+{
+  GstAllocator parent;
+
+  GstMmapAllocatorFlags flags;
+
+  /* protected with the object lock */
+  GstMmapNumaStats numa_stats[MAX_NUMA_NODES];
+} GstAllocatorMmap;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstAllocatorMmapClass;
+
+GType gst_allocator_mmap_get_type (void);
+G_DEFINE_TYPE (GstAllocatorMmap, gst_allocator_mmap, GST_TYPE_ALLOCATOR);
+
+static gsize
+_mmap_page_size (void)
+{
+#ifdef HAVE_GETPAGESIZE
+  return getpagesize ();
+#else
+  return 4096;
+#endif
+}
+
+static gint
+_mmap_memfd_create (guint flags)
+{
+#if defined(HAVE_MEMFD_CREATE)
+  return memfd_create ("gst-mmap-memory", flags);
+#elif defined(__NR_memfd_create)
+  return syscall (__NR_memfd_create, "gst-mmap-memory", flags);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/* prefer placing the pages of @data on @node. This must be done before the
+ * pages are faulted in. */
+static void
+_mmap_numa_bind (gpointer data, gsize size, gint node)
+{
+#if defined(__linux__) && defined(__NR_mbind)
+  const guint bits = 8 * sizeof (gulong);
+  gulong nodemask[MAX_NUMA_NODES / (8 * sizeof (gulong))] = { 0, };
+
+  nodemask[node / bits] = 1UL << (node % bits);
+
+  if (syscall (__NR_mbind, data, size, MPOL_PREFERRED, nodemask,
+          MAX_NUMA_NODES + 1, 0) < 0)
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "mbind to node %d failed: %s", node,
+        g_strerror (errno));
+#endif
+}
+
+/* get the node of the page at @data, this faults the page in */
+static gint
+_mmap_numa_node_of (gpointer data)
+{
+#if defined(__linux__) && defined(__NR_get_mempolicy)
+  gint node = -1;
+
+  if (syscall (__NR_get_mempolicy, &node, NULL, 0, data,
+          MPOL_F_NODE | MPOL_F_ADDR) < 0)
+    return -1;
+
+  return node;
+#else
+  return -1;
+#endif
+}
+
+/* map @size bytes of a new memfd, returns MAP_FAILED on error */
+static gpointer
+_mmap_memfd (gsize size, gboolean huge, gint extra_flags, gint * fd)
+{
+  gpointer data;
+
+  *fd = _mmap_memfd_create (MFD_CLOEXEC | (huge ? MFD_HUGETLB : 0));
+  if (*fd < 0) {
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "memfd_create failed: %s",
+        g_strerror (errno));
+    return MAP_FAILED;
+  }
+
+  if (ftruncate (*fd, size) < 0)
+    goto failed;
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | extra_flags,
+      *fd, 0);
+  if (data == MAP_FAILED)
+    goto failed;
+
+  return data;
+
+failed:
+  {
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "failed to map memfd: %s",
+        g_strerror (errno));
+    close (*fd);
+    *fd = -1;
+    return MAP_FAILED;
+  }
+}
+
+/* map at least @map_size bytes following the flags of @allocator. Huge pages
+ * and memfd are tried first when requested, we fall back to plain anonymous
+ * memory when they are not available. */
+static guint8 *
+_mmap_map (GstAllocatorMmap * allocator, gsize * map_size, gint node,
+    gint * fd)
+{
+  GstMmapAllocatorFlags flags = allocator->flags;
+  gboolean huge, prefault;
+  gint extra_flags = 0;
+  gsize size, huge_size;
+  gpointer data = MAP_FAILED;
+
+  size = *map_size;
+  huge_size = ROUND_UP (size, HUGE_PAGE_SIZE);
+  /* only use huge pages when we don't waste too much memory */
+  huge = (flags & GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES) &&
+      size >= HUGE_PAGE_SIZE / 2;
+  prefault = (flags & GST_MMAP_ALLOCATOR_FLAG_PREFAULT) != 0;
+
+#ifdef MAP_POPULATE
+  /* we can't populate before binding to a node */
+  if (prefault && node < 0) {
+    extra_flags |= MAP_POPULATE;
+    prefault = FALSE;
+  }
+#endif
+
+  *fd = -1;
+  if (flags & GST_MMAP_ALLOCATOR_FLAG_MEMFD) {
+    if (huge && (data = _mmap_memfd (huge_size, TRUE, extra_flags,
+                fd)) != MAP_FAILED)
+      size = huge_size;
+    else
+      data = _mmap_memfd (size, FALSE, extra_flags, fd);
+  }
+#ifdef MAP_HUGETLB
+  if (data == MAP_FAILED && huge) {
+    data = mmap (NULL, huge_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | extra_flags, -1, 0);
+    if (data != MAP_FAILED)
+      size = huge_size;
+  }
+#endif
+  if (data == MAP_FAILED) {
+    data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    if (data == MAP_FAILED)
+      goto map_failed;
+#ifdef MADV_HUGEPAGE
+    /* no reserved huge pages, try transparent huge pages */
+    if (huge && *fd < 0)
+      madvise (data, size, MADV_HUGEPAGE);
+#endif
+  }
+
+  if (node >= 0)
+    _mmap_numa_bind (data, size, node);
+
+  if (prefault) {
+    gsize i, page_size = _mmap_page_size ();
+
+    for (i = 0; i < size; i += page_size)
+      ((volatile guint8 *) data)[i] = 0;
+  }
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "mapped %" G_GSIZE_FORMAT " bytes at %p, "
+      "fd %d", size, data, *fd);
+
+  *map_size = size;
+
+  return data;
+
+  /* ERRORS */
+map_failed:
+  {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "failed to map %" G_GSIZE_FORMAT
+        " bytes: %s", size, g_strerror (errno));
+    return NULL;
+  }
+}
+
+static GstMemoryMmap *
+_mmap_new_block (GstAllocatorMmap * allocator, GstMemoryFlags flags,
+    gsize maxsize, gsize align, gsize offset, gsize size, gint node)
+{
+  GstMemoryMmap *mem;
+  gsize aoffset, map_size, page_size;
+  guint8 *map, *data;
+  gint fd;
+
+  page_size = _mmap_page_size ();
+
+  /* ensure configured alignment, the mapping is page aligned so we only need
+   * to allocate more for bigger alignments */
+  align |= gst_memory_alignment;
+  if (align >= page_size)
+    maxsize += align;
+
+  map_size = ROUND_UP (maxsize, page_size);
+  if (!(map = _mmap_map (allocator, &map_size, node, &fd)))
+    return NULL;
+
+  if (node >= 0) {
+    gint actual = _mmap_numa_node_of (map);
+
+    GST_CAT_LOG (GST_CAT_MEMORY, "mapped %p on node %d, requested %d", map,
+        actual, node);
+
+    GST_OBJECT_LOCK (allocator);
+    allocator->numa_stats[node].allocated += map_size;
+    if (actual == node)
+      allocator->numa_stats[node].first_page_local += map_size;
+    GST_OBJECT_UNLOCK (allocator);
+  }
+
+  data = map;
+  if ((aoffset = ((guintptr) data & align)))
+    aoffset = (align + 1) - aoffset;
+  data += aoffset;
+
+  /* anonymous mappings and memfd are zero filled, no need to handle
+   * GST_MEMORY_FLAG_ZERO_PREFIXED and GST_MEMORY_FLAG_ZERO_PADDED */
+  mem = g_slice_new (GstMemoryMmap);
+  gst_memory_init (GST_MEMORY_CAST (mem), flags, (GstAllocator *) allocator,
+      NULL, map_size - aoffset, align, offset, size);
+  mem->map = map;
+  mem->map_size = map_size;
+  mem->data = data;
+  mem->fd = fd;
+
+  return mem;
+}
+
+static gpointer
+_mmap_mem_map (GstMemoryMmap * mem, gsize maxsize, GstMapFlags flags)
+{
+  return mem->data;
+}
+
+static gboolean
+_mmap_mem_unmap (GstMemoryMmap * mem)
+{
+  return TRUE;
+}
+
+static GstMemoryMmap *
+_mmap_mem_copy (GstMemoryMmap * mem, gssize offset, gsize size)
+{
+  GstMemoryMmap *copy;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  copy = _mmap_new_block ((GstAllocatorMmap *) mem->mem.allocator, 0, size,
+      mem->mem.align, 0, size, -1);
+  if (copy == NULL)
+    return NULL;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
+  memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+
+  return copy;
+}
+
+static GstMemoryMmap *
+_mmap_mem_share (GstMemoryMmap * mem, gssize offset, gsize size)
+{
+  GstMemoryMmap *sub;
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  /* the shared memory is always readonly */
+  sub = g_slice_new (GstMemoryMmap);
+  gst_memory_init (GST_MEMORY_CAST (sub),
+      GST_MINI_OBJECT_FLAGS (parent) | GST_MINI_OBJECT_FLAG_LOCK_READONLY,
+      mem->mem.allocator, parent, mem->mem.maxsize, mem->mem.align,
+      mem->mem.offset + offset, size);
+  sub->map = NULL;
+  sub->map_size = 0;
+  sub->data = mem->data;
+  sub->fd = -1;
+
+  return sub;
+}
+
+static gboolean
+_mmap_mem_is_span (GstMemoryMmap * mem1, GstMemoryMmap * mem2, gsize * offset)
+{
+  if (offset) {
+    GstMemoryMmap *parent;
+
+    parent = (GstMemoryMmap *) mem1->mem.parent;
+
+    *offset = mem1->mem.offset - parent->mem.offset;
+  }
+
+  /* and memory is contiguous */
+  return mem1->data + mem1->mem.offset + mem1->mem.size ==
+      mem2->data + mem2->mem.offset;
+}
+
+static GstMemory *
+mmap_alloc (GstAllocator * allocator, gsize size, GstAllocationParams * params)
+{
+  gsize maxsize = size + params->prefix + params->padding;
+  gint node;
+
+  node = gst_allocation_params_get_numa_node (params);
+  if (node >= MAX_NUMA_NODES)
+    node = -1;
+
+  return (GstMemory *) _mmap_new_block ((GstAllocatorMmap *) allocator,
+      params->flags, maxsize, params->align, params->prefix, size, node);
+}
+
+static void
+mmap_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstMemoryMmap *mmem = (GstMemoryMmap *) mem;
+
+  if (mmem->map) {
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "unmapping %" G_GSIZE_FORMAT " bytes at %p",
+        mmem->map_size, mmem->map);
+    munmap (mmem->map, mmem->map_size);
+    if (mmem->fd >= 0)
+      close (mmem->fd);
+  }
+  g_slice_free (GstMemoryMmap, mmem);
+}
+
+static void
+gst_allocator_mmap_class_init (GstAllocatorMmapClass * klass)
+{
+  GstAllocatorClass *allocator_class;
+
+  allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = mmap_alloc;
+  allocator_class->free = mmap_free;
+}
+
+static void
+gst_allocator_mmap_init (GstAllocatorMmap * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "init allocator %p", allocator);
+
+  alloc->mem_type = GST_ALLOCATOR_MMAP;
+  alloc->mem_map = (GstMemoryMapFunction) _mmap_mem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _mmap_mem_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _mmap_mem_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _mmap_mem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _mmap_mem_is_span;
+}
+#endif /* HAVE_MMAP */
+
+/**
+ * gst_mmap_allocator_new:
+ * @flags: #GstMmapAllocatorFlags
+ *
+ * Create a new allocator that maps memory directly from the kernel with
+ * mmap(). @flags control how the memory is backed. When the requested
+ * backing is not available, plain anonymous memory is used.
+ *
+ * Memory from this allocator can be used in a #GstBufferPool by configuring
+ * the allocator with gst_buffer_pool_config_set_allocator().
+ *
+ * Returns: (transfer full): a new #GstAllocator or %NULL when mmap() is not
+ * supported on this platform.
+ *
+ * Since: 1.2
+ */
+GstAllocator *
+gst_mmap_allocator_new (GstMmapAllocatorFlags flags)
+{
+#ifdef HAVE_MMAP
+  GstAllocatorMmap *allocator;
+
+  allocator = g_object_new (gst_allocator_mmap_get_type (), NULL);
+  allocator->flags = flags;
+
+  return (GstAllocator *) allocator;
+#else
+  return NULL;
+#endif
+}
+
+/**
+ * gst_is_mmap_memory:
+ * @mem: a #GstMemory
+ *
+ * Check if @mem was allocated by an allocator created with
+ * gst_mmap_allocator_new().
+ *
+ * Returns: %TRUE when @mem is mmap memory.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_is_mmap_memory (GstMemory * mem)
+{
+  g_return_val_if_fail (mem != NULL, FALSE);
+
+  return gst_memory_is_type (mem, GST_ALLOCATOR_MMAP);
+}
+
+/**
+ * gst_mmap_memory_get_fd:
+ * @mem: a #GstMemory
+ * @offset: (out) (allow-none): the offset of the data of @mem in the file
+ *
+ * Get the file descriptor of the memfd backing @mem. The file descriptor
+ * can be passed to other processes to share the memory without copying.
+ * The visible data of @mem starts at @offset in the file.
+ *
+ * The file descriptor is owned by @mem and remains valid as long as @mem
+ * is alive.
+ *
+ * Returns: the file descriptor or -1 when @mem is not backed by a memfd.
+ *
+ * Since: 1.2
+ */
+gint
+gst_mmap_memory_get_fd (GstMemory * mem, gsize * offset)
+{
+#ifdef HAVE_MMAP
+  GstMemoryMmap *mmem;
+
+  g_return_val_if_fail (mem != NULL, -1);
+
+  if (!gst_is_mmap_memory (mem))
+    return -1;
+
+  /* sub memory uses the mapping of the parent */
+  mmem = (GstMemoryMmap *) (mem->parent ? mem->parent : mem);
+  if (offset)
+    *offset = (mmem->data - mmem->map) + mem->offset;
+
+  return mmem->fd;
+#else
+  return -1;
+#endif
+}
+
+/**
+ * gst_mmap_allocator_get_numa_stats:
+ * @allocator: a #GstAllocator created with gst_mmap_allocator_new()
+ * @node: a NUMA node
+ * @allocated: (out) (allow-none): total bytes allocated for @node
+ * @first_page_local: (out) (allow-none): total bytes of the allocations
+ *     whose first page was placed on @node
+ *
+ * Get the allocation statistics of @allocator for memory that was requested
+ * on NUMA @node with gst_allocation_params_set_numa_node(). Comparing
+ * @first_page_local with @allocated shows how well the memory placement
+ * works.
+ *
+ * Only the node of the first page of each allocation is checked, the other
+ * pages are not faulted in yet when the memory is allocated. An allocation
+ * is counted as local as a whole when its first page is on @node, even when
+ * later pages end up on another node.
+ *
+ * Returns: %TRUE when the statistics could be retrieved.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_mmap_allocator_get_numa_stats (GstAllocator * allocator, gint node,
+    guint64 * allocated, guint64 * first_page_local)
+{
+#ifdef HAVE_MMAP
+  GstAllocatorMmap *mallocator;
+
+  g_return_val_if_fail (GST_IS_ALLOCATOR (allocator), FALSE);
+
+  if (!G_TYPE_CHECK_INSTANCE_TYPE (allocator, gst_allocator_mmap_get_type ()))
+    return FALSE;
+  if (node < 0 || node >= MAX_NUMA_NODES)
+    return FALSE;
+
+  mallocator = (GstAllocatorMmap *) allocator;
+
+  GST_OBJECT_LOCK (allocator);
+  if (allocated)
+    *allocated = mallocator->numa_stats[node].allocated;
+  if (first_page_local)
+    *first_page_local = mallocator->numa_stats[node].first_page_local;
+  GST_OBJECT_UNLOCK (allocator);
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 void
 _priv_gst_memory_initialize (void)
 {
@@ -591,6 +1484,21 @@ _priv_gst_memory_initialize (void)
       gst_object_ref (_sysmem_allocator));
 
   _default_allocator = gst_object_ref (_sysmem_allocator);
+
+  _slab_allocator = g_object_new (gst_allocator_slab_get_type (), NULL);
+
+  gst_allocator_register (GST_ALLOCATOR_SLAB,
+      gst_object_ref (_slab_allocator));
+
+#ifdef HAVE_MMAP
+  /* a memfd costs a file descriptor and a syscall per allocation, only
+   * allocators that are asked to share their memory use it */
+  _mmap_allocator =
+      gst_mmap_allocator_new (GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES);
+
+  gst_allocator_register (GST_ALLOCATOR_MMAP,
+      gst_object_ref (_mmap_allocator));
+#endif
 }
 
 /**
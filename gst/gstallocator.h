@@ -58,6 +58,51 @@ GST_EXPORT gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_SLAB:
+ *
+ * The allocator name for the slab memory allocator. This allocator provides
+ * system memory that is recycled in per-size-class free lists and
+ * per-thread caches.
+ *
+ * Since: 1.2
+ */
+#define GST_ALLOCATOR_SLAB     "SlabMemory"
+
+/**
+ * GST_ALLOCATOR_MMAP:
+ *
+ * The memory type of memory allocated with allocators created with
+ * gst_mmap_allocator_new() and the name of the registered mmap allocator.
+ * The registered allocator uses huge pages when available. It maps anonymous
+ * memory that can't be shared with gst_mmap_memory_get_fd(), create an
+ * allocator with #GST_MMAP_ALLOCATOR_FLAG_MEMFD for that.
+ *
+ * Since: 1.2
+ */
+#define GST_ALLOCATOR_MMAP     "MmapMemory"
+
+/**
+ * GstMmapAllocatorFlags:
+ * @GST_MMAP_ALLOCATOR_FLAG_NONE: plain anonymous memory
+ * @GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES: use huge pages for big allocations.
+ *     Reserved huge pages are tried first, then transparent huge pages.
+ * @GST_MMAP_ALLOCATOR_FLAG_MEMFD: back the memory with a memfd that can be
+ *     retrieved with gst_mmap_memory_get_fd()
+ * @GST_MMAP_ALLOCATOR_FLAG_PREFAULT: fault in all pages when allocating so
+ *     that the first access does not page fault
+ *
+ * Flags for allocators created with gst_mmap_allocator_new().
+ *
+ * Since: 1.2
+ */
+typedef enum {
+  GST_MMAP_ALLOCATOR_FLAG_NONE       = 0,
+  GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES = (1 << 0),
+  GST_MMAP_ALLOCATOR_FLAG_MEMFD      = (1 << 1),
+  GST_MMAP_ALLOCATOR_FLAG_PREFAULT   = (1 << 2)
+} GstMmapAllocatorFlags;
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
@@ -65,7 +110,8 @@ GST_EXPORT gsize gst_memory_alignment;
  * @prefix: the desired prefix
  * @padding: the desired padding
  *
- * Parameters to control the allocation of memory
+ * Parameters to control the allocation of memory. The NUMA node to place
+ * the memory on can be configured with gst_allocation_params_set_numa_node().
  */
 struct _GstAllocationParams {
   GstMemoryFlags flags;
@@ -74,7 +120,12 @@ struct _GstAllocationParams {
   gsize          padding;
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  union {
+    struct {
+      gint numa_node;
+    } abi;
+    gpointer _gst_reserved[GST_PADDING];
+  } ABI;
 };
 
 /**
@@ -144,6 +195,8 @@ void           gst_allocation_params_init    (GstAllocationParams *params);
 GstAllocationParams *
                gst_allocation_params_copy    (const GstAllocationParams *params) G_GNUC_MALLOC;
 void           gst_allocation_params_free    (GstAllocationParams *params);
+void           gst_allocation_params_set_numa_node (GstAllocationParams *params, gint node);
+gint           gst_allocation_params_get_numa_node (const GstAllocationParams *params);
 
 /* allocating memory blocks */
 GstMemory *    gst_allocator_alloc           (GstAllocator * allocator, gsize size,
@@ -154,6 +207,14 @@ GstMemory *    gst_memory_new_wrapped  (GstMemoryFlags flags, gpointer data, gsi
                                         gsize offset, gsize size, gpointer user_data,
                                         GDestroyNotify notify);
 
+/* mmap memory */
+GstAllocator * gst_mmap_allocator_new        (GstMmapAllocatorFlags flags);
+gboolean       gst_is_mmap_memory            (GstMemory *mem);
+gint           gst_mmap_memory_get_fd        (GstMemory *mem, gsize *offset);
+gboolean       gst_mmap_allocator_get_numa_stats (GstAllocator *allocator, gint node,
+                                              guint64 *allocated,
+                                              guint64 *first_page_local);
+
 G_END_DECLS
 
 #endif /* __GST_ALLOCATOR_H__ */
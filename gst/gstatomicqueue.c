@@ -35,6 +35,17 @@
  *
  * The #GstAtomicQueue object implements a queue that can be used from multiple
  * threads without performing any blocking operations.
+ *
+ * By default the queue is unbounded and grows when needed. A queue created
+ * with gst_atomic_queue_new_full() and %GST_ATOMIC_QUEUE_FLAG_BOUNDED is a
+ * fixed size ring buffer that never allocates memory after creation. When
+ * it is known that only one thread pushes or pops at a time, the
+ * %GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER and
+ * %GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER flags make the respective side of
+ * the ring buffer cheaper.
+ *
+ * Multiple items can be pushed and popped at once with
+ * gst_atomic_queue_push_many() and gst_atomic_queue_pop_many().
  */
 
 G_DEFINE_BOXED_TYPE (GstAtomicQueue, gst_atomic_queue,
@@ -101,6 +112,96 @@ free_queue_mem (GstAQueueMem * mem)
   g_free (mem);
 }
 
+/* bounded ring buffer. Each cell has a sequence number that tells if the
+ * cell is free for the producer at position pos (seq == pos) or filled for the
+ * consumer at position pos (seq == pos + 1). Producers and consumers claim a
+ * range of positions by moving tail and head respectively. */
+#define CACHE_LINE_SIZE 64
+
+typedef struct
+{
+  volatile gint seq;
+  gpointer data;
+} GstAQueueCell;
+
+typedef struct
+{
+  guint mask;
+  GstAQueueCell *cells;
+  /* keep producers and consumers on different cache lines */
+  gchar _pad0[CACHE_LINE_SIZE];
+  volatile gint tail;
+  gchar _pad1[CACHE_LINE_SIZE - sizeof (gint)];
+  volatile gint head;
+  gchar _pad2[CACHE_LINE_SIZE - sizeof (gint)];
+} GstAQueueRing;
+
+static GstAQueueRing *
+new_queue_ring (guint size)
+{
+  GstAQueueRing *ring;
+  guint i;
+
+  ring = g_new0 (GstAQueueRing, 1);
+  ring->mask = clp2 (MAX (size, 2)) - 1;
+  ring->cells = g_new (GstAQueueCell, ring->mask + 1);
+  for (i = 0; i <= ring->mask; i++) {
+    ring->cells[i].seq = i;
+    ring->cells[i].data = NULL;
+  }
+  return ring;
+}
+
+static void
+free_queue_ring (GstAQueueRing * ring)
+{
+  g_free (ring->cells);
+  g_free (ring);
+}
+
+/* claim at most @n consecutive cells starting from @position. A cell can be
+ * claimed when its sequence number is the position plus @ready. Returns the
+ * number of claimed cells, the first one in @start. */
+static guint
+ring_claim (GstAQueueRing * ring, volatile gint * position, guint ready,
+    guint n, gboolean single, guint * start)
+{
+  guint pos, i;
+
+  while (TRUE) {
+    gint diff;
+
+    pos = g_atomic_int_get (position);
+    diff = (gint) (g_atomic_int_get (&ring->cells[pos & ring->mask].seq) -
+        (pos + ready));
+
+    /* ring buffer full or empty */
+    if (diff < 0)
+      return 0;
+    /* other thread moved the position, retry */
+    if (G_UNLIKELY (diff > 0))
+      continue;
+
+    /* count the cells we can take after the first one */
+    for (i = 1; i < n; i++) {
+      GstAQueueCell *cell = &ring->cells[(pos + i) & ring->mask];
+
+      if ((guint) g_atomic_int_get (&cell->seq) != pos + i + ready)
+        break;
+    }
+
+    if (single) {
+      g_atomic_int_set (position, pos + i);
+      break;
+    }
+    if (G_LIKELY (g_atomic_int_compare_and_exchange (position, pos, pos + i)))
+      break;
+  }
+  *start = pos;
+
+  return i;
+}
+
 struct _GstAtomicQueue
 {
   volatile gint refcount;
@@ -110,8 +211,50 @@ struct _GstAtomicQueue
   GstAQueueMem *head_mem;
   GstAQueueMem *tail_mem;
   GstAQueueMem *free_list;
+
+  GstAtomicQueueFlags flags;
+  /* the ring buffer of bounded queues, NULL otherwise */
+  GstAQueueRing *ring;
 };
 
+static guint
+ring_push_many (GstAtomicQueue * queue, gpointer * data, guint n_data)
+{
+  GstAQueueRing *ring = queue->ring;
+  guint i, n, pos;
+
+  n = ring_claim (ring, &ring->tail, 0, n_data,
+      queue->flags & GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER, &pos);
+
+  for (i = 0; i < n; i++) {
+    GstAQueueCell *cell = &ring->cells[(pos + i) & ring->mask];
+
+    cell->data = data[i];
+    /* make the cell visible to consumers */
+    g_atomic_int_set (&cell->seq, pos + i + 1);
+  }
+  return n;
+}
+
+static guint
+ring_pop_many (GstAtomicQueue * queue, gpointer * data, guint n_data)
+{
+  GstAQueueRing *ring = queue->ring;
+  guint i, n, pos;
+
+  n = ring_claim (ring, &ring->head, 1, n_data,
+      queue->flags & GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER, &pos);
+
+  for (i = 0; i < n; i++) {
+    GstAQueueCell *cell = &ring->cells[(pos + i) & ring->mask];
+
+    data[i] = cell->data;
+    /* give the cell back to producers for the next round */
+    g_atomic_int_set (&cell->seq, pos + i + ring->mask + 1);
+  }
+  return n;
+}
+
 static void
 add_to_free_list (GstAtomicQueue * queue, GstAQueueMem * mem)
 {
@@ -165,6 +308,51 @@ gst_atomic_queue_new (guint initial_size)
 #endif
   queue->head_mem = queue->tail_mem = new_queue_mem (initial_size, 0);
   queue->free_list = NULL;
+  queue->flags = GST_ATOMIC_QUEUE_FLAG_NONE;
+  queue->ring = NULL;
+
+  return queue;
+}
+
+/**
+ * gst_atomic_queue_new_full:
+ * @size: initial queue size, or the size of a bounded queue
+ * @flags: #GstAtomicQueueFlags
+ *
+ * Create a new atomic queue instance with @flags.
+ *
+ * When @flags contains %GST_ATOMIC_QUEUE_FLAG_BOUNDED, the queue is a ring
+ * buffer that can hold @size items, rounded up to the nearest power of 2.
+ * gst_atomic_queue_try_push() fails on a full bounded queue and
+ * gst_atomic_queue_push() waits until a consumer made room.
+ *
+ * Without %GST_ATOMIC_QUEUE_FLAG_BOUNDED this function is the same as
+ * gst_atomic_queue_new().
+ *
+ * Returns: a new #GstAtomicQueue
+ *
+ * Since: 1.2
+ */
+GstAtomicQueue *
+gst_atomic_queue_new_full (guint size, GstAtomicQueueFlags flags)
+{
+  GstAtomicQueue *queue;
+
+  if (!(flags & GST_ATOMIC_QUEUE_FLAG_BOUNDED))
+    return gst_atomic_queue_new (size);
+
+  g_return_val_if_fail (size > 0, NULL);
+
+  queue = g_new (GstAtomicQueue, 1);
+
+  queue->refcount = 1;
+#ifdef LOW_MEM
+  queue->num_readers = 0;
+#endif
+  queue->head_mem = queue->tail_mem = NULL;
+  queue->free_list = NULL;
+  queue->flags = flags;
+  queue->ring = new_queue_ring (size);
 
   return queue;
 }
@@ -186,6 +374,11 @@ gst_atomic_queue_ref (GstAtomicQueue * queue)
 static void
 gst_atomic_queue_free (GstAtomicQueue * queue)
 {
+  if (queue->ring) {
+    free_queue_ring (queue->ring);
+    g_free (queue);
+    return;
+  }
   free_queue_mem (queue->head_mem);
   if (queue->head_mem != queue->tail_mem)
     free_queue_mem (queue->tail_mem);
@@ -225,6 +418,17 @@ gst_atomic_queue_peek (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring) {
+    GstAQueueRing *ring = queue->ring;
+    GstAQueueCell *cell;
+
+    head = g_atomic_int_get (&ring->head);
+    cell = &ring->cells[head & ring->mask];
+    if (g_atomic_int_get (&cell->seq) != head + 1)
+      return NULL;
+    return cell->data;
+  }
+
   while (TRUE) {
     GstAQueueMem *next;
 
@@ -258,23 +462,13 @@ gst_atomic_queue_peek (GstAtomicQueue * queue)
   return head_mem->array[head & size];
 }
 
-/**
- * gst_atomic_queue_pop:
- * @queue: a #GstAtomicQueue
- *
- * Get the head element of the queue.
- *
- * Returns: (transfer full): the head element of @queue or NULL when
- * the queue is empty.
- */
-gpointer
-gst_atomic_queue_pop (GstAtomicQueue * queue)
+/* take at most @n_data items from the head array of an unbounded queue with
+ * one compare-and-swap */
+static guint
+mem_pop_many (GstAtomicQueue * queue, gpointer * data, guint n_data)
 {
-  gpointer ret;
   GstAQueueMem *head_mem;
-  gint head, tail, size;
-
-  g_return_val_if_fail (queue != NULL, NULL);
+  gint head, tail, size, i, n;
 
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
@@ -298,7 +492,7 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
       /* else array empty, try to take next */
       next = g_atomic_pointer_get (&head_mem->next);
       if (next == NULL)
-        return NULL;
+        return 0;
 
       /* now we try to move the next array as the head memory. If we fail to do that,
        * some other reader managed to do it first and we retry */
@@ -313,9 +507,12 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
       add_to_free_list (queue, head_mem);
     }
 
-    ret = head_mem->array[head & size];
+    /* read all available items from this array */
+    n = MIN ((gint) n_data, tail - head);
+    for (i = 0; i < n; i++)
+      data[i] = head_mem->array[(head + i) & size];
   } while G_UNLIKELY
-  (!g_atomic_int_compare_and_exchange (&head_mem->head, head, head + 1));
+  (!g_atomic_int_compare_and_exchange (&head_mem->head, head, head + n));
 
 #ifdef LOW_MEM
   /* decrement number of readers, when we reach 0 readers we can be sure that
@@ -324,23 +521,41 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
     clear_free_list (queue);
 #endif
 
-  return ret;
+  return n;
 }
 
 /**
- * gst_atomic_queue_push:
+ * gst_atomic_queue_pop:
  * @queue: a #GstAtomicQueue
- * @data: the data
  *
- * Append @data to the tail of the queue.
+ * Get the head element of the queue.
+ *
+ * Returns: (transfer full): the head element of @queue or NULL when
+ * the queue is empty.
  */
-void
-gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
+gpointer
+gst_atomic_queue_pop (GstAtomicQueue * queue)
 {
-  GstAQueueMem *tail_mem;
-  gint head, tail, size;
+  gpointer ret;
+  guint n;
 
-  g_return_if_fail (queue != NULL);
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (queue->ring)
+    n = ring_pop_many (queue, &ret, 1);
+  else
+    n = mem_pop_many (queue, &ret, 1);
+
+  return n ? ret : NULL;
+}
+
+/* append at most @n_data items to the tail array of an unbounded queue with
+ * one compare-and-swap, growing the queue when the array is full */
+static guint
+mem_push_many (GstAtomicQueue * queue, gpointer * data, guint n_data)
+{
+  GstAQueueMem *tail_mem;
+  gint head, tail, size, i, n;
 
   do {
     while (TRUE) {
@@ -374,10 +589,13 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
        * pointer to the new array */
       g_atomic_pointer_set (&tail_mem->next, mem);
     }
+    /* claim all free slots we need in this array */
+    n = MIN ((gint) n_data, size + 1 - (tail - head));
   } while G_UNLIKELY
-  (!g_atomic_int_compare_and_exchange (&tail_mem->tail_write, tail, tail + 1));
+  (!g_atomic_int_compare_and_exchange (&tail_mem->tail_write, tail, tail + n));
 
-  tail_mem->array[tail & size] = data;
+  for (i = 0; i < n; i++)
+    tail_mem->array[(tail + i) & size] = data[i];
 
   /* now wait until all writers have completed their write before we move the
    * tail_read to this new item. It is possible that other writers are still
@@ -385,7 +603,36 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
    * before they are done. FIXME, it would be nice if we didn't have to busy
    * wait here. */
   while G_UNLIKELY
-    (!g_atomic_int_compare_and_exchange (&tail_mem->tail_read, tail, tail + 1));
+    (!g_atomic_int_compare_and_exchange (&tail_mem->tail_read, tail, tail + n));
+
+  return n;
+}
+
+/**
+ * gst_atomic_queue_push:
+ * @queue: a #GstAtomicQueue
+ * @data: the data
+ *
+ * Append @data to the tail of the queue.
+ *
+ * When @queue is a bounded queue that is full, this function busy-waits,
+ * yielding the CPU between attempts, until another thread popped an item
+ * from the queue. It never returns when no other thread pops from the
+ * queue, use gst_atomic_queue_try_push() when the pushing thread might also
+ * be the one popping the items.
+ */
+void
+gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
+{
+  g_return_if_fail (queue != NULL);
+
+  if (queue->ring) {
+    while (G_UNLIKELY (ring_push_many (queue, &data, 1) == 0))
+      g_thread_yield ();
+    return;
+  }
+
+  mem_push_many (queue, &data, 1);
 }
 
 /**
@@ -394,6 +641,10 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
  *
  * Get the amount of items in the queue.
  *
+ * For a bounded queue, only the items that can be popped are counted. An
+ * item that a producer is still pushing is not counted, neither are the
+ * items behind it. This takes time linear in the number of items.
+ *
  * Returns: the number of elements in the queue.
  */
 guint
@@ -404,6 +655,25 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, 0);
 
+  if (queue->ring) {
+    GstAQueueRing *ring = queue->ring;
+    gint len, n;
+
+    head = g_atomic_int_get (&ring->head);
+    tail = g_atomic_int_get (&ring->tail);
+    len = (gint) ((guint) tail - (guint) head);
+    len = CLAMP (len, 0, (gint) ring->mask + 1);
+
+    /* tail counts the claimed cells, only count the cells that are filled */
+    for (n = 0; n < len; n++) {
+      GstAQueueCell *cell = &ring->cells[(head + n) & ring->mask];
+
+      if ((guint) g_atomic_int_get (&cell->seq) != (guint) (head + n + 1))
+        break;
+    }
+    return n;
+  }
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
@@ -421,3 +691,108 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   return tail - head;
 }
+
+/**
+ * gst_atomic_queue_try_push:
+ * @queue: a #GstAtomicQueue
+ * @data: the data
+ *
+ * Append @data to the tail of the queue if there is room for it. Unbounded
+ * queues always have room.
+ *
+ * Returns: %TRUE if @data was added, %FALSE when @queue is a full bounded
+ * queue.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_atomic_queue_try_push (GstAtomicQueue * queue, gpointer data)
+{
+  g_return_val_if_fail (queue != NULL, FALSE);
+
+  if (queue->ring)
+    return ring_push_many (queue, &data, 1) == 1;
+
+  gst_atomic_queue_push (queue, data);
+
+  return TRUE;
+}
+
+/**
+ * gst_atomic_queue_push_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (array length=n_data): the items to add
+ * @n_data: the number of items in @data
+ *
+ * Append the items of @data to the tail of the queue, in order. The queue
+ * claims room for as many items as possible with one atomic operation.
+ * Unbounded queues always add all items, a bounded queue might add less
+ * than @n_data items when it is full.
+ *
+ * Returns: the number of items that were added.
+ *
+ * Since: 1.2
+ */
+guint
+gst_atomic_queue_push_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  guint n = 0;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  /* we can get less than requested when another thread uses the cells after
+   * ours or when the items don't fit in the current array */
+  while (n < n_data) {
+    guint res;
+
+    if (queue->ring)
+      res = ring_push_many (queue, data + n, n_data - n);
+    else
+      res = mem_push_many (queue, data + n, n_data - n);
+
+    if (res == 0)
+      break;
+    n += res;
+  }
+  return n;
+}
+
+/**
+ * gst_atomic_queue_pop_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (array length=n_data) (out caller-allocates): location for the
+ *     items
+ * @n_data: the maximum number of items to get
+ *
+ * Get at most @n_data items from the head of the queue. The queue claims
+ * all items that are available with one atomic operation.
+ *
+ * Returns: the number of items stored in @data.
+ *
+ * Since: 1.2
+ */
+guint
+gst_atomic_queue_pop_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  guint n = 0;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  while (n < n_data) {
+    guint res;
+
+    if (queue->ring)
+      res = ring_pop_many (queue, data + n, n_data - n);
+    else
+      res = mem_pop_many (queue, data + n, n_data - n);
+
+    if (res == 0)
+      break;
+    n += res;
+  }
+  return n;
+}
@@ -38,18 +38,48 @@ G_BEGIN_DECLS
  */
 typedef struct _GstAtomicQueue GstAtomicQueue;
 
+/**
+ * GstAtomicQueueFlags:
+ * @GST_ATOMIC_QUEUE_FLAG_NONE: an unbounded queue that grows when needed
+ * @GST_ATOMIC_QUEUE_FLAG_BOUNDED: a fixed size ring buffer that never
+ *     allocates after creation
+ * @GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER: only one thread at a time pushes
+ *     items on the bounded queue
+ * @GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER: only one thread at a time pops
+ *     items from the bounded queue
+ *
+ * Flags used when creating a #GstAtomicQueue with gst_atomic_queue_new_full().
+ * The single producer and consumer flags only apply to bounded queues and
+ * allow the queue to avoid compare-and-swap operations on that side.
+ *
+ * Since: 1.2
+ */
+typedef enum {
+  GST_ATOMIC_QUEUE_FLAG_NONE            = 0,
+  GST_ATOMIC_QUEUE_FLAG_BOUNDED         = (1 << 0),
+  GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER = (1 << 1),
+  GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER = (1 << 2)
+} GstAtomicQueueFlags;
+
 
 GType              gst_atomic_queue_get_type    (void);
 
 GstAtomicQueue *   gst_atomic_queue_new         (guint initial_size) G_GNUC_MALLOC;
+GstAtomicQueue *   gst_atomic_queue_new_full    (guint size, GstAtomicQueueFlags flags) G_GNUC_MALLOC;
 
 void               gst_atomic_queue_ref         (GstAtomicQueue * queue);
 void               gst_atomic_queue_unref       (GstAtomicQueue * queue);
 
 void               gst_atomic_queue_push        (GstAtomicQueue* queue, gpointer data);
+gboolean           gst_atomic_queue_try_push    (GstAtomicQueue* queue, gpointer data);
 gpointer           gst_atomic_queue_pop         (GstAtomicQueue* queue);
 gpointer           gst_atomic_queue_peek        (GstAtomicQueue* queue);
 
+guint              gst_atomic_queue_push_many   (GstAtomicQueue* queue, gpointer *data,
+                                                 guint n_data);
+guint              gst_atomic_queue_pop_many    (GstAtomicQueue* queue, gpointer *data,
+                                                 guint n_data);
+
 guint              gst_atomic_queue_length      (GstAtomicQueue * queue);
 
 G_END_DECLS
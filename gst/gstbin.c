@@ -165,6 +165,7 @@
 #include "gsterror.h"
 
 #include "gstutils.h"
+#include "gsttaskpool.h"
 #include "gstchildproxy.h"
 
 GST_DEBUG_CATEGORY_STATIC (bin_debug);
@@ -198,6 +199,14 @@ struct _GstBinPrivate
   gboolean message_forward;
 
   gboolean posted_eos;
+
+  /* change the state of independent children concurrently */
+  gboolean parallel_state_changes;
+  GstTaskPool *state_pool;
+  /* measure the state changes of the children */
+  gboolean measure_state_changes;
+  /* durations of the last state change of the children */
+  GstStructure *state_durations;
 };
 
 typedef struct
@@ -265,12 +274,16 @@ enum
 
 #define DEFAULT_ASYNC_HANDLING	FALSE
 #define DEFAULT_MESSAGE_FORWARD	FALSE
+#define DEFAULT_PARALLEL_STATE_CHANGES	FALSE
+#define DEFAULT_MEASURE_STATE_CHANGES	FALSE
 
 enum
 {
   PROP_0,
   PROP_ASYNC_HANDLING,
   PROP_MESSAGE_FORWARD,
+  PROP_PARALLEL_STATE_CHANGES,
+  PROP_MEASURE_STATE_CHANGES,
   PROP_LAST
 };
 
@@ -440,6 +453,49 @@ gst_bin_class_init (GstBinClass * klass)
           "Forwards all children messages",
           DEFAULT_MESSAGE_FORWARD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBin:parallel-state-changes:
+   *
+   * Change the state of children that do not depend on each other
+   * concurrently on a #GstTaskPool. Children are still handled in
+   * topological order, an element is only changed after all the elements it
+   * is linked to downstream in this bin have completed their state change.
+   * All children at the same distance from the sinks change state together.
+   *
+   * The state changes of the children run in the threads of the pool while
+   * the thread that changes the state of the bin holds the STATE_LOCK of the
+   * bin. When this property is enabled, children must not change or sync the
+   * state of the bin, or of one of its parents, from their state change
+   * function, for example with gst_element_set_state() or
+   * gst_element_sync_state_with_parent(), as this would deadlock.
+   *
+   * When this property is enabled, the bin also measures how long the state
+   * change of each child takes, see gst_bin_get_state_change_durations().
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_STATE_CHANGES,
+      g_param_spec_boolean ("parallel-state-changes", "Parallel State Changes",
+          "Change the state of independent children concurrently",
+          DEFAULT_PARALLEL_STATE_CHANGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBin:measure-state-changes:
+   *
+   * Measure how long the state change of each child takes, even when
+   * #GstBin:parallel-state-changes is disabled. The durations of the last
+   * state change of the children can be retrieved with
+   * gst_bin_get_state_change_durations().
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MEASURE_STATE_CHANGES,
+      g_param_spec_boolean ("measure-state-changes", "Measure State Changes",
+          "Measure the duration of the state changes of the children",
+          DEFAULT_MEASURE_STATE_CHANGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_bin_dispose;
 
   gst_element_class_set_static_metadata (gstelement_class, "Generic bin",
@@ -503,6 +559,8 @@ gst_bin_init (GstBin * bin)
   bin->priv->asynchandling = DEFAULT_ASYNC_HANDLING;
   bin->priv->structure_cookie = 0;
   bin->priv->message_forward = DEFAULT_MESSAGE_FORWARD;
+  bin->priv->parallel_state_changes = DEFAULT_PARALLEL_STATE_CHANGES;
+  bin->priv->measure_state_changes = DEFAULT_MEASURE_STATE_CHANGES;
 }
 
 static void
@@ -530,6 +588,19 @@ gst_bin_dispose (GObject * object)
         GST_STR_NULL (GST_OBJECT_NAME (object)));
   }
 
+  if (bin->priv->state_pool) {
+    gst_task_pool_cleanup (bin->priv->state_pool);
+    gst_object_unref (bin->priv->state_pool);
+    bin->priv->state_pool = NULL;
+  }
+
+  GST_OBJECT_LOCK (object);
+  if (bin->priv->state_durations) {
+    gst_structure_free (bin->priv->state_durations);
+    bin->priv->state_durations = NULL;
+  }
+  GST_OBJECT_UNLOCK (object);
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -566,6 +637,16 @@ gst_bin_set_property (GObject * object, guint prop_id,
       gstbin->priv->message_forward = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_state_changes = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_MEASURE_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->measure_state_changes = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -591,6 +672,16 @@ gst_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, gstbin->priv->message_forward);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->parallel_state_changes);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_MEASURE_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->measure_state_changes);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2427,6 +2518,44 @@ failed:
   }
 }
 
+/**
+ * gst_bin_get_state_change_durations:
+ * @bin: a #GstBin
+ *
+ * Get how long the state change of each child of @bin took during the last
+ * state change of the children of @bin. The durations are only measured
+ * when #GstBin:parallel-state-changes or #GstBin:measure-state-changes is
+ * enabled.
+ *
+ * The returned structure is named 'GstBinStateChangeDurations'. It contains
+ * the 'old-state' and 'new-state' fields of type GST_TYPE_STATE and a
+ * 'durations' field of type GST_TYPE_ARRAY with one structure per child,
+ * holding the 'element' name and the 'duration' of its state change as a
+ * #GstClockTime.
+ *
+ * MT safe.
+ *
+ * Returns: (transfer full): a copy of the durations of the last state
+ * change of the children, or %NULL when no state change of @bin was
+ * measured yet. Free with gst_structure_free() after usage.
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_bin_get_state_change_durations (GstBin * bin)
+{
+  GstStructure *result = NULL;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  GST_OBJECT_LOCK (bin);
+  if (bin->priv->state_durations)
+    result = gst_structure_copy (bin->priv->state_durations);
+  GST_OBJECT_UNLOCK (bin);
+
+  return result;
+}
+
 /**
  * gst_bin_recalculate_latency:
  * @bin: a #GstBin
@@ -2519,6 +2648,363 @@ gst_bin_state_changed (GstElement * element, GstState oldstate,
     pklass->state_changed (element, oldstate, newstate, pending);
 }
 
+/* A wave is a set of children, taken from the sorted iterator, that are not
+ * linked to each other and whose state can be changed concurrently. In
+ * parallel mode a wave holds all the children of one level, see
+ * bin_state_change_levels(). */
+typedef struct _BinStateWave BinStateWave;
+
+typedef struct
+{
+  BinStateWave *wave;
+  GstElement *child;
+  GstStateChangeReturn ret;
+  GstClockTime duration;
+} BinChildState;
+
+struct _BinStateWave
+{
+  GstBin *bin;
+  GstClockTime base_time;
+  GstClockTime start_time;
+  GstState current;
+  GstState next;
+
+  GArray *children;             /* array of BinChildState */
+  gboolean measure;             /* measure the state change durations */
+  GValue durations;             /* GST_TYPE_ARRAY of the child durations */
+
+  GMutex lock;
+  GCond cond;
+  guint pending;
+};
+
+static void
+bin_state_wave_init (BinStateWave * wave, GstBin * bin, GstState current,
+    GstState next, gboolean measure)
+{
+  wave->bin = bin;
+  wave->base_time = GST_CLOCK_TIME_NONE;
+  wave->start_time = GST_CLOCK_TIME_NONE;
+  wave->current = current;
+  wave->next = next;
+  wave->children = g_array_new (FALSE, FALSE, sizeof (BinChildState));
+  wave->measure = measure;
+  memset (&wave->durations, 0, sizeof (GValue));
+  if (measure)
+    g_value_init (&wave->durations, GST_TYPE_ARRAY);
+  g_mutex_init (&wave->lock);
+  g_cond_init (&wave->cond);
+  wave->pending = 0;
+}
+
+static void
+bin_state_wave_reset (BinStateWave * wave)
+{
+  guint i;
+
+  for (i = 0; i < wave->children->len; i++)
+    gst_object_unref (g_array_index (wave->children, BinChildState, i).child);
+  g_array_set_size (wave->children, 0);
+}
+
+static void
+bin_state_wave_clear (BinStateWave * wave)
+{
+  bin_state_wave_reset (wave);
+  g_array_free (wave->children, TRUE);
+  if (G_IS_VALUE (&wave->durations))
+    g_value_unset (&wave->durations);
+  g_mutex_clear (&wave->lock);
+  g_cond_clear (&wave->cond);
+}
+
+static void
+bin_state_wave_add (BinStateWave * wave, GstElement * element)
+{
+  BinChildState cs = { wave, NULL, GST_STATE_CHANGE_FAILURE,
+    GST_CLOCK_TIME_NONE
+  };
+
+  cs.child = gst_object_ref (element);
+  g_array_append_val (wave->children, cs);
+}
+
+/* change the state of one child of the wave, called from the pool or from
+ * the thread doing the state change of the bin */
+static void
+bin_child_change_state (BinChildState * cs)
+{
+  BinStateWave *wave = cs->wave;
+  GstClockTime start = 0;
+
+  if (wave->measure)
+    start = gst_util_get_timestamp ();
+  cs->ret = gst_bin_element_set_state (wave->bin, cs->child,
+      wave->base_time, wave->start_time, wave->current, wave->next);
+  if (wave->measure)
+    cs->duration = gst_util_get_timestamp () - start;
+
+  g_mutex_lock (&wave->lock);
+  if (--wave->pending == 0)
+    g_cond_signal (&wave->cond);
+  g_mutex_unlock (&wave->lock);
+}
+
+/* change the state of all children in the wave and wait for them. Without
+ * a pool, or with only one child, the state is changed in this thread. */
+static void
+bin_state_wave_run (BinStateWave * wave, GstTaskPool * pool)
+{
+  guint i, len;
+
+  len = wave->children->len;
+  wave->pending = len;
+
+  if (pool != NULL && len > 1) {
+    for (i = 0; i < len; i++) {
+      BinChildState *cs = &g_array_index (wave->children, BinChildState, i);
+      GError *error = NULL;
+
+      gst_task_pool_push (pool, (GstTaskPoolFunction) bin_child_change_state,
+          cs, &error);
+      if (G_UNLIKELY (error != NULL)) {
+        GST_WARNING_OBJECT (wave->bin, "could not push state change of '%s' "
+            "to the pool: %s", GST_ELEMENT_NAME (cs->child), error->message);
+        g_error_free (error);
+        bin_child_change_state (cs);
+      }
+    }
+  } else {
+    for (i = 0; i < len; i++)
+      bin_child_change_state (&g_array_index (wave->children, BinChildState,
+              i));
+  }
+
+  g_mutex_lock (&wave->lock);
+  while (wave->pending > 0)
+    g_cond_wait (&wave->cond, &wave->lock);
+  g_mutex_unlock (&wave->lock);
+}
+
+static void
+bin_state_wave_append_duration (BinStateWave * wave, BinChildState * cs)
+{
+  GValue val = { 0, };
+
+  g_value_init (&val, GST_TYPE_STRUCTURE);
+  g_value_take_boxed (&val, gst_structure_new ("GstBinChildStateChange",
+          "element", G_TYPE_STRING, GST_ELEMENT_NAME (cs->child),
+          "duration", GST_TYPE_CLOCK_TIME, cs->duration, NULL));
+  gst_value_array_append_value (&wave->durations, &val);
+  g_value_unset (&val);
+}
+
+/* store the durations collected in @wave as the durations of the last state
+ * change of the children of the bin */
+static void
+bin_state_wave_store_durations (BinStateWave * wave)
+{
+  GstBin *bin = wave->bin;
+  GstStructure *s;
+
+  if (!wave->measure)
+    return;
+
+  s = gst_structure_new ("GstBinStateChangeDurations",
+      "old-state", GST_TYPE_STATE, wave->current,
+      "new-state", GST_TYPE_STATE, wave->next, NULL);
+  gst_structure_take_value (s, "durations", &wave->durations);
+  /* the structure owns the array now */
+  memset (&wave->durations, 0, sizeof (GValue));
+
+  GST_OBJECT_LOCK (bin);
+  if (bin->priv->state_durations)
+    gst_structure_free (bin->priv->state_durations);
+  bin->priv->state_durations = s;
+  GST_OBJECT_UNLOCK (bin);
+}
+
+/* change the state of the children in the wave and collect the results.
+ * Returns FALSE when a child that is still in the bin failed. */
+static gboolean
+bin_state_wave_flush (BinStateWave * wave, GstTaskPool * pool,
+    gboolean * have_async, gboolean * have_no_preroll)
+{
+  GstElement *element = GST_ELEMENT_CAST (wave->bin);
+  GstState next = wave->next;
+  gboolean res = TRUE;
+  guint i;
+
+  if (wave->children->len == 0)
+    return TRUE;
+
+  bin_state_wave_run (wave, pool);
+
+  for (i = 0; i < wave->children->len && res; i++) {
+    BinChildState *cs = &g_array_index (wave->children, BinChildState, i);
+    GstElement *child = cs->child;
+
+    if (wave->measure) {
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+          "child '%s' state change took %" GST_TIME_FORMAT,
+          GST_ELEMENT_NAME (child), GST_TIME_ARGS (cs->duration));
+      bin_state_wave_append_duration (wave, cs);
+    }
+
+    switch (cs->ret) {
+      case GST_STATE_CHANGE_SUCCESS:
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+            "child '%s' changed state to %d(%s) successfully",
+            GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+        break;
+      case GST_STATE_CHANGE_ASYNC:
+      {
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+            "child '%s' is changing state asynchronously to %s",
+            GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
+        *have_async = TRUE;
+        break;
+      }
+      case GST_STATE_CHANGE_FAILURE:{
+        GstObject *parent;
+
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+            "child '%s' failed to go to state %d(%s)",
+            GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+
+        /* Only fail if the child is still inside
+         * this bin. It might've been removed already
+         * because of the error by the bin subclass
+         * to ignore the error.  */
+        parent = gst_object_get_parent (GST_OBJECT_CAST (child));
+        if (parent == GST_OBJECT_CAST (element)) {
+          /* element is still in bin, really error now */
+          gst_object_unref (parent);
+          res = FALSE;
+          break;
+        }
+        /* child removed from bin, let the resync code redo the state
+         * change */
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+            "child '%s' was removed from the bin", GST_ELEMENT_NAME (child));
+
+        if (parent)
+          gst_object_unref (parent);
+
+        break;
+      }
+      case GST_STATE_CHANGE_NO_PREROLL:
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+            "child '%s' changed state to %d(%s) successfully without preroll",
+            GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+        *have_no_preroll = TRUE;
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  }
+  bin_state_wave_reset (wave);
+
+  return res;
+}
+
+/* get the level of @element: 1 for elements that are not linked downstream
+ * to a child in @levels, else one more than the highest level of the
+ * children it is linked to. */
+static guint
+bin_state_child_level (GHashTable * levels, GstElement * element)
+{
+  guint level = 0;
+  GList *pads;
+
+  GST_OBJECT_LOCK (element);
+  for (pads = element->srcpads; pads; pads = g_list_next (pads)) {
+    GstPad *peer;
+    GstElement *peer_element;
+
+    if (!(peer = gst_pad_get_peer (GST_PAD_CAST (pads->data))))
+      continue;
+
+    if ((peer_element = gst_pad_get_parent_element (peer))) {
+      level = MAX (level,
+          GPOINTER_TO_UINT (g_hash_table_lookup (levels, peer_element)));
+      gst_object_unref (peer_element);
+    }
+    gst_object_unref (peer);
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return level + 1;
+}
+
+/* change the state of the children in @order, as returned by the sorted
+ * iterator, one level at a time. The sorted order has the downstream
+ * elements first, so the level of the peers of a child is known when the
+ * child is handled. All the children of a level change state in one wave.
+ * Returns FALSE when a child that is still in the bin failed. */
+static gboolean
+bin_state_change_levels (BinStateWave * wave, GPtrArray * order,
+    GstTaskPool * pool, gboolean * have_async, gboolean * have_no_preroll)
+{
+  GHashTable *levels;
+  guint i, level, max_level = 0;
+  gboolean res = TRUE;
+
+  levels = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < order->len; i++) {
+    GstElement *child = g_ptr_array_index (order, i);
+
+    level = bin_state_child_level (levels, child);
+    g_hash_table_insert (levels, child, GUINT_TO_POINTER (level));
+    max_level = MAX (max_level, level);
+  }
+
+  for (level = 1; level <= max_level && res; level++) {
+    for (i = 0; i < order->len; i++) {
+      GstElement *child = g_ptr_array_index (order, i);
+
+      if (GPOINTER_TO_UINT (g_hash_table_lookup (levels, child)) == level)
+        bin_state_wave_add (wave, child);
+    }
+    GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, wave->bin,
+        "changing state of %u children at level %u", wave->children->len,
+        level);
+    res = bin_state_wave_flush (wave, pool, have_async, have_no_preroll);
+  }
+  g_hash_table_destroy (levels);
+
+  return res;
+}
+
+/* get the pool for concurrent state changes of the children, or NULL when
+ * they are changed one by one. Should be called with the bin LOCK held */
+static GstTaskPool *
+bin_get_state_pool (GstBin * bin)
+{
+  GstBinPrivate *priv = bin->priv;
+
+  if (!priv->parallel_state_changes)
+    return NULL;
+
+  if (priv->state_pool == NULL) {
+    GError *error = NULL;
+
+    priv->state_pool = gst_task_pool_new ();
+    gst_task_pool_prepare (priv->state_pool, &error);
+    if (G_UNLIKELY (error != NULL)) {
+      GST_WARNING_OBJECT (bin, "could not prepare state change pool: %s",
+          error->message);
+      g_error_free (error);
+      gst_object_unref (priv->state_pool);
+      priv->state_pool = NULL;
+      return NULL;
+    }
+  }
+  return gst_object_ref (priv->state_pool);
+}
+
 static GstStateChangeReturn
 gst_bin_change_state_func (GstElement * element, GstStateChange transition)
 {
@@ -2527,10 +3013,14 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   GstState current, next;
   gboolean have_async;
   gboolean have_no_preroll;
+  gboolean measure;
   GstClockTime base_time, start_time;
   GstIterator *it;
   gboolean done;
   GValue data = { 0, };
+  BinStateWave wave;
+  GstTaskPool *pool;
+  GPtrArray *order = NULL;
 
   /* we don't need to take the STATE_LOCK, it is already taken */
   current = (GstState) GST_STATE_TRANSITION_CURRENT (transition);
@@ -2591,11 +3081,19 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
    * don't want them to interfere with this state change */
   GST_OBJECT_LOCK (bin);
   bin->polling = TRUE;
+  pool = bin_get_state_pool (bin);
+  measure = pool != NULL || bin->priv->measure_state_changes;
   GST_OBJECT_UNLOCK (bin);
 
   /* iterate in state change order */
   it = gst_bin_iterate_sorted (bin);
 
+  bin_state_wave_init (&wave, bin, current, next, measure);
+  /* with a pool, the children are collected first and then changed level by
+   * level */
+  if (pool)
+    order = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_object_unref);
+
   /* mark if we've seen an ASYNC element in the bin when we did a state change.
    * Note how we don't reset this value when a resync happens, the reason being
    * that the async element posted ASYNC_START and we want to post ASYNC_DONE
@@ -2606,6 +3104,11 @@ restart:
   /* take base_time */
   base_time = gst_element_get_base_time (element);
   start_time = gst_element_get_start_time (element);
+  wave.base_time = base_time;
+  wave.start_time = start_time;
+  /* only report the durations of the last pass over the children */
+  if (wave.measure)
+    g_value_reset (&wave.durations);
 
   have_no_preroll = FALSE;
 
@@ -2618,70 +3121,24 @@ restart:
 
         child = g_value_get_object (&data);
 
-        /* set state and base_time now */
-        ret = gst_bin_element_set_state (bin, child, base_time, start_time,
-            current, next);
-
-        switch (ret) {
-          case GST_STATE_CHANGE_SUCCESS:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            break;
-          case GST_STATE_CHANGE_ASYNC:
-          {
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' is changing state asynchronously to %s",
-                GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
-            have_async = TRUE;
-            break;
-          }
-          case GST_STATE_CHANGE_FAILURE:{
-            GstObject *parent;
-
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' failed to go to state %d(%s)",
-                GST_ELEMENT_NAME (child),
-                next, gst_element_state_get_name (next));
-
-            /* Only fail if the child is still inside
-             * this bin. It might've been removed already
-             * because of the error by the bin subclass
-             * to ignore the error.  */
-            parent = gst_object_get_parent (GST_OBJECT_CAST (child));
-            if (parent == GST_OBJECT_CAST (element)) {
-              /* element is still in bin, really error now */
-              gst_object_unref (parent);
-              goto done;
-            }
-            /* child removed from bin, let the resync code redo the state
-             * change */
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' was removed from the bin",
-                GST_ELEMENT_NAME (child));
-
-            if (parent)
-              gst_object_unref (parent);
-
-            break;
-          }
-          case GST_STATE_CHANGE_NO_PREROLL:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully without preroll",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            have_no_preroll = TRUE;
-            break;
-          default:
-            g_assert_not_reached ();
-            break;
+        if (order) {
+          g_ptr_array_add (order, gst_object_ref (child));
+        } else {
+          /* without a pool, set state and base_time now */
+          bin_state_wave_add (&wave, child);
+          if (!bin_state_wave_flush (&wave, NULL, &have_async,
+                  &have_no_preroll))
+            goto failure;
         }
+
         g_value_reset (&data);
         break;
       }
       case GST_ITERATOR_RESYNC:
         GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator doing resync");
+        /* nothing was changed yet for the collected children */
+        if (order)
+          g_ptr_array_set_size (order, 0);
         gst_iterator_resync (it);
         goto restart;
       default:
@@ -2692,6 +3149,24 @@ restart:
     }
   }
 
+  if (order && order->len > 0) {
+    if (!bin_state_change_levels (&wave, order, pool, &have_async,
+            &have_no_preroll))
+      goto failure;
+    g_ptr_array_set_size (order, 0);
+
+    /* children might have been added or removed while their state changed,
+     * redo the state change then, like the serial path does on resync */
+    if (gst_iterator_next (it, &data) == GST_ITERATOR_RESYNC) {
+      GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator doing resync");
+      gst_iterator_resync (it);
+      goto restart;
+    }
+    g_value_reset (&data);
+  }
+
+  bin_state_wave_store_durations (&wave);
+
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
   if (G_UNLIKELY (ret == GST_STATE_CHANGE_FAILURE))
     goto done;
@@ -2711,6 +3186,11 @@ restart:
 done:
   g_value_unset (&data);
   gst_iterator_free (it);
+  bin_state_wave_clear (&wave);
+  if (order)
+    g_ptr_array_free (order, TRUE);
+  if (pool)
+    gst_object_unref (pool);
 
   GST_OBJECT_LOCK (bin);
   bin->polling = FALSE;
@@ -2760,6 +3240,12 @@ state_end:
   return ret;
 
   /* ERRORS */
+failure:
+  {
+    bin_state_wave_store_durations (&wave);
+    ret = GST_STATE_CHANGE_FAILURE;
+    goto done;
+  }
 activate_failure:
   {
     GST_CAT_WARNING_OBJECT (GST_CAT_STATES, element,
@@ -197,6 +197,9 @@ GstIterator*	gst_bin_iterate_all_by_interface (GstBin *bin, GType iface);
 /* latency */
 gboolean        gst_bin_recalculate_latency      (GstBin * bin);
 
+/* state change statistics */
+GstStructure *  gst_bin_get_state_change_durations (GstBin * bin);
+
 
 G_END_DECLS
 
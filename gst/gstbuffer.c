@@ -135,15 +135,40 @@ struct _GstMetaItem
   GstMeta meta;
 };
 #define ITEM_SIZE(info) ((info)->size + sizeof (GstMetaItem))
+/* metadata items stored inline in the buffer are kept aligned to 16 bytes */
+#define ITEM_ALIGN(s)   (((s) + 15) & ~(gsize) 15)
 
-#define GST_BUFFER_MEM_MAX         16
+/* number of memory blocks stored inline in the buffer, more memory blocks
+ * spill to an external array */
+#define GST_BUFFER_MEM_INLINE      16
+/* hard limit on the number of memory blocks, beyond this memory is merged.
+ * This is reported by gst_buffer_get_max_memory() */
+#define GST_BUFFER_MEM_MAX         1024
 
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
+#define GST_BUFFER_MEM_ALLOC(b)    (((GstBufferImpl *)(b))->alloc)
+#define GST_BUFFER_MEM_INLINED(b)  (((GstBufferImpl *)(b))->mem_inline)
 #define GST_BUFFER_MEM_ARRAY(b)    (((GstBufferImpl *)(b))->mem)
 #define GST_BUFFER_MEM_PTR(b,i)    (((GstBufferImpl *)(b))->mem[i])
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
+#define GST_BUFFER_META_SIZE(b)    (((GstBufferImpl *)(b))->meta_size)
+#define GST_BUFFER_META_USED(b)    (((GstBufferImpl *)(b))->meta_used)
+#define GST_BUFFER_META_INLINE(b)  (((GstBufferImpl *)(b))->meta_inline)
+#define GST_BUFFER_META_ARENA(b)   (((guint8 *)(b)) + GST_BUFFER_IMPL_SIZE)
+#define GST_BUFFER_META_MASK(b)    (((GstBufferImpl *)(b))->meta_mask)
+#define GST_BUFFER_META_SLOTS_ARRAY(b) (((GstBufferImpl *)(b))->meta_slots)
+#define GST_BUFFER_META_SLOT(b,i)  (((GstBufferImpl *)(b))->meta_slots[i])
+
+/* number of meta APIs with a lookup slot in the buffer, metadata for APIs
+ * with a higher id are found by walking the list of items */
+#define GST_BUFFER_META_SLOTS      32
+#define META_SLOT_VALID(id)        ((id) > 0 && (id) <= GST_BUFFER_META_SLOTS)
+#define META_SLOT_BIT(id)          (1u << ((id) - 1))
+
+/* size of the per thread cache of GstBufferImpl objects */
+#define BUFFER_CACHE_SIZE          32
 
 typedef struct
 {
@@ -151,18 +176,151 @@ typedef struct
 
   gsize slice_size;
 
-  /* the memory blocks */
+  /* the memory blocks, mem points to mem_inline or to an allocated array
+   * of alloc entries when more than GST_BUFFER_MEM_INLINE blocks are used */
   guint len;
-  GstMemory *mem[GST_BUFFER_MEM_MAX];
+  guint alloc;
+  GstMemory **mem;
+  GstMemory *mem_inline[GST_BUFFER_MEM_INLINE];
 
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
 
-  /* FIXME, make metadata allocation more efficient by using part of the
-   * GstBufferImpl */
   GstMetaItem *item;
+
+  /* space for metadata items allocated after the GstBufferImpl, see
+   * gst_buffer_new_reserve_meta(). meta_used bytes of it are in use by
+   * meta_inline items, the space is reclaimed when they are all removed */
+  gsize meta_size;
+  gsize meta_used;
+  guint meta_inline;
+
+  /* bit id - 1 is set in meta_mask when there is metadata for the API with
+   * that id, meta_slots[id - 1] then points to the first metadata. The slots
+   * are only allocated when metadata is added */
+  guint32 meta_mask;
+  GstMeta **meta_slots;
 } GstBufferImpl;
 
+#define GST_BUFFER_IMPL_SIZE       ITEM_ALIGN (sizeof (GstBufferImpl))
+
+/* recently freed GstBufferImpl objects of the default size, per thread */
+typedef struct
+{
+  guint n_buffers;
+  GstBufferImpl *buffers[BUFFER_CACHE_SIZE];
+} GstBufferCache;
+
+static void _buffer_cache_free (GstBufferCache * cache);
+
+static GPrivate buffer_cache = G_PRIVATE_INIT ((GDestroyNotify)
+    _buffer_cache_free);
+
+static void
+_buffer_cache_free (GstBufferCache * cache)
+{
+  while (cache->n_buffers > 0)
+    g_slice_free1 (GST_BUFFER_IMPL_SIZE, cache->buffers[--cache->n_buffers]);
+  g_slice_free (GstBufferCache, cache);
+}
+
+static inline GstBufferCache *
+_buffer_get_cache (void)
+{
+  GstBufferCache *cache;
+
+  cache = g_private_get (&buffer_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_slice_new0 (GstBufferCache);
+    g_private_set (&buffer_cache, cache);
+  }
+  return cache;
+}
+
+static inline GstBufferImpl *
+_buffer_impl_alloc (void)
+{
+  GstBufferCache *cache = _buffer_get_cache ();
+
+  if (G_LIKELY (cache->n_buffers > 0))
+    return cache->buffers[--cache->n_buffers];
+
+  return g_slice_alloc (GST_BUFFER_IMPL_SIZE);
+}
+
+static inline void
+_buffer_impl_free (GstBufferImpl * buffer, gsize size)
+{
+  GstBufferCache *cache;
+
+  if (size == GST_BUFFER_IMPL_SIZE) {
+    cache = _buffer_get_cache ();
+    if (G_LIKELY (cache->n_buffers < BUFFER_CACHE_SIZE)) {
+      cache->buffers[cache->n_buffers++] = buffer;
+      return;
+    }
+  }
+  g_slice_free1 (size, buffer);
+}
+
+/* allocate a metadata item for @info, from the reserved space in @buffer
+ * when possible */
+static inline GstMetaItem *
+_meta_item_alloc (GstBuffer * buffer, const GstMetaInfo * info)
+{
+  gsize size = ITEM_ALIGN (ITEM_SIZE (info));
+  GstMetaItem *item;
+
+  if (GST_BUFFER_META_SIZE (buffer) - GST_BUFFER_META_USED (buffer) >= size) {
+    item = (GstMetaItem *) (GST_BUFFER_META_ARENA (buffer) +
+        GST_BUFFER_META_USED (buffer));
+    GST_BUFFER_META_USED (buffer) += size;
+    GST_BUFFER_META_INLINE (buffer)++;
+  } else {
+    item = g_slice_alloc (ITEM_SIZE (info));
+  }
+  return item;
+}
+
+/* update the lookup slot of the API of @meta after @meta was removed from
+ * the list of items */
+static void
+_meta_slot_remove (GstBuffer * buffer, GstMeta * meta)
+{
+  guint id = _priv_gst_meta_api_get_id (meta->info->api);
+  GstMetaItem *walk;
+
+  if (!META_SLOT_VALID (id) ||
+      !(GST_BUFFER_META_MASK (buffer) & META_SLOT_BIT (id)) ||
+      GST_BUFFER_META_SLOT (buffer, id - 1) != meta)
+    return;
+
+  /* find other metadata of the same API */
+  for (walk = GST_BUFFER_META (buffer); walk; walk = walk->next) {
+    if (walk->meta.info->api == meta->info->api) {
+      GST_BUFFER_META_SLOT (buffer, id - 1) = &walk->meta;
+      return;
+    }
+  }
+  GST_BUFFER_META_MASK (buffer) &= ~META_SLOT_BIT (id);
+}
+
+static inline void
+_meta_item_free (GstBuffer * buffer, GstMetaItem * item,
+    const GstMetaInfo * info)
+{
+  guint8 *arena = GST_BUFFER_META_ARENA (buffer);
+
+  if ((guint8 *) item >= arena &&
+      (guint8 *) item < arena + GST_BUFFER_META_SIZE (buffer)) {
+    /* inline item, reclaim the space when the last one is removed */
+    if (--GST_BUFFER_META_INLINE (buffer) == 0)
+      GST_BUFFER_META_USED (buffer) = 0;
+  } else {
+    g_slice_free1 (ITEM_SIZE (info), item);
+  }
+}
+
 
 static gboolean
 _is_span (GstMemory ** mem, gsize len, gsize * poffset, GstMemory ** parent)
@@ -288,6 +446,34 @@ _replace_memory (GstBuffer * buffer, guint len, guint idx, guint length,
   GST_BUFFER_MEM_LEN (buffer) = len - length;
 }
 
+/* make room for at least one more memory block in the memory array of
+ * @buffer. The inline array is moved to a heap allocated array the first time
+ * it overflows, after that the array grows by doubling its size. */
+static void
+_memory_grow (GstBuffer * buffer)
+{
+  GstMemory **mem;
+  guint len, alloc;
+
+  len = GST_BUFFER_MEM_LEN (buffer);
+  alloc = GST_BUFFER_MEM_ALLOC (buffer);
+
+  alloc = MIN (alloc * 2, GST_BUFFER_MEM_MAX);
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "buffer %p grow memory array to %u",
+      buffer, alloc);
+
+  mem = GST_BUFFER_MEM_ARRAY (buffer);
+  if (mem == GST_BUFFER_MEM_INLINED (buffer)) {
+    mem = g_new (GstMemory *, alloc);
+    memcpy (mem, GST_BUFFER_MEM_INLINED (buffer), len * sizeof (gpointer));
+  } else {
+    mem = g_renew (GstMemory *, mem, alloc);
+  }
+  GST_BUFFER_MEM_ARRAY (buffer) = mem;
+  GST_BUFFER_MEM_ALLOC (buffer) = alloc;
+}
+
 static inline void
 _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem, gboolean lock)
 {
@@ -296,16 +482,19 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem, gboolean lock)
   GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %d, mem %p, lock %d", buffer,
       idx, mem, lock);
 
-  if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
-    /* too many buffer, span them. */
-    /* FIXME, there is room for improvement here: We could only try to merge
-     * 2 buffers to make some room. If we can't efficiently merge 2 buffers we
-     * could try to only merge the two smallest buffers to avoid memcpy, etc. */
-    GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "memory array overflow in buffer %p",
-        buffer);
-    _replace_memory (buffer, len, 0, len, _get_merged_memory (buffer, 0, len));
-    /* we now have 1 single spanned buffer */
-    len = 1;
+  if (G_UNLIKELY (len >= GST_BUFFER_MEM_ALLOC (buffer))) {
+    if (G_LIKELY (len < GST_BUFFER_MEM_MAX)) {
+      /* spill to a larger array, this keeps all memory blocks */
+      _memory_grow (buffer);
+    } else {
+      /* too many buffer, span them. */
+      GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+          "memory array overflow in buffer %p", buffer);
+      _replace_memory (buffer, len, 0, len, _get_merged_memory (buffer, 0,
+              len));
+      /* we now have 1 single spanned buffer */
+      len = 1;
+    }
   }
 
   if (idx == -1)
@@ -336,8 +525,13 @@ _priv_gst_buffer_initialize (void)
  * Get the maximum amount of memory blocks that a buffer can hold. This is a
  * compile time constant that can be queried with the function.
  *
- * When more memory blocks are added, existing memory blocks will be merged
- * together to make room for the new block.
+ * A buffer stores a small number of memory blocks inline and moves them to a
+ * larger array when more blocks are added, so adding memory does not merge
+ * or copy existing memory blocks until this limit is reached. When more
+ * memory blocks are added, existing memory blocks will be merged together to
+ * make room for the new block.
+ *
+ * The limit was 16 memory blocks before 1.2, it is now 1024.
  *
  * Returns: the maximum amount of memory blocks that a buffer can hold.
  *
@@ -542,6 +736,19 @@ _gst_buffer_dispose (GstBuffer * buffer)
   return FALSE;
 }
 
+/* check if dropping the last ref to @buffer would only return it to its
+ * pool, so that it can be released together with other buffers. Buffers with
+ * another dispose function, weak refs or qdata must be unreffed normally. */
+gboolean
+_priv_gst_buffer_can_release_batched (GstBuffer * buffer)
+{
+  GstMiniObject *obj = GST_MINI_OBJECT_CAST (buffer);
+
+  return buffer->pool != NULL && GST_MINI_OBJECT_REFCOUNT_VALUE (obj) == 1 &&
+      obj->dispose == (GstMiniObjectDisposeFunction) _gst_buffer_dispose &&
+      obj->n_qdata == 0;
+}
+
 static void
 _gst_buffer_free (GstBuffer * buffer)
 {
@@ -564,7 +771,7 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    _meta_item_free (buffer, walk, info);
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -577,20 +784,25 @@ _gst_buffer_free (GstBuffer * buffer)
     gst_memory_unlock (GST_BUFFER_MEM_PTR (buffer, i), GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (GST_BUFFER_MEM_PTR (buffer, i));
   }
+  if (GST_BUFFER_MEM_ARRAY (buffer) != GST_BUFFER_MEM_INLINED (buffer))
+    g_free (GST_BUFFER_MEM_ARRAY (buffer));
+  if (GST_BUFFER_META_SLOTS_ARRAY (buffer))
+    g_slice_free1 (sizeof (GstMeta *) * GST_BUFFER_META_SLOTS,
+        GST_BUFFER_META_SLOTS_ARRAY (buffer));
 
   /* we set msize to 0 when the buffer is part of the memory block */
   if (msize) {
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    _buffer_impl_free ((GstBufferImpl *) buffer, msize);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
 }
 
 static void
-gst_buffer_init (GstBufferImpl * buffer, gsize size)
+gst_buffer_init (GstBufferImpl * buffer, gsize size, gsize meta_size)
 {
   gst_mini_object_init (GST_MINI_OBJECT_CAST (buffer), 0, _gst_buffer_type,
       (GstMiniObjectCopyFunction) _gst_buffer_copy,
@@ -607,7 +819,14 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
   GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
+  GST_BUFFER_MEM_ALLOC (buffer) = GST_BUFFER_MEM_INLINE;
+  GST_BUFFER_MEM_ARRAY (buffer) = GST_BUFFER_MEM_INLINED (buffer);
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_META_SIZE (buffer) = meta_size;
+  GST_BUFFER_META_USED (buffer) = 0;
+  GST_BUFFER_META_INLINE (buffer) = 0;
+  GST_BUFFER_META_MASK (buffer) = 0;
+  GST_BUFFER_META_SLOTS_ARRAY (buffer) = NULL;
 }
 
 /**
@@ -624,10 +843,52 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _buffer_impl_alloc ();
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
-  gst_buffer_init (newbuf, sizeof (GstBufferImpl));
+  gst_buffer_init (newbuf, GST_BUFFER_IMPL_SIZE, 0);
+
+  return GST_BUFFER_CAST (newbuf);
+}
+
+/**
+ * gst_buffer_new_reserve_meta:
+ * @infos: (array length=n_infos): the #GstMetaInfo of the metadata to
+ *     reserve space for
+ * @n_infos: the number of elements in @infos
+ *
+ * Creates a newly allocated buffer without any data with space reserved for
+ * one metadata item of each of the @infos. Metadata added with
+ * gst_buffer_add_meta() is stored in the reserved space when it fits, so that
+ * the buffer and its metadata use only a single allocation.
+ *
+ * MT safe.
+ *
+ * Returns: (transfer full): the new #GstBuffer.
+ *
+ * Since: 1.2
+ */
+GstBuffer *
+gst_buffer_new_reserve_meta (const GstMetaInfo ** infos, guint n_infos)
+{
+  GstBufferImpl *newbuf;
+  gsize meta_size;
+  guint i;
+
+  g_return_val_if_fail (infos != NULL || n_infos == 0, NULL);
+
+  meta_size = 0;
+  for (i = 0; i < n_infos; i++)
+    meta_size += ITEM_ALIGN (ITEM_SIZE (infos[i]));
+
+  if (meta_size == 0)
+    return gst_buffer_new ();
+
+  newbuf = g_slice_alloc (GST_BUFFER_IMPL_SIZE + meta_size);
+  GST_CAT_LOG (GST_CAT_BUFFER, "new %p with %" G_GSIZE_FORMAT
+      " bytes for metadata", newbuf, meta_size);
+
+  gst_buffer_init (newbuf, GST_BUFFER_IMPL_SIZE + meta_size, meta_size);
 
   return GST_BUFFER_CAST (newbuf);
 }
@@ -690,7 +951,7 @@ gst_buffer_new_allocate (GstAllocator * allocator, gsize size,
 
   newbuf = GST_BUFFER_CAST (data);
 
-  gst_buffer_init ((GstBufferImpl *) data, asize);
+  gst_buffer_init ((GstBufferImpl *) data, asize, 0);
   if (size > 0) {
     mem = gst_memory_new_wrapped (0, data + sizeof (GstBufferImpl), NULL,
         size, 0, size);
@@ -711,7 +972,7 @@ gst_buffer_new_allocate (GstAllocator * allocator, gsize size,
   /* map the data part and init the buffer in it, set the buffer size to 0 so
    * that a finalize won't free the buffer */
   data = gst_memory_map (mem, &asize, NULL, GST_MAP_WRITE);
-  gst_buffer_init ((GstBufferImpl *) data, 0);
+  gst_buffer_init ((GstBufferImpl *) data, 0, 0);
   gst_memory_unmap (mem);
 
   /* strip off the buffer */
@@ -851,9 +1112,10 @@ gst_buffer_append_memory (GstBuffer * buffer, GstMemory * mem)
  * Insert the memory block @mem to @buffer at @idx. This function takes ownership
  * of @mem and thus doesn't increase its refcount.
  *
- * Only gst_buffer_get_max_memory() can be added to a buffer. If more memory is
- * added, existing memory blocks will automatically be merged to make room for
- * the new memory.
+ * Only gst_buffer_get_max_memory() can be added to a buffer. Adding memory
+ * does not copy or merge the existing memory blocks unless that limit is
+ * reached, in which case existing memory blocks will automatically be merged
+ * to make room for the new memory.
  */
 void
 gst_buffer_insert_memory (GstBuffer * buffer, gint idx, GstMemory * mem)
@@ -1877,10 +2139,18 @@ gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
   GstMetaItem *item;
   GstMeta *result = NULL;
+  guint id;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
+  id = _priv_gst_meta_api_get_id (api);
+  if (G_LIKELY (META_SLOT_VALID (id))) {
+    if (GST_BUFFER_META_MASK (buffer) & META_SLOT_BIT (id))
+      result = GST_BUFFER_META_SLOT (buffer, id - 1);
+    return result;
+  }
+
   /* find GstMeta of the requested API */
   for (item = GST_BUFFER_META (buffer); item; item = item->next) {
     GstMeta *meta = &item->meta;
@@ -1908,15 +2178,14 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
 {
   GstMetaItem *item;
   GstMeta *result = NULL;
-  gsize size;
+  guint id;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (info != NULL, NULL);
   g_return_val_if_fail (gst_buffer_is_writable (buffer), NULL);
 
-  /* create a new slice */
-  size = ITEM_SIZE (info);
-  item = g_slice_alloc (size);
+  /* create a new item */
+  item = _meta_item_alloc (buffer, info);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -1934,11 +2203,21 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   item->next = GST_BUFFER_META (buffer);
   GST_BUFFER_META (buffer) = item;
 
+  /* the newest metadata of an API is the one found by lookups */
+  id = _priv_gst_meta_api_get_id (info->api);
+  if (META_SLOT_VALID (id)) {
+    if (G_UNLIKELY (GST_BUFFER_META_SLOTS_ARRAY (buffer) == NULL))
+      GST_BUFFER_META_SLOTS_ARRAY (buffer) =
+          g_slice_alloc (sizeof (GstMeta *) * GST_BUFFER_META_SLOTS);
+    GST_BUFFER_META_SLOT (buffer, id - 1) = result;
+    GST_BUFFER_META_MASK (buffer) |= META_SLOT_BIT (id);
+  }
+
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _meta_item_free (buffer, item, info);
     return NULL;
   }
 }
@@ -1976,12 +2255,14 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         GST_BUFFER_META (buffer) = walk->next;
       else
         prev->next = walk->next;
+      _meta_slot_remove (buffer, m);
+
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
-      /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      /* and free the item */
+      _meta_item_free (buffer, walk, info);
       break;
     }
     prev = walk;
@@ -2024,6 +2305,60 @@ gst_buffer_iterate_meta (GstBuffer * buffer, gpointer * state)
     return NULL;
 }
 
+/**
+ * gst_buffer_iterate_meta_filtered:
+ * @buffer: a #GstBuffer
+ * @state: an opaque state pointer
+ * @api: only return #GstMeta of this type
+ *
+ * Retrieve the next #GstMeta of type @api after the current one according to
+ * @state. If @state points to %NULL, the first metadata of type @api is
+ * returned.
+ *
+ * @state will be updated with an opaque state pointer
+ *
+ * Returns: (transfer none): The next #GstMeta of type @api or %NULL when
+ * there are no more items.
+ *
+ * Since: 1.2
+ */
+GstMeta *
+gst_buffer_iterate_meta_filtered (GstBuffer * buffer, gpointer * state,
+    GType api)
+{
+  GstMetaItem **meta;
+  guint id;
+
+  g_return_val_if_fail (buffer != NULL, NULL);
+  g_return_val_if_fail (state != NULL, NULL);
+  g_return_val_if_fail (api != 0, NULL);
+
+  meta = (GstMetaItem **) state;
+
+  if (*meta == NULL) {
+    id = _priv_gst_meta_api_get_id (api);
+    if (META_SLOT_VALID (id)) {
+      /* no metadata of this API, or start from the first one */
+      if (!(GST_BUFFER_META_MASK (buffer) & META_SLOT_BIT (id)))
+        return NULL;
+      *meta = (GstMetaItem *) ((guint8 *) GST_BUFFER_META_SLOT (buffer,
+              id - 1) - G_STRUCT_OFFSET (GstMetaItem, meta));
+      return &(*meta)->meta;
+    }
+    *meta = GST_BUFFER_META (buffer);
+  } else {
+    *meta = (*meta)->next;
+  }
+
+  while (*meta != NULL && (*meta)->meta.info->api != api)
+    *meta = (*meta)->next;
+
+  if (*meta)
+    return &(*meta)->meta;
+  else
+    return NULL;
+}
+
 /**
  * gst_buffer_foreach_meta:
  * @buffer: a #GstBuffer
@@ -2073,13 +2408,16 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         GST_BUFFER_META (buffer) = next;
       else
         prev->next = next;
+      _meta_slot_remove (buffer, m);
 
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
-      /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      /* and free the item */
+      _meta_item_free (buffer, walk, info);
+    } else {
+      prev = walk;
     }
     if (!res)
       break;
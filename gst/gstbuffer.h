@@ -508,12 +508,16 @@ GstBuffer*      gst_buffer_append               (GstBuffer *buf1, GstBuffer *buf
 typedef gboolean (*GstBufferForeachMetaFunc)    (GstBuffer *buffer, GstMeta **meta,
                                                  gpointer user_data);
 
+GstBuffer *     gst_buffer_new_reserve_meta     (const GstMetaInfo **infos, guint n_infos);
+
 GstMeta *       gst_buffer_get_meta             (GstBuffer *buffer, GType api);
 GstMeta *       gst_buffer_add_meta             (GstBuffer *buffer, const GstMetaInfo *info,
                                                  gpointer params);
 gboolean        gst_buffer_remove_meta          (GstBuffer *buffer, GstMeta *meta);
 
 GstMeta *       gst_buffer_iterate_meta         (GstBuffer *buffer, gpointer *state);
+GstMeta *       gst_buffer_iterate_meta_filtered (GstBuffer *buffer, gpointer *state,
+                                                  GType api);
 
 gboolean        gst_buffer_foreach_meta         (GstBuffer *buffer,
                                                  GstBufferForeachMetaFunc func,
@@ -83,16 +83,39 @@ _gst_buffer_list_copy (GstBufferList * list)
   return copy;
 }
 
+/* max number of buffers released to a pool at once when freeing a list */
+#define RELEASE_BATCH 64
+
 static void
 _gst_buffer_list_free (GstBufferList * list)
 {
-  guint i, len;
+  GstBuffer *batch[RELEASE_BATCH];
+  GstBufferPool *pool = NULL;
+  guint i, len, n = 0;
   GST_LOG ("free %p", list);
 
   /* unrefs all buffers too */
   len = list->array->len;
-  for (i = 0; i < len; i++)
-    gst_buffer_unref (g_array_index (list->array, GstBuffer *, i));
+  for (i = 0; i < len; i++) {
+    GstBuffer *buf = g_array_index (list->array, GstBuffer *, i);
+
+    /* when we hold the last ref to a pooled buffer, unreffing it would only
+     * return it to its pool. Collect consecutive buffers of the same pool
+     * and return them in one go. */
+    if (_priv_gst_buffer_can_release_batched (buf)) {
+      if (buf->pool != pool || n == RELEASE_BATCH) {
+        if (n > 0)
+          _priv_gst_buffer_pool_release_buffers (pool, batch, n);
+        pool = buf->pool;
+        n = 0;
+      }
+      batch[n++] = buf;
+    } else {
+      gst_buffer_unref (buf);
+    }
+  }
+  if (n > 0)
+    _priv_gst_buffer_pool_release_buffers (pool, batch, n);
   g_array_free (list->array, TRUE);
 
   g_slice_free1 (sizeof (GstBufferList), list);
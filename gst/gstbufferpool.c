@@ -62,6 +62,12 @@
  * Use gst_object_unref() to release the reference to a bufferpool. If the
  * refcount of the pool reaches 0, the pool will be freed.
  *
+ * Pools that are used from many streaming threads at high buffer rates can
+ * enable a thread cache with gst_buffer_pool_config_set_thread_cache(). The
+ * default acquire and release implementations will then recycle buffers in
+ * small per-thread magazines and only move buffers from and to the shared
+ * queue of the pool in batches.
+ *
  * Last reviewed on 2012-03-28 (0.11.3)
  */
 
@@ -75,7 +81,6 @@
 #include <sys/types.h>
 
 #include "gstatomicqueue.h"
-#include "gstpoll.h"
 #include "gstinfo.h"
 #include "gstquark.h"
 #include "gstvalue.h"
@@ -91,10 +96,44 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+/* number of magazines in a pool with a thread cache, must be a power of 2.
+ * Threads are assigned a magazine in a round-robin fashion */
+#define N_MAGAZINES     16
+#define CACHE_LINE_SIZE 64
+
+typedef struct _GstBufferPoolMagazine GstBufferPoolMagazine;
+
+/* a small cache of buffers used by one thread. The busy flag is taken with a
+ * compare-and-exchange, when that fails another thread is using the same
+ * magazine and we fall back to the shared queue. */
+struct _GstBufferPoolMagazine
+{
+  volatile gint busy;
+  guint n_buffers;
+  GstBuffer **buffers;
+
+  /* keep magazines in separate cache lines */
+  gchar _pad[CACHE_LINE_SIZE - 2 * sizeof (gint) - sizeof (gpointer)];
+};
+
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
-  GstPoll *poll;
+
+  /* protects waiting for released buffers. Releasing only takes the lock
+   * when the waiting counter is not 0 */
+  GMutex wait_lock;
+  GCond wait_cond;
+
+  /* thread cache, NULL when disabled. magazines is aligned to a cache line
+   * inside magazines_mem */
+  GstBufferPoolMagazine *magazines;
+  gpointer magazines_mem;
+  guint magazine_size;
+  /* buffers in all magazines together, at most magazine_size */
+  volatile gint cached;
+  /* number of threads blocked in acquire */
+  volatile gint waiting;
 
   GRecMutex rec_lock;
 
@@ -165,8 +204,9 @@ gst_buffer_pool_init (GstBufferPool * pool)
   priv = pool->priv = GST_BUFFER_POOL_GET_PRIVATE (pool);
 
   g_rec_mutex_init (&priv->rec_lock);
+  g_mutex_init (&priv->wait_lock);
+  g_cond_init (&priv->wait_cond);
 
-  priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (10);
   pool->flushing = 1;
   priv->active = FALSE;
@@ -178,11 +218,276 @@ gst_buffer_pool_init (GstBufferPool * pool)
   gst_allocation_params_init (&priv->params);
   gst_buffer_pool_config_set_allocator (priv->config, priv->allocator,
       &priv->params);
-  gst_poll_write_control (priv->poll);
 
   GST_DEBUG_OBJECT (pool, "created");
 }
 
+/* wake up threads waiting for a free buffer. This only costs an atomic read
+ * when nobody is waiting. */
+static inline void
+wake_waiters (GstBufferPool * pool, gboolean all)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (G_LIKELY (g_atomic_int_get (&priv->waiting) == 0))
+    return;
+
+  g_mutex_lock (&priv->wait_lock);
+  if (all)
+    g_cond_broadcast (&priv->wait_cond);
+  else
+    g_cond_signal (&priv->wait_cond);
+  g_mutex_unlock (&priv->wait_lock);
+}
+
+/* get the allocator used for pools bound to a NUMA node without an
+ * allocator. This is a plain anonymous mmap allocator shared by all pools,
+ * the registered #GST_ALLOCATOR_MMAP allocator would give each buffer its own
+ * memfd and try reserved huge pages for every big allocation. Returns NULL
+ * when mmap() is not supported. */
+static gpointer
+create_numa_allocator (gpointer data)
+{
+  return gst_mmap_allocator_new (GST_MMAP_ALLOCATOR_FLAG_NONE);
+}
+
+static GstAllocator *
+get_numa_allocator (void)
+{
+  static GOnce numa_allocator = G_ONCE_INIT;
+  GstAllocator *allocator;
+
+  allocator = g_once (&numa_allocator, create_numa_allocator, NULL);
+
+  return allocator ? gst_object_ref (allocator) : NULL;
+}
+
+/* per-thread index used to pick a magazine */
+static GPrivate magazine_index = G_PRIVATE_INIT (NULL);
+static volatile gint magazine_counter = 0;
+
+static inline GstBufferPoolMagazine *
+get_magazine (GstBufferPoolPrivate * priv)
+{
+  gint idx;
+
+  idx = GPOINTER_TO_INT (g_private_get (&magazine_index));
+  if (G_UNLIKELY (idx == 0)) {
+    idx = g_atomic_int_add (&magazine_counter, 1) + 1;
+    g_private_set (&magazine_index, GINT_TO_POINTER (idx));
+  }
+  return &priv->magazines[(idx - 1) & (N_MAGAZINES - 1)];
+}
+
+/* put @buffer in the shared queue. The ring buffer of a pool with a maximum
+ * number of buffers can hold all the buffers of the pool, so it is only full
+ * when more buffers are released than were allocated. Such a buffer is freed
+ * instead of spinning until there is room. */
+static void
+queue_push_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass;
+
+  if (G_LIKELY (gst_atomic_queue_try_push (priv->queue, buffer)))
+    return;
+
+  GST_WARNING_OBJECT (pool, "queue full, freeing buffer %p", buffer);
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+  if (G_LIKELY (pclass->free_buffer))
+    pclass->free_buffer (pool, buffer);
+  g_atomic_int_add (&priv->cur_buffers, -1);
+}
+
+/* move buffers from @mag to the shared queue until @keep buffers are left.
+ * Must be called with the magazine busy flag taken */
+static void
+magazine_flush (GstBufferPool * pool, GstBufferPoolMagazine * mag, guint keep)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  while (mag->n_buffers > keep) {
+    GstBuffer *buffer = mag->buffers[--mag->n_buffers];
+
+    queue_push_buffer (pool, buffer);
+    g_atomic_int_add (&priv->cached, -1);
+  }
+  wake_waiters (pool, TRUE);
+}
+
+/* move all buffers from the magazines that are not in use to the shared
+ * queue. This is done when a thread is waiting for buffers so that buffers
+ * cached by other threads become available. */
+static void
+magazines_drain (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  for (i = 0; i < N_MAGAZINES; i++) {
+    GstBufferPoolMagazine *mag = &priv->magazines[i];
+
+    if (!g_atomic_int_compare_and_exchange (&mag->busy, 0, 1))
+      continue;
+    if (mag->n_buffers > 0) {
+      GST_LOG_OBJECT (pool, "draining %u buffers from magazine %u",
+          mag->n_buffers, i);
+      magazine_flush (pool, mag, 0);
+    }
+    g_atomic_int_set (&mag->busy, 0);
+  }
+}
+
+/* reserve room for one buffer in the magazines, they hold at most
+ * magazine_size buffers together */
+static inline gboolean
+magazine_reserve (GstBufferPoolPrivate * priv)
+{
+  if ((guint) g_atomic_int_add (&priv->cached, 1) >= priv->magazine_size) {
+    g_atomic_int_add (&priv->cached, -1);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static GstBuffer *
+magazine_pop (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag;
+  GstBuffer *buffer = NULL;
+
+  mag = get_magazine (priv);
+  if (!g_atomic_int_compare_and_exchange (&mag->busy, 0, 1))
+    return NULL;
+
+  if (mag->n_buffers == 0) {
+    /* empty, refill half of the magazine from the shared queue */
+    while (mag->n_buffers < MAX (priv->magazine_size / 2, 1)) {
+      GstBuffer *b;
+
+      if (!magazine_reserve (priv))
+        break;
+      if (!(b = gst_atomic_queue_pop (priv->queue))) {
+        g_atomic_int_add (&priv->cached, -1);
+        break;
+      }
+      mag->buffers[mag->n_buffers++] = b;
+    }
+  }
+  if (mag->n_buffers > 0) {
+    buffer = mag->buffers[--mag->n_buffers];
+    g_atomic_int_add (&priv->cached, -1);
+  }
+
+  g_atomic_int_set (&mag->busy, 0);
+
+  return buffer;
+}
+
+static gboolean
+magazine_push (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag;
+
+  /* the magazines together hold at most magazine_size buffers. Buffers that
+   * are released in another thread than the one acquiring them would
+   * otherwise pile up in the magazine of the releasing thread. */
+  if (!magazine_reserve (priv))
+    return FALSE;
+
+  mag = get_magazine (priv);
+  if (!g_atomic_int_compare_and_exchange (&mag->busy, 0, 1)) {
+    g_atomic_int_add (&priv->cached, -1);
+    return FALSE;
+  }
+
+  /* full, move half of the magazine to the shared queue */
+  if (mag->n_buffers == priv->magazine_size)
+    magazine_flush (pool, mag, priv->magazine_size / 2);
+
+  mag->buffers[mag->n_buffers++] = buffer;
+
+  g_atomic_int_set (&mag->busy, 0);
+
+  return TRUE;
+}
+
+static void
+free_magazines (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  if (priv->magazines == NULL)
+    return;
+
+  /* normally empty after stop, make sure we don't lose buffers */
+  magazines_drain (pool);
+
+  for (i = 0; i < N_MAGAZINES; i++)
+    g_free (priv->magazines[i].buffers);
+  g_free (priv->magazines_mem);
+  priv->magazines_mem = NULL;
+  priv->magazines = NULL;
+  priv->magazine_size = 0;
+  priv->cached = 0;
+}
+
+static void
+alloc_magazines (GstBufferPool * pool, guint size)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  free_magazines (pool);
+
+  if (size == 0)
+    return;
+
+  /* align the magazines to a cache line so that their padding keeps them
+   * apart */
+  priv->magazines_mem = g_malloc0 (sizeof (GstBufferPoolMagazine) *
+      N_MAGAZINES + CACHE_LINE_SIZE - 1);
+  priv->magazines = (GstBufferPoolMagazine *)
+      (((guintptr) priv->magazines_mem + CACHE_LINE_SIZE - 1) &
+      ~(guintptr) (CACHE_LINE_SIZE - 1));
+  for (i = 0; i < N_MAGAZINES; i++)
+    priv->magazines[i].buffers = g_new (GstBuffer *, size);
+  priv->magazine_size = size;
+}
+
+/* pools with a maximum number of buffers keep the free buffers in a ring
+ * buffer that never allocates, other pools use an unbounded queue. Must be
+ * called when the pool is not active and has no outstanding buffers. */
+static void
+update_queue (GstBufferPool * pool, guint max_buffers)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass;
+  GstAtomicQueue *queue;
+  GstBuffer *buffer;
+
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  if (max_buffers > 0)
+    queue = gst_atomic_queue_new_full (max_buffers,
+        GST_ATOMIC_QUEUE_FLAG_BOUNDED);
+  else
+    queue = gst_atomic_queue_new (10);
+
+  /* normally empty, move the buffers that still fit */
+  while ((buffer = gst_atomic_queue_pop (priv->queue))) {
+    if (gst_atomic_queue_try_push (queue, buffer))
+      continue;
+    if (G_LIKELY (pclass->free_buffer))
+      pclass->free_buffer (pool, buffer);
+  }
+  gst_atomic_queue_unref (priv->queue);
+  priv->queue = queue;
+}
+
 static void
 gst_buffer_pool_finalize (GObject * object)
 {
@@ -195,8 +500,10 @@ gst_buffer_pool_finalize (GObject * object)
   GST_DEBUG_OBJECT (pool, "finalize");
 
   gst_buffer_pool_set_active (pool, FALSE);
+  free_magazines (pool);
   gst_atomic_queue_unref (priv->queue);
-  gst_poll_free (priv->poll);
+  g_cond_clear (&priv->wait_cond);
+  g_mutex_clear (&priv->wait_lock);
   gst_structure_free (priv->config);
   g_rec_mutex_clear (&priv->rec_lock);
   if (priv->allocator)
@@ -373,10 +680,13 @@ default_stop (GstBufferPool * pool)
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
+  /* move the cached buffers back to the queue */
+  if (priv->magazines)
+    magazines_drain (pool);
+
   /* clear the pool */
   while ((buffer = gst_atomic_queue_pop (priv->queue))) {
     GST_LOG_OBJECT (pool, "freeing %p", buffer);
-    gst_poll_read_control (priv->poll);
 
     if (G_LIKELY (pclass->free_buffer))
       pclass->free_buffer (pool, buffer);
@@ -451,14 +761,13 @@ gst_buffer_pool_set_active (GstBufferPool * pool, gboolean active)
       goto start_failed;
 
     /* unset the flushing state now */
-    gst_poll_read_control (priv->poll);
     g_atomic_int_set (&pool->flushing, 0);
   } else {
     gint outstanding;
 
-    /* set to flushing first */
+    /* set to flushing first and unblock all waiting threads */
     g_atomic_int_set (&pool->flushing, 1);
-    gst_poll_write_control (priv->poll);
+    wake_waiters (pool, TRUE);
 
     /* when all buffers are in the pool, free them. Else they will be
      * freed when they are released */
@@ -529,6 +838,7 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   guint size, min_buffers, max_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+  guint cache_size;
 
   /* parse the config and keep around */
   if (!gst_buffer_pool_config_get_params (config, &caps, &size, &min_buffers,
@@ -538,8 +848,14 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   if (!gst_buffer_pool_config_get_allocator (config, &allocator, &params))
     goto wrong_config;
 
+  if (!gst_buffer_pool_config_get_thread_cache (config, &cache_size))
+    goto wrong_config;
+
   GST_DEBUG_OBJECT (pool, "config %" GST_PTR_FORMAT, config);
 
+  if (max_buffers != priv->max_buffers)
+    update_queue (pool, max_buffers);
+
   priv->size = size;
   priv->min_buffers = min_buffers;
   priv->max_buffers = max_buffers;
@@ -549,8 +865,14 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
     gst_object_unref (priv->allocator);
   if ((priv->allocator = allocator))
     gst_object_ref (allocator);
+  else if (gst_allocation_params_get_numa_node (&params) >= 0)
+    /* the default allocator can't place memory on a node */
+    priv->allocator = get_numa_allocator ();
   priv->params = params;
 
+  if (cache_size != priv->magazine_size)
+    alloc_magazines (pool, cache_size);
+
   return TRUE;
 
 wrong_config:
@@ -775,6 +1097,12 @@ gst_buffer_pool_config_set_params (GstStructure * config, GstCaps * caps,
  * to operate with different allocators or cannot allocate with the values
  * specified in @params. Use gst_buffer_pool_get_config() to get the currently
  * used values.
+ *
+ * A pool can be bound to a NUMA node by setting the node in @params with
+ * gst_allocation_params_set_numa_node(). When no @allocator is given, the
+ * default pool will then allocate plain anonymous memory with an allocator
+ * created with gst_mmap_allocator_new(), which places the memory on the
+ * requested node.
  */
 void
 gst_buffer_pool_config_set_allocator (GstStructure * config,
@@ -970,6 +1298,66 @@ gst_buffer_pool_config_get_allocator (GstStructure * config,
   return TRUE;
 }
 
+/**
+ * gst_buffer_pool_config_set_thread_cache:
+ * @config: a #GstBufferPool configuration
+ * @size: the maximum number of buffers held by the thread caches of all
+ *     threads together, or 0 to disable the thread cache.
+ *
+ * Configure the thread cache of the pool. When enabled, the default acquire
+ * and release implementations keep released buffers in a per-thread cache
+ * and only move buffers from and to the shared queue of the pool in
+ * batches. This reduces contention when buffers are acquired and released
+ * from many threads at high rates.
+ *
+ * The thread caches of all threads together hold at most @size buffers,
+ * further released buffers go to the shared queue. Buffers in the thread
+ * cache of other threads are returned to the shared queue before the pool
+ * allocates a new buffer or blocks because it reached its maximum amount of
+ * buffers, so a pool with a thread cache does not grow beyond what it would
+ * without one.
+ *
+ * Since: 1.2
+ */
+void
+gst_buffer_pool_config_set_thread_cache (GstStructure * config, guint size)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (THREAD_CACHE), G_TYPE_UINT, size, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_thread_cache:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @size: (out) (allow-none): the maximum number of buffers held by the thread
+ *     caches of all threads together
+ *
+ * Get the thread cache size from @config. @size is set to 0 when no
+ * thread cache was configured.
+ *
+ * Returns: %TRUE if the thread cache size could be fetched.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_buffer_pool_config_get_thread_cache (GstStructure * config, guint * size)
+{
+  const GValue *value;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  value = gst_structure_id_get_value (config, GST_QUARK (THREAD_CACHE));
+  if (value && !G_VALUE_HOLDS_UINT (value))
+    return FALSE;
+
+  if (size)
+    *size = value ? g_value_get_uint (value) : 0;
+
+  return TRUE;
+}
+
 static GstFlowReturn
 default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -981,15 +1369,40 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
       goto flushing;
 
+    /* try the thread cache first */
+    if (priv->magazines) {
+      *buffer = magazine_pop (pool);
+      /* give back what we cached when someone is waiting */
+      if (G_UNLIKELY (g_atomic_int_get (&priv->waiting)))
+        magazines_drain (pool);
+      if (G_LIKELY (*buffer)) {
+        result = GST_FLOW_OK;
+        GST_LOG_OBJECT (pool, "acquired cached buffer %p", *buffer);
+        break;
+      }
+    }
+
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
-      gst_poll_read_control (priv->poll);
       result = GST_FLOW_OK;
       GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
       break;
     }
 
+    /* reuse buffers cached by other threads before allocating new ones, this
+     * happens when buffers are released in another thread than the one
+     * acquiring them */
+    if (priv->magazines && g_atomic_int_get (&priv->cached) > 0) {
+      magazines_drain (pool);
+      *buffer = gst_atomic_queue_pop (priv->queue);
+      if (G_LIKELY (*buffer)) {
+        result = GST_FLOW_OK;
+        GST_LOG_OBJECT (pool, "acquired drained buffer %p", *buffer);
+        break;
+      }
+    }
+
     /* no buffer, try to allocate some more */
     GST_LOG_OBJECT (pool, "no buffer, trying to allocate");
     result = do_alloc_buffer (pool, buffer, NULL);
@@ -1007,9 +1420,20 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       break;
     }
 
-    /* now wait */
+    /* now wait. We first announce ourselves as a waiter so that releasing
+     * threads start signaling us, then check again if something was released
+     * before we registered before blocking. */
     GST_LOG_OBJECT (pool, "waiting for free buffers");
-    gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
+    g_atomic_int_inc (&priv->waiting);
+    /* buffers might be sitting in the cache of other threads */
+    if (priv->magazines)
+      magazines_drain (pool);
+    g_mutex_lock (&priv->wait_lock);
+    if (gst_atomic_queue_length (priv->queue) == 0 &&
+        !GST_BUFFER_POOL_IS_FLUSHING (pool))
+      g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+    g_mutex_unlock (&priv->wait_lock);
+    g_atomic_int_add (&priv->waiting, -1);
   }
 
   return result;
@@ -1023,9 +1447,9 @@ flushing:
 }
 
 static inline void
-dec_outstanding (GstBufferPool * pool)
+dec_outstanding (GstBufferPool * pool, gint n)
 {
-  if (g_atomic_int_dec_and_test (&pool->priv->outstanding)) {
+  if (g_atomic_int_add (&pool->priv->outstanding, -n) == n) {
     /* all buffers are returned to the pool, see if we need to free them */
     if (GST_BUFFER_POOL_IS_FLUSHING (pool)) {
       /* take the lock so that set_active is not run concurrently */
@@ -1105,7 +1529,7 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
      * pool incremented */
     (*buffer)->pool = gst_object_ref (pool);
   } else {
-    dec_outstanding (pool);
+    dec_outstanding (pool, 1);
   }
 
   return result;
@@ -1114,10 +1538,20 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 static void
 default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
 {
-  /* keep it around in our queue */
+  GstBufferPoolPrivate *priv = pool->priv;
+
   GST_LOG_OBJECT (pool, "released buffer %p", buffer);
-  gst_atomic_queue_push (pool->priv->queue, buffer);
-  gst_poll_write_control (pool->priv->poll);
+
+  /* keep it around in our thread cache when we can */
+  if (priv->magazines && magazine_push (pool, buffer)) {
+    if (G_UNLIKELY (g_atomic_int_get (&priv->waiting)))
+      magazines_drain (pool);
+    return;
+  }
+
+  /* else keep it around in our queue */
+  queue_push_buffer (pool, buffer);
+  wake_waiters (pool, FALSE);
 }
 
 /**
@@ -1153,8 +1587,56 @@ gst_buffer_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (G_LIKELY (pclass->release_buffer))
     pclass->release_buffer (pool, buffer);
 
-  dec_outstanding (pool);
+  dec_outstanding (pool, 1);
 
   /* decrease the refcount that the buffer had to us */
   gst_object_unref (pool);
 }
+
+/* release @n_buffers buffers to @pool at once. This is used when a buffer
+ * list holding the last references to pooled buffers is freed, the buffers
+ * are pushed to the queue with one atomic operation when possible */
+void
+_priv_gst_buffer_pool_release_buffers (GstBufferPool * pool,
+    GstBuffer ** buffers, guint n_buffers)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass;
+  guint i, n;
+
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  for (i = 0, n = 0; i < n_buffers; i++) {
+    GstBuffer *buffer = buffers[i];
+
+    if (!g_atomic_pointer_compare_and_exchange (&buffer->pool, pool, NULL))
+      continue;
+
+    if (G_LIKELY (pclass->reset_buffer))
+      pclass->reset_buffer (pool, buffer);
+
+    buffers[n++] = buffer;
+  }
+  if (n == 0)
+    return;
+
+  if (pclass->release_buffer == default_release_buffer && !priv->magazines) {
+    GST_LOG_OBJECT (pool, "released %u buffers", n);
+
+    /* a bounded queue has room for all buffers of the pool, this only loops
+     * when other threads release buffers concurrently */
+    for (i = 0; i < n;)
+      i += gst_atomic_queue_push_many (priv->queue, (gpointer *) buffers + i,
+          n - i);
+    wake_waiters (pool, TRUE);
+  } else if (G_LIKELY (pclass->release_buffer)) {
+    for (i = 0; i < n; i++)
+      pclass->release_buffer (pool, buffers[i]);
+  }
+
+  dec_outstanding (pool, n);
+
+  /* decrease the refcounts that the buffers had to us */
+  for (i = 0; i < n; i++)
+    gst_object_unref (pool);
+}
@@ -191,6 +191,8 @@ void             gst_buffer_pool_config_set_allocator (GstStructure *config, Gst
                                                        const GstAllocationParams *params);
 gboolean         gst_buffer_pool_config_get_allocator (GstStructure *config, GstAllocator **allocator,
                                                        GstAllocationParams *params);
+void             gst_buffer_pool_config_set_thread_cache (GstStructure *config, guint size);
+gboolean         gst_buffer_pool_config_get_thread_cache (GstStructure *config, guint *size);
 
 /* options */
 guint            gst_buffer_pool_config_n_options   (GstStructure *config);
@@ -92,11 +92,13 @@ enum
 };
 
 #define DEFAULT_ENABLE_ASYNC (TRUE)
+#define DEFAULT_QUEUE_SIZE   (0)
 
 enum
 {
   PROP_0,
-  PROP_ENABLE_ASYNC
+  PROP_ENABLE_ASYNC,
+  PROP_QUEUE_SIZE
 };
 
 static void gst_bus_dispose (GObject * object);
@@ -107,6 +109,8 @@ static guint gst_bus_signals[LAST_SIGNAL] = { 0 };
 struct _GstBusPrivate
 {
   GstAtomicQueue *queue;
+  /* unbounded queue for the messages that don't fit in a bounded queue */
+  GstAtomicQueue *overflow;
   GMutex queue_lock;
 
   GstBusSyncHandler sync_handler;
@@ -120,6 +124,7 @@ struct _GstBusPrivate
   GSource *watch_id;
 
   gboolean enable_async;
+  guint queue_size;
   GstPoll *poll;
   GPollFD pollfd;
 };
@@ -137,6 +142,25 @@ gst_bus_set_property (GObject * object,
     case PROP_ENABLE_ASYNC:
       bus->priv->enable_async = g_value_get_boolean (value);
       break;
+    case PROP_QUEUE_SIZE:
+      bus->priv->queue_size = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bus_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstBus *bus = GST_BUS_CAST (object);
+
+  switch (prop_id) {
+    case PROP_QUEUE_SIZE:
+      g_value_set_uint (value, bus->priv->queue_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -148,6 +172,15 @@ gst_bus_constructed (GObject * object)
 {
   GstBus *bus = GST_BUS_CAST (object);
 
+  /* messages are popped with the queue lock, so there is only a single
+   * consumer at a time */
+  if (bus->priv->queue_size > 0) {
+    bus->priv->queue = gst_atomic_queue_new_full (bus->priv->queue_size,
+        GST_ATOMIC_QUEUE_FLAG_BOUNDED | GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER);
+    bus->priv->overflow = gst_atomic_queue_new (32);
+  } else
+    bus->priv->queue = gst_atomic_queue_new (32);
+
   if (bus->priv->enable_async) {
     bus->priv->poll = gst_poll_new_timer ();
     gst_poll_get_read_gpollfd (bus->priv->poll, &bus->priv->pollfd);
@@ -162,6 +195,7 @@ gst_bus_class_init (GstBusClass * klass)
   gobject_class->dispose = gst_bus_dispose;
   gobject_class->finalize = gst_bus_finalize;
   gobject_class->set_property = gst_bus_set_property;
+  gobject_class->get_property = gst_bus_get_property;
   gobject_class->constructed = gst_bus_constructed;
 
   /**
@@ -180,6 +214,25 @@ gst_bus_class_init (GstBusClass * klass)
           DEFAULT_ENABLE_ASYNC,
           G_PARAM_CONSTRUCT_ONLY | G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBus::queue-size:
+   *
+   * The number of messages the bus can queue for async delivery in a
+   * preallocated ring buffer, or 0 to only use a growing queue.
+   *
+   * This does not limit the number of queued messages. When the ring buffer
+   * is full, gst_bus_post() does not wait but queues the message in an
+   * overflow queue that grows as needed. All new messages go to the
+   * overflow queue until it is drained so that the messages stay in order.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_QUEUE_SIZE,
+      g_param_spec_uint ("queue-size", "Queue Size",
+          "Number of messages queued without allocating (0 = disabled)", 0,
+          G_MAXINT, DEFAULT_QUEUE_SIZE,
+          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstBus::sync-message:
    * @bus: the object which received the signal
@@ -220,8 +273,8 @@ gst_bus_init (GstBus * bus)
 {
   bus->priv = G_TYPE_INSTANCE_GET_PRIVATE (bus, GST_TYPE_BUS, GstBusPrivate);
   bus->priv->enable_async = DEFAULT_ENABLE_ASYNC;
+  bus->priv->queue_size = DEFAULT_QUEUE_SIZE;
   g_mutex_init (&bus->priv->queue_lock);
-  bus->priv->queue = gst_atomic_queue_new (32);
 
   /* clear floating flag */
   gst_object_ref_sink (bus);
@@ -229,6 +282,54 @@ gst_bus_init (GstBus * bus)
   GST_DEBUG_OBJECT (bus, "created");
 }
 
+/* a full bounded queue spills to the overflow queue. Once messages are in
+ * the overflow queue, new messages go there as well until it is drained so
+ * that they are popped in the order they were posted. */
+static void
+bus_queue_push (GstBus * bus, GstMessage * message)
+{
+  GstBusPrivate *priv = bus->priv;
+
+  if (priv->overflow == NULL) {
+    gst_atomic_queue_push (priv->queue, message);
+    return;
+  }
+
+  if (G_LIKELY (gst_atomic_queue_length (priv->overflow) == 0 &&
+          gst_atomic_queue_try_push (priv->queue, message)))
+    return;
+
+  GST_DEBUG_OBJECT (bus, "[msg %p] queue full, using overflow queue", message);
+  gst_atomic_queue_push (priv->overflow, message);
+}
+
+/* should be called with the queue_lock */
+static GstMessage *
+bus_queue_pop (GstBus * bus)
+{
+  GstBusPrivate *priv = bus->priv;
+  GstMessage *message;
+
+  message = gst_atomic_queue_pop (priv->queue);
+  if (message == NULL && priv->overflow)
+    message = gst_atomic_queue_pop (priv->overflow);
+
+  return message;
+}
+
+static guint
+bus_queue_length (GstBus * bus)
+{
+  GstBusPrivate *priv = bus->priv;
+  guint len;
+
+  len = gst_atomic_queue_length (priv->queue);
+  if (priv->overflow)
+    len += gst_atomic_queue_length (priv->overflow);
+
+  return len;
+}
+
 static void
 gst_bus_dispose (GObject * object)
 {
@@ -239,12 +340,15 @@ gst_bus_dispose (GObject * object)
 
     g_mutex_lock (&bus->priv->queue_lock);
     do {
-      message = gst_atomic_queue_pop (bus->priv->queue);
+      message = bus_queue_pop (bus);
       if (message)
         gst_message_unref (message);
     } while (message != NULL);
     gst_atomic_queue_unref (bus->priv->queue);
     bus->priv->queue = NULL;
+    if (bus->priv->overflow)
+      gst_atomic_queue_unref (bus->priv->overflow);
+    bus->priv->overflow = NULL;
     g_mutex_unlock (&bus->priv->queue_lock);
     g_mutex_clear (&bus->priv->queue_lock);
 
@@ -345,7 +449,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
     case GST_BUS_PASS:
       /* pass the message to the async queue, refcount passed in the queue */
       GST_DEBUG_OBJECT (bus, "[msg %p] pushing on async queue", message);
-      gst_atomic_queue_push (bus->priv->queue, message);
+      bus_queue_push (bus, message);
       gst_poll_write_control (bus->priv->poll);
       GST_DEBUG_OBJECT (bus, "[msg %p] pushed on async queue", message);
 
@@ -367,7 +471,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
        * the cond will be signalled and we can continue */
       g_mutex_lock (lock);
 
-      gst_atomic_queue_push (bus->priv->queue, message);
+      bus_queue_push (bus, message);
       gst_poll_write_control (bus->priv->poll);
 
       /* now block till the message is freed */
@@ -417,7 +521,7 @@ gst_bus_have_pending (GstBus * bus)
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
 
   /* see if there is a message on the bus */
-  result = gst_atomic_queue_length (bus->priv->queue) != 0;
+  result = bus_queue_length (bus) != 0;
 
   return result;
 }
@@ -495,9 +599,9 @@ gst_bus_timed_pop_filtered (GstBus * bus, GstClockTime timeout,
     gint ret;
 
     GST_LOG_OBJECT (bus, "have %d messages",
-        gst_atomic_queue_length (bus->priv->queue));
+        bus_queue_length (bus));
 
-    while ((message = gst_atomic_queue_pop (bus->priv->queue))) {
+    while ((message = bus_queue_pop (bus))) {
       if (bus->priv->poll)
         gst_poll_read_control (bus->priv->poll);
 
@@ -648,6 +752,8 @@ gst_bus_peek (GstBus * bus)
 
   g_mutex_lock (&bus->priv->queue_lock);
   message = gst_atomic_queue_peek (bus->priv->queue);
+  if (message == NULL && bus->priv->overflow)
+    message = gst_atomic_queue_peek (bus->priv->overflow);
   if (message)
     gst_message_ref (message);
   g_mutex_unlock (&bus->priv->queue_lock);
@@ -82,9 +82,14 @@ typedef struct _GstCapsImpl
   GstCaps caps;
 
   GArray *array;
+
+  /* set when the caps are in the intern table, hash is valid then */
+  gboolean interned;
+  guint hash;
 } GstCapsImpl;
 
 #define GST_CAPS_ARRAY(c) (((GstCapsImpl *)(c))->array)
+#define GST_CAPS_INTERNED(c) (((GstCapsImpl *)(c))->interned)
 
 #define GST_CAPS_LEN(c)   (GST_CAPS_ARRAY(c)->len)
 
@@ -144,6 +149,235 @@ _priv_gst_caps_initialize (void)
       G_TYPE_STRING, gst_caps_transform_to_string);
 }
 
+/* result cache for intersect/can_intersect/is_subset.
+ *
+ * Entries are keyed on the identity of the two input caps and the operation.
+ * Only caps that are not writable (refcount > 1) are considered; the cache
+ * keeps a ref on the inputs so that they stay alive and read-only for as long
+ * as the entry exists, which makes the pointer a stable identity. The table
+ * is direct-mapped, a colliding store simply evicts the previous entry.
+ *
+ * The table is split in stripes with their own lock so that threads
+ * negotiating different caps don't contend on a single lock. Intersection
+ * results are stored as a private copy and every hit returns a new copy, so
+ * that callers always own a writable result. */
+#define CAPS_CACHE_SIZE 256
+#define CAPS_CACHE_STRIPES 16
+
+enum
+{
+  CAPS_CACHE_OP_CAN_INTERSECT = 0,
+  CAPS_CACHE_OP_IS_SUBSET,
+  CAPS_CACHE_OP_INTERSECT       /* + GstCapsIntersectMode */
+};
+
+typedef struct
+{
+  GstCaps *caps1;
+  GstCaps *caps2;
+  guint op;
+  gboolean res;
+  GstCaps *result;
+} GstCapsCacheEntry;
+
+typedef struct
+{
+  GMutex lock;
+  guint64 hits;
+  guint64 misses;
+} GstCapsCacheStripe;
+
+static GstCapsCacheStripe caps_cache_stripes[CAPS_CACHE_STRIPES];
+static GstCapsCacheEntry caps_cache[CAPS_CACHE_SIZE];
+static volatile gint caps_cache_enabled = 0;
+
+#define CAPS_CACHE_STRIPE(idx) \
+  (&caps_cache_stripes[(idx) & (CAPS_CACHE_STRIPES - 1)])
+
+#define CAPS_CACHE_USABLE(c1,c2) \
+  (g_atomic_int_get (&caps_cache_enabled) && (c1) != (c2) && \
+   !IS_WRITABLE (c1) && !IS_WRITABLE (c2))
+
+static inline guint
+caps_cache_index (const GstCaps * caps1, const GstCaps * caps2, guint op)
+{
+  guintptr h;
+
+  h = ((guintptr) caps1 >> 4) * 31 + ((guintptr) caps2 >> 4);
+  h = h * 7 + op;
+  h ^= h >> 8;
+
+  return h & (CAPS_CACHE_SIZE - 1);
+}
+
+static gboolean
+caps_cache_lookup (const GstCaps * caps1, const GstCaps * caps2, guint op,
+    gboolean * res, GstCaps ** result)
+{
+  GstCapsCacheStripe *stripe;
+  GstCapsCacheEntry *entry;
+  GstCaps *cached = NULL;
+  gboolean found;
+  guint idx;
+
+  idx = caps_cache_index (caps1, caps2, op);
+  entry = &caps_cache[idx];
+  stripe = CAPS_CACHE_STRIPE (idx);
+
+  g_mutex_lock (&stripe->lock);
+  found = (entry->caps1 == caps1 && entry->caps2 == caps2 && entry->op == op);
+  if (found) {
+    if (res)
+      *res = entry->res;
+    if (result)
+      cached = gst_caps_ref (entry->result);
+    stripe->hits++;
+  } else {
+    stripe->misses++;
+  }
+  g_mutex_unlock (&stripe->lock);
+
+  /* copy outside of the lock, the cached caps are never modified */
+  if (cached) {
+    *result = gst_caps_copy (cached);
+    gst_caps_unref (cached);
+  }
+
+  return found;
+}
+
+static void
+caps_cache_store (const GstCaps * caps1, const GstCaps * caps2, guint op,
+    gboolean res, GstCaps * result)
+{
+  GstCapsCacheStripe *stripe;
+  GstCapsCacheEntry *entry, old;
+  GstCaps *copy;
+  guint idx;
+
+  idx = caps_cache_index (caps1, caps2, op);
+  entry = &caps_cache[idx];
+  stripe = CAPS_CACHE_STRIPE (idx);
+
+  /* keep our own copy, @result is owned by the caller who can modify it */
+  copy = result ? gst_caps_copy (result) : NULL;
+
+  g_mutex_lock (&stripe->lock);
+  old = *entry;
+  entry->caps1 = gst_caps_ref ((GstCaps *) caps1);
+  entry->caps2 = gst_caps_ref ((GstCaps *) caps2);
+  entry->op = op;
+  entry->res = res;
+  entry->result = copy;
+  g_mutex_unlock (&stripe->lock);
+
+  /* release the evicted entry outside of the lock */
+  if (old.caps1)
+    gst_caps_unref (old.caps1);
+  if (old.caps2)
+    gst_caps_unref (old.caps2);
+  if (old.result)
+    gst_caps_unref (old.result);
+}
+
+/**
+ * gst_caps_cache_clear:
+ *
+ * Removes all entries from the caps operation cache and releases the caps
+ * that were kept alive by it. The hit and miss counters are reset.
+ *
+ * Since: 1.2
+ */
+void
+gst_caps_cache_clear (void)
+{
+  GstCapsCacheEntry *old;
+  guint i, j;
+
+  old = g_new (GstCapsCacheEntry, CAPS_CACHE_SIZE);
+
+  for (i = 0; i < CAPS_CACHE_STRIPES; i++) {
+    GstCapsCacheStripe *stripe = &caps_cache_stripes[i];
+
+    g_mutex_lock (&stripe->lock);
+    for (j = i; j < CAPS_CACHE_SIZE; j += CAPS_CACHE_STRIPES) {
+      old[j] = caps_cache[j];
+      memset (&caps_cache[j], 0, sizeof (GstCapsCacheEntry));
+    }
+    stripe->hits = stripe->misses = 0;
+    g_mutex_unlock (&stripe->lock);
+  }
+
+  for (i = 0; i < CAPS_CACHE_SIZE; i++) {
+    if (old[i].caps1)
+      gst_caps_unref (old[i].caps1);
+    if (old[i].caps2)
+      gst_caps_unref (old[i].caps2);
+    if (old[i].result)
+      gst_caps_unref (old[i].result);
+  }
+  g_free (old);
+}
+
+/**
+ * gst_caps_cache_set_enabled:
+ * @enabled: whether to enable the cache
+ *
+ * Enables or disables the caps operation cache. When enabled, the results
+ * of gst_caps_intersect_full(), gst_caps_can_intersect() and
+ * gst_caps_is_subset() on caps that are not writable are remembered in a
+ * small bounded table and returned directly for subsequent calls with the
+ * same caps.
+ *
+ * The cache keeps a reference to the caps it stores, they will therefore
+ * not become writable again until they are evicted or the cache is cleared.
+ * Intersection results returned from the cache are a new copy of the
+ * cached caps that is owned by the caller, like a computed result.
+ * The cache is disabled by default, disabling it clears all entries.
+ *
+ * Since: 1.2
+ */
+void
+gst_caps_cache_set_enabled (gboolean enabled)
+{
+  g_atomic_int_set (&caps_cache_enabled, ! !enabled);
+
+  if (!enabled)
+    gst_caps_cache_clear ();
+}
+
+/**
+ * gst_caps_cache_get_stats:
+ * @hits: (out) (allow-none): location for the number of cache hits
+ * @misses: (out) (allow-none): location for the number of cache misses
+ *
+ * Gets the number of lookups in the caps operation cache that could be
+ * satisfied from the cache and the number of lookups that had to compute
+ * the result.
+ *
+ * Since: 1.2
+ */
+void
+gst_caps_cache_get_stats (guint64 * hits, guint64 * misses)
+{
+  guint64 h = 0, m = 0;
+  guint i;
+
+  for (i = 0; i < CAPS_CACHE_STRIPES; i++) {
+    GstCapsCacheStripe *stripe = &caps_cache_stripes[i];
+
+    g_mutex_lock (&stripe->lock);
+    h += stripe->hits;
+    m += stripe->misses;
+    g_mutex_unlock (&stripe->lock);
+  }
+
+  if (hits)
+    *hits = h;
+  if (misses)
+    *misses = m;
+}
+
 static GstCaps *
 _gst_caps_copy (const GstCaps * caps)
 {
@@ -216,6 +450,7 @@ gst_caps_init (GstCaps * caps)
    */
   GST_CAPS_ARRAY (caps) =
       g_array_new (FALSE, TRUE, sizeof (GstCapsArrayElement));
+  GST_CAPS_INTERNED (caps) = FALSE;
 }
 
 /**
@@ -405,7 +640,8 @@ gst_static_caps_get (GstStaticCaps * static_caps)
     if (G_UNLIKELY (string == NULL))
       goto no_string;
 
-    *caps = gst_caps_from_string (string);
+    /* static caps with the same string share the same caps */
+    *caps = gst_caps_from_string_cached (string);
 
     /* convert to string */
     if (G_UNLIKELY (*caps == NULL))
@@ -1172,7 +1408,7 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
 {
   GstStructure *s1, *s2;
   GstCapsFeatures *f1, *f2;
-  gboolean ret = TRUE;
+  gboolean ret = TRUE, use_cache = FALSE;
   gint i, j;
 
   g_return_val_if_fail (subset != NULL, FALSE);
@@ -1183,6 +1419,13 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  if (CAPS_CACHE_USABLE (subset, superset)) {
+    if (caps_cache_lookup (subset, superset, CAPS_CACHE_OP_IS_SUBSET, &ret,
+            NULL))
+      return ret;
+    use_cache = TRUE;
+  }
+
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
       s1 = gst_caps_get_structure_unchecked (subset, i);
@@ -1209,6 +1452,9 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
     }
   }
 
+  if (use_cache)
+    caps_cache_store (subset, superset, CAPS_CACHE_OP_IS_SUBSET, ret, NULL);
+
   return ret;
 }
 
@@ -1314,8 +1560,12 @@ gst_caps_is_equal (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (caps1 == caps2))
     return TRUE;
 
-  if (G_UNLIKELY (gst_caps_is_fixed (caps1) && gst_caps_is_fixed (caps2)))
+  if (G_UNLIKELY (gst_caps_is_fixed (caps1) && gst_caps_is_fixed (caps2))) {
+    /* there is only one interned instance of each fixed caps */
+    if (GST_CAPS_INTERNED (caps1) && GST_CAPS_INTERNED (caps2))
+      return FALSE;
     return gst_caps_is_equal_fixed (caps1, caps2);
+  }
 
   return gst_caps_is_subset (caps1, caps2) && gst_caps_is_subset (caps2, caps1);
 }
@@ -1342,6 +1592,12 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (caps1 == caps2))
     return TRUE;
 
+  if (GST_CAPS_INTERNED (caps1) && GST_CAPS_INTERNED (caps2))
+    return FALSE;
+
+  if (CAPS_IS_ANY (caps1) != CAPS_IS_ANY (caps2))
+    return FALSE;
+
   if (GST_CAPS_LEN (caps1) != GST_CAPS_LEN (caps2))
     return FALSE;
 
@@ -1364,20 +1620,153 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
   return TRUE;
 }
 
-/* intersect operation */
+static guint
+gst_caps_features_hash (const GstCapsFeatures * features)
+{
+  guint i, n, h = 0;
+
+  if (!features)
+    features = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+  if (gst_caps_features_is_any (features))
+    return 1;
+
+  /* features are compared as sets, and no features are equal to
+   * system memory, so they hash the same */
+  n = gst_caps_features_get_size (features);
+  if (n == 0)
+    return g_str_hash (GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY) * 31 + 1;
+  for (i = 0; i < n; i++)
+    h += g_str_hash (gst_caps_features_get_nth (features, i));
+
+  return h * 31 + n;
+}
 
 /**
- * gst_caps_can_intersect:
- * @caps1: a #GstCaps to intersect
- * @caps2: a #GstCaps to intersect
+ * gst_caps_hash:
+ * @caps: a #GstCaps
  *
- * Tries intersecting @caps1 and @caps2 and reports whether the result would not
- * be empty
+ * Calculates a hash value for @caps from its structures and their
+ * #GstCapsFeatures. Caps for which gst_caps_is_strictly_equal() returns
+ * %TRUE have the same hash. See also gst_structure_hash().
  *
- * Returns: %TRUE if intersection would be not empty
+ * Returns: the hash of @caps
+ *
+ * Since: 1.2
  */
-gboolean
-gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+guint
+gst_caps_hash (const GstCaps * caps)
+{
+  guint i, n, h;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), 0);
+
+  if (GST_CAPS_INTERNED (caps))
+    return ((GstCapsImpl *) caps)->hash;
+
+  if (CAPS_IS_ANY (caps))
+    return 1;
+
+  n = GST_CAPS_LEN (caps);
+  h = n;
+  for (i = 0; i < n; i++) {
+    h = h * 31 + gst_structure_hash (gst_caps_get_structure_unchecked (caps,
+            i));
+    h = h * 31 +
+        gst_caps_features_hash (gst_caps_get_features_unchecked (caps, i));
+  }
+
+  return h;
+}
+
+/* table of interned caps. The table owns a ref to each caps so that they
+ * can never become writable again; entries only referenced by the table
+ * are dropped when the table has grown too much. */
+G_LOCK_DEFINE_STATIC (caps_intern_lock);
+static GHashTable *caps_intern_table;
+static guint caps_intern_prune_size = 64;
+
+static gboolean
+caps_intern_is_unused (gpointer key, gpointer value, gpointer user_data)
+{
+  GstCaps *caps = key;
+
+  if (GST_CAPS_REFCOUNT_VALUE (caps) > 1)
+    return FALSE;
+
+  GST_CAPS_INTERNED (caps) = FALSE;
+  return TRUE;
+}
+
+static void
+caps_intern_release (GstCaps * caps, gpointer value, gpointer user_data)
+{
+  GST_CAPS_INTERNED (caps) = FALSE;
+}
+
+/**
+ * gst_caps_intern:
+ * @caps: (transfer full): a #GstCaps
+ *
+ * Returns the shared instance of caps that are strictly equal to @caps. The
+ * first time this is called for a given set of caps, @caps itself becomes the
+ * shared instance, later calls with equal caps unref the passed caps and
+ * return the shared instance instead.
+ *
+ * Interned caps are never writable and can be compared by pointer: two
+ * interned caps are strictly equal if and only if they are the same
+ * instance. This makes them suitable as keys for hash based caches. Use
+ * gst_caps_make_writable() to get caps that can be modified.
+ *
+ * Returns: (transfer full): the interned #GstCaps
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_intern (GstCaps * caps)
+{
+  GstCaps *interned;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+
+  if (GST_CAPS_INTERNED (caps))
+    return caps;
+
+  G_LOCK (caps_intern_lock);
+  if (G_UNLIKELY (caps_intern_table == NULL))
+    caps_intern_table = g_hash_table_new_full ((GHashFunc) gst_caps_hash,
+        (GEqualFunc) gst_caps_is_strictly_equal,
+        (GDestroyNotify) gst_caps_unref, NULL);
+
+  interned = g_hash_table_lookup (caps_intern_table, caps);
+  if (interned) {
+    gst_caps_ref (interned);
+  } else {
+    ((GstCapsImpl *) caps)->hash = gst_caps_hash (caps);
+    GST_CAPS_INTERNED (caps) = TRUE;
+    g_hash_table_add (caps_intern_table, gst_caps_ref (caps));
+
+    if (g_hash_table_size (caps_intern_table) >= caps_intern_prune_size) {
+      g_hash_table_foreach_remove (caps_intern_table, caps_intern_is_unused,
+          NULL);
+      caps_intern_prune_size =
+          MAX (64, 2 * g_hash_table_size (caps_intern_table));
+    }
+  }
+  G_UNLOCK (caps_intern_lock);
+
+  if (interned) {
+    gst_caps_unref (caps);
+    return interned;
+  }
+  return caps;
+}
+
+/* intersect operation */
+
+/* caps1 and caps2 are neither the same, empty nor any */
+static gboolean
+gst_caps_can_intersect_uncached (const GstCaps * caps1, const GstCaps * caps2)
 {
   guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
   guint j, k, len1, len2;
@@ -1386,21 +1775,6 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   GstCapsFeatures *features1;
   GstCapsFeatures *features2;
 
-  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
-  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
-
-  /* caps are exactly the same pointers */
-  if (G_UNLIKELY (caps1 == caps2))
-    return TRUE;
-
-  /* empty caps on either side, return empty */
-  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
-    return FALSE;
-
-  /* one of the caps is any */
-  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
-    return TRUE;
-
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1452,6 +1826,49 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   return FALSE;
 }
 
+/**
+ * gst_caps_can_intersect:
+ * @caps1: a #GstCaps to intersect
+ * @caps2: a #GstCaps to intersect
+ *
+ * Tries intersecting @caps1 and @caps2 and reports whether the result would not
+ * be empty
+ *
+ * Returns: %TRUE if intersection would be not empty
+ */
+gboolean
+gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+{
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
+  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
+
+  /* caps are exactly the same pointers */
+  if (G_UNLIKELY (caps1 == caps2))
+    return TRUE;
+
+  /* empty caps on either side, return empty */
+  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
+    return FALSE;
+
+  /* one of the caps is any */
+  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
+    return TRUE;
+
+  if (!CAPS_CACHE_USABLE (caps1, caps2))
+    return gst_caps_can_intersect_uncached (caps1, caps2);
+
+  if (caps_cache_lookup (caps1, caps2, CAPS_CACHE_OP_CAN_INTERSECT, &res,
+          NULL))
+    return res;
+
+  res = gst_caps_can_intersect_uncached (caps1, caps2);
+  caps_cache_store (caps1, caps2, CAPS_CACHE_OP_CAN_INTERSECT, res, NULL);
+
+  return res;
+}
+
 static GstCaps *
 gst_caps_intersect_zig_zag (GstCaps * caps1, GstCaps * caps2)
 {
@@ -1626,18 +2043,37 @@ GstCaps *
 gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
     GstCapsIntersectMode mode)
 {
+  GstCaps *res;
+  gboolean use_cache = FALSE;
+
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
+  if (CAPS_CACHE_USABLE (caps1, caps2) && !CAPS_IS_ANY (caps1)
+      && !CAPS_IS_ANY (caps2)) {
+    if (caps_cache_lookup (caps1, caps2, CAPS_CACHE_OP_INTERSECT + mode, NULL,
+            &res))
+      return res;
+    use_cache = TRUE;
+  }
+
   switch (mode) {
     case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
+      res = gst_caps_intersect_first (caps1, caps2);
+      break;
     default:
       g_warning ("Unknown caps intersect mode: %d", mode);
       /* fallthrough */
     case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+      res = gst_caps_intersect_zig_zag (caps1, caps2);
+      break;
   }
+
+  if (use_cache)
+    caps_cache_store (caps1, caps2, CAPS_CACHE_OP_INTERSECT + mode, FALSE,
+        res);
+
+  return res;
 }
 
 /**
@@ -1853,6 +2289,34 @@ gst_caps_normalize_foreach (GQuark field_id, const GValue * value, gpointer ptr)
   return TRUE;
 }
 
+static gboolean
+gst_caps_count_combinations_foreach (GQuark field_id, const GValue * value,
+    gpointer ptr)
+{
+  guint64 *n = ptr;
+
+  if (G_VALUE_TYPE (value) == GST_TYPE_LIST) {
+    *n *= MAX (1, gst_value_list_get_size (value));
+    /* saturate, anything this big is over any sensible budget */
+    if (*n > G_MAXUINT) {
+      *n = G_MAXUINT;
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* number of structures that normalizing @structure results in */
+static guint
+gst_caps_structure_n_combinations (const GstStructure * structure)
+{
+  guint64 n = 1;
+
+  gst_structure_foreach (structure, gst_caps_count_combinations_foreach, &n);
+
+  return n;
+}
+
 /**
  * gst_caps_normalize:
  * @caps: (transfer full): a #GstCaps to normalize
@@ -1867,18 +2331,58 @@ gst_caps_normalize_foreach (GQuark field_id, const GValue * value, gpointer ptr)
  */
 GstCaps *
 gst_caps_normalize (GstCaps * caps)
+{
+  return gst_caps_normalize_full (caps, 0);
+}
+
+/**
+ * gst_caps_normalize_full:
+ * @caps: (transfer full): a #GstCaps to normalize
+ * @max_size: the maximum number of structures in the result, or 0 for no
+ *     limit
+ *
+ * Like gst_caps_normalize(), but bounds the cost. Normalizing caps with
+ * several lists creates a structure for every combination of their values,
+ * which can be very many. Structures that would make the result grow
+ * beyond @max_size structures are not expanded and keep their lists, so
+ * the result always represents the same set of formats as @caps.
+ *
+ * This function takes ownership of @caps.
+ *
+ * Returns: (transfer full): the normalized #GstCaps
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_normalize_full (GstCaps * caps, guint max_size)
 {
   NormalizeForeach nf;
-  guint i;
+  guint i, len, size, n;
 
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
 
   caps = gst_caps_make_writable (caps);
   nf.caps = caps;
 
-  for (i = 0; i < gst_caps_get_size (nf.caps); i++) {
+  /* structures appended while expanding one of the original structures are
+   * always expanded, the budget is only checked for the original ones */
+  len = size = GST_CAPS_LEN (caps);
+
+  for (i = 0; i < GST_CAPS_LEN (nf.caps); i++) {
     nf.structure = gst_caps_get_structure_unchecked (nf.caps, i);
     nf.features = gst_caps_get_features_unchecked (nf.caps, i);
+
+    if (max_size > 0 && i < len) {
+      n = gst_caps_structure_n_combinations (nf.structure);
+      if (n > 1 && (guint64) size + n - 1 > max_size) {
+        GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, caps, "not expanding "
+            "structure %u into %u structures, budget of %u exceeded", i, n,
+            max_size);
+        continue;
+      }
+      size += n - 1;
+    }
+
     while (!gst_structure_foreach (nf.structure,
             gst_caps_normalize_foreach, &nf));
   }
@@ -1892,6 +2396,10 @@ gst_caps_compare_structures (gconstpointer one, gconstpointer two)
   gint ret;
   const GstStructure *struct1 = ((const GstCapsArrayElement *) one)->structure;
   const GstStructure *struct2 = ((const GstCapsArrayElement *) two)->structure;
+  const GstCapsFeatures *features1 =
+      ((const GstCapsArrayElement *) one)->features;
+  const GstCapsFeatures *features2 =
+      ((const GstCapsArrayElement *) two)->features;
 
   /* FIXME: this orders alphabetically, but ordering the quarks might be faster
      So what's the best way? */
@@ -1901,6 +2409,17 @@ gst_caps_compare_structures (gconstpointer one, gconstpointer two)
   if (ret)
     return ret;
 
+  /* keep structures with the same features together so that simplify only
+   * has to compare structures within the same group. The order between the
+   * groups does not matter, the hash is cheap and equal for equal features */
+  if (features1 != features2) {
+    guint h1 = gst_caps_features_hash (features1);
+    guint h2 = gst_caps_features_hash (features2);
+
+    if (h1 != h2)
+      return h1 < h2 ? -1 : 1;
+  }
+
   return gst_structure_n_fields (struct2) - gst_structure_n_fields (struct1);
 }
 
@@ -2024,9 +2543,35 @@ gst_caps_switch_structures (GstCaps * caps, GstStructure * old,
  */
 GstCaps *
 gst_caps_simplify (GstCaps * caps)
+{
+  return gst_caps_simplify_full (caps, 0);
+}
+
+/**
+ * gst_caps_simplify_full:
+ * @caps: (transfer full): a #GstCaps to simplify
+ * @max_comparisons: the maximum number of structure pairs to compare, or 0
+ *     for no limit
+ *
+ * Like gst_caps_simplify(), but bounds the cost. Simplifying compares every
+ * structure with the other structures with the same name and features,
+ * which is quadratic in the number of structures. When @max_comparisons
+ * pairs have been compared, the caps are returned as they are at that
+ * point. They represent the same set of formats, but may not be as simple
+ * as they could be.
+ *
+ * This method does not preserve the original order of @caps.
+ *
+ * Returns: The simplified caps.
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_simplify_full (GstCaps * caps, guint max_comparisons)
 {
   GstStructure *simplify, *compare, *result = NULL;
   GstCapsFeatures *simplify_f, *compare_f;
+  guint comparisons = 0;
   gint i, j, start;
 
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
@@ -2065,6 +2610,11 @@ gst_caps_simplify (GstCaps * caps)
           !gst_caps_features_is_equal (simplify_f, compare_f)) {
         break;
       }
+      if (max_comparisons > 0 && comparisons++ == max_comparisons) {
+        GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, caps,
+            "budget of %u comparisons exceeded", max_comparisons);
+        return caps;
+      }
       if (gst_caps_structure_simplify (&result, simplify, compare)) {
         if (result) {
           gst_caps_switch_structures (caps, simplify, result, i);
@@ -2292,6 +2842,133 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
   return TRUE;
 }
 
+/**
+ * gst_caps_to_binary:
+ * @caps: a #GstCaps
+ * @size: (out): location for the size of the returned data
+ *
+ * Serializes @caps into a compact binary form that is much faster to create
+ * and parse than the string form. See gst_value_to_binary() for details.
+ * Use gst_caps_from_binary() to turn the data back into caps.
+ *
+ * Returns: (transfer full) (array length=size): the serialized data, free
+ *     with g_free(), or %NULL if the caps could not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_caps_to_binary (const GstCaps * caps, gsize * size)
+{
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  return _priv_gst_binary_serialize (GST_BINARY_KIND_CAPS, caps, size);
+}
+
+/**
+ * gst_caps_from_binary:
+ * @data: (array length=size): data created with gst_caps_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes caps created with gst_caps_to_binary().
+ *
+ * Returns: (transfer full): a new #GstCaps or %NULL when the data could not
+ *     be parsed.
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_from_binary (const guint8 * data, gsize size)
+{
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  return _priv_gst_binary_deserialize (GST_BINARY_KIND_CAPS, data, size, NULL);
+}
+
+/* caps parsed with gst_caps_from_string_cached(). The table owns a ref to
+ * the caps so they are never writable. When the table is full, entries that
+ * were not looked up since the last eviction and are only referenced by the
+ * table are dropped, the others get a second chance. Caps handed out stay
+ * valid because the callers hold their own ref. */
+#define CAPS_STRING_CACHE_SIZE 1024
+G_LOCK_DEFINE_STATIC (caps_string_lock);
+static GHashTable *caps_string_table;
+
+typedef struct
+{
+  GstCaps *caps;
+  gboolean referenced;
+} CapsStringEntry;
+
+static void
+caps_string_entry_free (CapsStringEntry * entry)
+{
+  gst_caps_unref (entry->caps);
+  g_slice_free (CapsStringEntry, entry);
+}
+
+static gboolean
+caps_string_entry_is_unused (gpointer key, gpointer value, gpointer user_data)
+{
+  CapsStringEntry *entry = value;
+
+  if (entry->referenced) {
+    entry->referenced = FALSE;
+    return FALSE;
+  }
+  return GST_CAPS_REFCOUNT_VALUE (entry->caps) == 1;
+}
+
+static gboolean
+caps_string_entry_evict (gpointer key, gpointer value, gpointer user_data)
+{
+  guint *n_evict = user_data;
+
+  if (*n_evict == 0)
+    return FALSE;
+  (*n_evict)--;
+  return TRUE;
+}
+
+/* make room for a new entry, with caps_string_lock */
+static void
+caps_string_table_evict (void)
+{
+  guint size;
+
+  g_hash_table_foreach_remove (caps_string_table, caps_string_entry_is_unused,
+      NULL);
+
+  /* everything is in use, drop a quarter of the entries anyway to bound the
+   * size of the table */
+  size = g_hash_table_size (caps_string_table);
+  if (size >= CAPS_STRING_CACHE_SIZE) {
+    guint n_evict = size - CAPS_STRING_CACHE_SIZE * 3 / 4;
+
+    g_hash_table_foreach_remove (caps_string_table, caps_string_entry_evict,
+        &n_evict);
+  }
+}
+
+static GstCaps *
+caps_string_lookup (const gchar * string)
+{
+  CapsStringEntry *entry;
+  GstCaps *caps = NULL;
+
+  G_LOCK (caps_string_lock);
+  if (caps_string_table) {
+    entry = g_hash_table_lookup (caps_string_table, string);
+    if (entry) {
+      entry->referenced = TRUE;
+      caps = gst_caps_ref (entry->caps);
+    }
+  }
+  G_UNLOCK (caps_string_lock);
+
+  return caps;
+}
+
 /**
  * gst_caps_from_string:
  * @string: a string to convert to #GstCaps
@@ -2307,6 +2984,14 @@ gst_caps_from_string (const gchar * string)
 
   g_return_val_if_fail (string, FALSE);
 
+  /* copying caps that were parsed before is much cheaper than parsing */
+  if ((caps = caps_string_lookup (string))) {
+    GstCaps *copy = _gst_caps_copy (caps);
+
+    gst_caps_unref (caps);
+    return copy;
+  }
+
   caps = gst_caps_new_empty ();
   if (gst_caps_from_string_inplace (caps, string)) {
     return caps;
@@ -2316,6 +3001,88 @@ gst_caps_from_string (const gchar * string)
   }
 }
 
+/**
+ * gst_caps_from_string_cached:
+ * @string: a string to convert to #GstCaps
+ *
+ * Converts @caps from a string representation, like gst_caps_from_string(),
+ * but keeps the result in a global cache. Converting the same string again
+ * returns a new reference to the same caps instead of parsing it again.
+ *
+ * The returned caps are shared and thus not writable. Use this for caps
+ * that are only used for negotiation, such as pad template or filter caps.
+ *
+ * Returns: (transfer full): a shared #GstCaps or %NULL when @string could
+ *     not be parsed.
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_from_string_cached (const gchar * string)
+{
+  GstCaps *caps, *other = NULL;
+  CapsStringEntry *entry;
+
+  g_return_val_if_fail (string, NULL);
+
+  if ((caps = caps_string_lookup (string)))
+    return caps;
+
+  caps = gst_caps_new_empty ();
+  if (!gst_caps_from_string_inplace (caps, string)) {
+    gst_caps_unref (caps);
+    return NULL;
+  }
+
+  G_LOCK (caps_string_lock);
+  if (G_UNLIKELY (caps_string_table == NULL))
+    caps_string_table = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, (GDestroyNotify) caps_string_entry_free);
+
+  /* another thread might have parsed the same string meanwhile */
+  if ((entry = g_hash_table_lookup (caps_string_table, string))) {
+    entry->referenced = TRUE;
+    other = gst_caps_ref (entry->caps);
+  } else {
+    if (g_hash_table_size (caps_string_table) >= CAPS_STRING_CACHE_SIZE)
+      caps_string_table_evict ();
+    entry = g_slice_new (CapsStringEntry);
+    entry->caps = gst_caps_ref (caps);
+    entry->referenced = FALSE;
+    g_hash_table_insert (caps_string_table, g_strdup (string), entry);
+  }
+  G_UNLOCK (caps_string_lock);
+
+  if (other) {
+    gst_caps_unref (caps);
+    return other;
+  }
+  return caps;
+}
+
+void
+_priv_gst_caps_cleanup (void)
+{
+  gst_caps_cache_set_enabled (FALSE);
+
+  G_LOCK (caps_string_lock);
+  if (caps_string_table) {
+    g_hash_table_unref (caps_string_table);
+    caps_string_table = NULL;
+  }
+  G_UNLOCK (caps_string_lock);
+
+  G_LOCK (caps_intern_lock);
+  if (caps_intern_table) {
+    g_hash_table_foreach (caps_intern_table, (GHFunc) caps_intern_release,
+        NULL);
+    g_hash_table_unref (caps_intern_table);
+    caps_intern_table = NULL;
+  }
+  G_UNLOCK (caps_intern_lock);
+}
+
+
 static void
 gst_caps_transform_to_string (const GValue * src_value, GValue * dest_value)
 {
@@ -438,6 +438,7 @@ gboolean          gst_caps_can_intersect           (const GstCaps * caps1,
 						    const GstCaps * caps2);
 gboolean          gst_caps_is_strictly_equal	   (const GstCaps *caps1,
 						    const GstCaps *caps2);
+guint             gst_caps_hash                    (const GstCaps *caps);
 
 
 /* operations */
@@ -449,13 +450,30 @@ GstCaps *         gst_caps_intersect_full          (GstCaps *caps1,
 GstCaps *         gst_caps_subtract		   (GstCaps *minuend,
 						    GstCaps *subtrahend) G_GNUC_WARN_UNUSED_RESULT;
 GstCaps *         gst_caps_normalize               (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
+GstCaps *         gst_caps_normalize_full          (GstCaps *caps,
+                                                    guint    max_size) G_GNUC_WARN_UNUSED_RESULT;
 GstCaps *         gst_caps_simplify                (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
+GstCaps *         gst_caps_simplify_full           (GstCaps *caps,
+                                                    guint    max_comparisons) G_GNUC_WARN_UNUSED_RESULT;
 
 GstCaps *         gst_caps_fixate                  (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
 
+GstCaps *         gst_caps_intern                  (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
+
+/* operation cache */
+void              gst_caps_cache_set_enabled       (gboolean enabled);
+void              gst_caps_cache_clear             (void);
+void              gst_caps_cache_get_stats         (guint64 *hits,
+                                                    guint64 *misses);
+
 /* utility */
 gchar *           gst_caps_to_string               (const GstCaps *caps) G_GNUC_MALLOC;
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
+GstCaps *         gst_caps_from_string_cached      (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
+guint8 *          gst_caps_to_binary               (const GstCaps *caps,
+                                                    gsize         *size) G_GNUC_MALLOC;
+GstCaps *         gst_caps_from_binary             (const guint8  *data,
+                                                    gsize          size) G_GNUC_WARN_UNUSED_RESULT;
 
 G_END_DECLS
 
@@ -63,8 +63,26 @@ struct _GstCapsFeatures
   gint *parent_refcount;
   GArray *array;
   gboolean is_any;
+  /* one bit per feature in array, see gst_caps_feature_get_bit() */
+  guint64 bits;
 };
 
+/* Every feature name gets its own bit the first time it is used, so that
+ * sets of features can be compared with a single integer comparison.
+ * System memory always uses the first bit. Features that are used after all
+ * bits have been given out set the overflow bit, sets containing those are
+ * compared element by element. */
+#define FEATURE_BIT_SYSMEM   (G_GUINT64_CONSTANT (1) << 0)
+#define FEATURE_BIT_OVERFLOW (G_GUINT64_CONSTANT (1) << 63)
+#define FEATURE_BIT_MAX      63
+
+/* an empty set means system memory */
+#define FEATURE_BITS(f) ((f)->bits ? (f)->bits : FEATURE_BIT_SYSMEM)
+
+G_LOCK_DEFINE_STATIC (feature_bits_lock);
+static GHashTable *feature_bits;
+static guint n_feature_bits = 1;
+
 GType _gst_caps_features_type = 0;
 GstCapsFeatures *_gst_caps_features_any = NULL;
 GstCapsFeatures *_gst_caps_features_memory_system_memory = NULL;
@@ -90,6 +108,7 @@ _priv_gst_caps_features_initialize (void)
   _gst_caps_features_type = gst_caps_features_get_type ();
   _gst_caps_feature_memory_system_memory =
       g_quark_from_static_string (GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY);
+  feature_bits = g_hash_table_new (NULL, NULL);
 
   g_value_register_transform_func (_gst_caps_features_type, G_TYPE_STRING,
       gst_caps_features_transform_to_string);
@@ -99,6 +118,44 @@ _priv_gst_caps_features_initialize (void)
       gst_caps_features_new_id (_gst_caps_feature_memory_system_memory, 0);
 }
 
+static guint64
+gst_caps_feature_get_bit (GQuark feature)
+{
+  guint bit;
+
+  if (feature == _gst_caps_feature_memory_system_memory)
+    return FEATURE_BIT_SYSMEM;
+
+  G_LOCK (feature_bits_lock);
+  bit = GPOINTER_TO_UINT (g_hash_table_lookup (feature_bits,
+          GUINT_TO_POINTER (feature)));
+  if (bit == 0 && n_feature_bits < FEATURE_BIT_MAX) {
+    bit = n_feature_bits++;
+    g_hash_table_insert (feature_bits, GUINT_TO_POINTER (feature),
+        GUINT_TO_POINTER (bit));
+  }
+  G_UNLOCK (feature_bits_lock);
+
+  if (G_UNLIKELY (bit == 0)) {
+    GST_DEBUG ("no bit left for feature %s", g_quark_to_string (feature));
+    return FEATURE_BIT_OVERFLOW;
+  }
+
+  return G_GUINT64_CONSTANT (1) << bit;
+}
+
+static void
+gst_caps_features_update_bits (GstCapsFeatures * features)
+{
+  guint i, n;
+
+  features->bits = 0;
+  n = features->array->len;
+  for (i = 0; i < n; i++)
+    features->bits |=
+        gst_caps_feature_get_bit (g_array_index (features->array, GQuark, i));
+}
+
 gboolean
 gst_is_caps_features (gconstpointer obj)
 {
@@ -161,6 +218,7 @@ gst_caps_features_new_empty (void)
   features->parent_refcount = NULL;
   features->array = g_array_new (FALSE, FALSE, sizeof (GQuark));
   features->is_any = FALSE;
+  features->bits = 0;
 
   GST_TRACE ("created caps features %p", features);
 
@@ -364,15 +422,15 @@ GstCapsFeatures *
 gst_caps_features_copy (const GstCapsFeatures * features)
 {
   GstCapsFeatures *copy;
-  guint i, n;
 
   g_return_val_if_fail (features != NULL, NULL);
 
+  /* the features were validated when they were added */
   copy = gst_caps_features_new_empty ();
-  n = gst_caps_features_get_size (features);
-  for (i = 0; i < n; i++)
-    gst_caps_features_add_id (copy, gst_caps_features_get_nth_id (features, i));
+  g_array_append_vals (copy->array, features->array->data,
+      features->array->len);
   copy->is_any = features->is_any;
+  copy->bits = features->bits;
 
   return copy;
 }
@@ -661,9 +719,10 @@ gst_caps_features_contains_id (const GstCapsFeatures * features, GQuark feature)
   if (features->is_any)
     return TRUE;
 
+  if (feature == _gst_caps_feature_memory_system_memory)
+    return (FEATURE_BITS (features) & FEATURE_BIT_SYSMEM) != 0;
+
   n = features->array->len;
-  if (n == 0)
-    return feature == _gst_caps_feature_memory_system_memory;
 
   for (i = 0; i < n; i++) {
     if (gst_caps_features_get_nth_id (features, i) == feature)
@@ -688,6 +747,7 @@ gboolean
 gst_caps_features_is_equal (const GstCapsFeatures * features1,
     const GstCapsFeatures * features2)
 {
+  guint64 bits1, bits2;
   guint i, n;
 
   g_return_val_if_fail (features1 != NULL, FALSE);
@@ -696,6 +756,15 @@ gst_caps_features_is_equal (const GstCapsFeatures * features1,
   if (features1->is_any || features2->is_any)
     return TRUE;
 
+  /* equal sets always have the same bits, different bits are only possible
+   * for equal sets when some features did not get a bit */
+  bits1 = FEATURE_BITS (features1);
+  bits2 = FEATURE_BITS (features2);
+  if (G_LIKELY (((bits1 | bits2) & FEATURE_BIT_OVERFLOW) == 0))
+    return bits1 == bits2;
+  if (bits1 != bits2)
+    return FALSE;
+
   /* Check for the sysmem==empty case */
   if (features1->array->len == 0 && features2->array->len == 0)
     return TRUE;
@@ -789,6 +858,7 @@ gst_caps_features_add_id (GstCapsFeatures * features, GQuark feature)
     return;
 
   g_array_append_val (features->array, feature);
+  features->bits |= gst_caps_feature_get_bit (feature);
 }
 
 /**
@@ -834,6 +904,7 @@ gst_caps_features_remove_id (GstCapsFeatures * features, GQuark feature)
 
     if (quark == feature) {
       g_array_remove_index_fast (features->array, i);
+      gst_caps_features_update_bits (features);
       return;
     }
   }
@@ -55,6 +55,16 @@
 static GHashTable *metainfo = NULL;
 static GRWLock lock;
 
+/* every registered API gets a small integer id. The ids are found with a
+ * fixed size open addressing table that is only written with the lock held
+ * and can be read without locking because entries are never removed. */
+#define API_TABLE_SIZE  1024
+#define API_TABLE_HASH(api) ((((gsize) (api)) >> 2) & (API_TABLE_SIZE - 1))
+
+static volatile gsize api_table_keys[API_TABLE_SIZE];
+static guint api_table_ids[API_TABLE_SIZE];
+static guint n_api_ids = 0;
+
 GQuark _gst_meta_transform_copy;
 GQuark _gst_meta_tag_memory;
 
@@ -102,9 +112,46 @@ gst_meta_api_type_register (const gchar * api, const gchar ** tags)
   g_type_set_qdata (type, g_quark_from_string ("tags"),
       g_strdupv ((gchar **) tags));
 
+  if (type != 0) {
+    guint i, slot;
+
+    g_rw_lock_writer_lock (&lock);
+    if (n_api_ids < API_TABLE_SIZE / 2) {
+      slot = API_TABLE_HASH (type);
+      for (i = 0; i < API_TABLE_SIZE; i++) {
+        if (api_table_keys[slot] == 0)
+          break;
+        slot = (slot + 1) & (API_TABLE_SIZE - 1);
+      }
+      /* publish the id before the key */
+      api_table_ids[slot] = ++n_api_ids;
+      g_atomic_pointer_set (&api_table_keys[slot], type);
+      GST_CAT_DEBUG (GST_CAT_META, "API \"%s\" has id %u", api, n_api_ids);
+    }
+    g_rw_lock_writer_unlock (&lock);
+  }
+
   return type;
 }
 
+guint
+_priv_gst_meta_api_get_id (GType api)
+{
+  guint i, slot;
+  gsize key;
+
+  slot = API_TABLE_HASH (api);
+  for (i = 0; i < API_TABLE_SIZE; i++) {
+    key = (gsize) g_atomic_pointer_get (&api_table_keys[slot]);
+    if (key == api)
+      return api_table_ids[slot];
+    if (key == 0)
+      break;
+    slot = (slot + 1) & (API_TABLE_SIZE - 1);
+  }
+  return 0;
+}
+
 /**
  * gst_meta_api_type_has_tag:
  * @api: an API
@@ -132,14 +132,49 @@ typedef struct
   GstEvent *event;
 } PadEvent;
 
+/* sticky event types are numbered in steps of 10, each of them gets a slot
+ * in the index of the stored events */
+#define EVENT_SLOT(type) MIN (((type) >> GST_EVENT_NUM_SHIFT) / 10, 31)
+#define EVENT_SLOT_BIT(type) (1U << EVENT_SLOT (type))
+
 struct _GstPadPrivate
 {
   guint events_cookie;
   GArray *events;
+  /* index of the events by slot, see reindex_events() */
+  guint32 events_present;
+  guint32 events_pending;
+  guint16 events_index[32];
 
   gint using;
   guint probe_list_cookie;
   guint probe_cookie;
+  /* all flags of the installed probes */
+  GstPadProbeType probe_mask;
+
+  /* last fixed caps accepted from the peer, protected by the object lock */
+  GstCaps *accepted_caps;
+  GstPad *accepted_peer;
+  guint skipped_negotiations;
+
+  /* steady-state data flow, see publish_quiescent(). quiescent and
+   * fast_users are accessed atomically, fast_peer is only changed when
+   * there are no fast users and fast_hold is protected by the object lock */
+  gint quiescent;
+  gint fast_users;
+  GstPad *fast_peer;
+  GstPad *fast_hold;
+
+  /* buffers collected for the next list push, see gst_pad_set_batching().
+   * Protected by the object lock. batching is updated with the lock held,
+   * see update_batching(), and read atomically without the lock */
+  guint batch_size;
+  GstClockTime batch_latency;
+  GstBufferList *batch;
+  GstClockTime batch_start;
+  gint64 batch_start_time;
+  GstFlowReturn batch_ret;
+  gint batching;
 };
 
 typedef struct
@@ -149,6 +184,7 @@ typedef struct
 } GstProbe;
 
 #define PROBE_COOKIE(h) (((GstProbe *)(h))->cookie)
+#define PROBE_FLAGS(h) ((GstPadProbeType) ((h)->flags >> G_HOOK_FLAG_USER_SHIFT))
 
 typedef struct
 {
@@ -160,6 +196,15 @@ typedef struct
   guint cookie;
 } ProbeMarshall;
 
+/* the pads that started a batch while a list was chained on this thread,
+ * their batches are pushed when the list is done */
+typedef struct
+{
+  GSList *pads;
+} BatchScope;
+
+static GPrivate batch_scope = G_PRIVATE_INIT (NULL);
+
 static void gst_pad_dispose (GObject * object);
 static void gst_pad_finalize (GObject * object);
 static void gst_pad_set_property (GObject * object, guint prop_id,
@@ -356,6 +401,166 @@ gst_pad_init (GstPad * pad)
   g_hook_list_init (&pad->probes, sizeof (GstProbe));
 
   pad->priv->events = g_array_sized_new (FALSE, TRUE, sizeof (PadEvent), 16);
+  pad->priv->batch_latency = GST_CLOCK_TIME_NONE;
+}
+
+/* Forget the caps that were accepted before, called when something changes
+ * that could make the pad refuse them. Must be called with object lock */
+static void
+clear_accepted_caps (GstPad * pad)
+{
+  gst_caps_replace (&pad->priv->accepted_caps, NULL);
+  pad->priv->accepted_peer = NULL;
+}
+
+/* Remember fixed caps from a CAPS event that was handled. Must be called
+ * with object lock */
+static void
+store_accepted_caps (GstPad * pad, GstEvent * event)
+{
+  GstCaps *caps;
+
+  gst_event_parse_caps (event, &caps);
+
+  if (gst_caps_is_fixed (caps)) {
+    gst_caps_replace (&pad->priv->accepted_caps, caps);
+    pad->priv->accepted_peer = GST_PAD_PEER (pad);
+  } else {
+    clear_accepted_caps (pad);
+  }
+}
+
+/* Check if @caps are the same fixed caps that were accepted from the
+ * current peer before. Must be called with object lock */
+static inline gboolean
+check_accepted_caps (GstPad * pad, GstCaps * caps)
+{
+  GstCaps *accepted = pad->priv->accepted_caps;
+
+  if (accepted == NULL || pad->priv->accepted_peer != GST_PAD_PEER (pad))
+    return FALSE;
+
+  if (accepted == caps)
+    return TRUE;
+
+  return gst_caps_is_fixed (caps) && gst_caps_is_equal_fixed (accepted, caps);
+}
+
+/* flags that make buffers take the locked path, they can be set from
+ * anywhere so they are checked on each buffer */
+#define QUIESCENT_FLAGS_MASK (GST_PAD_FLAG_FLUSHING | GST_PAD_FLAG_EOS | \
+    GST_PAD_FLAG_PENDING_EVENTS)
+
+/* Check if any of the installed probes could match an item of @type. This
+ * uses the same rules as probe_hook_marshal() on the flags of all probes
+ * together, when it returns FALSE none of the probes would be called.
+ * Must be called with object lock */
+static inline gboolean
+probes_match (GstPad * pad, GstPadProbeType type)
+{
+  GstPadProbeType flags = pad->priv->probe_mask;
+
+  if ((flags & GST_PAD_PROBE_TYPE_ALL_BOTH & type) == 0)
+    return FALSE;
+  if ((flags & GST_PAD_PROBE_TYPE_SCHEDULING & type) == 0)
+    return FALSE;
+  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) &&
+      (flags & GST_PAD_PROBE_TYPE_BLOCKING & type) == 0)
+    return FALSE;
+  if ((type & GST_PAD_PROBE_TYPE_EVENT_FLUSH) &&
+      (flags & GST_PAD_PROBE_TYPE_EVENT_FLUSH & type) == 0)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Mark @pad as quiescent when nothing needs to be checked for the buffers
+ * that flow through it: it is in push mode, has no buffer probes, is not flushing
+ * and has no pending sticky events. Buffers can then skip the object lock
+ * until clear_quiescent() is called. Must be called with object lock */
+static void
+publish_quiescent (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+
+  if (g_atomic_int_get (&priv->quiescent))
+    return;
+
+  if (GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH ||
+      (GST_OBJECT_FLAGS (pad) & QUIESCENT_FLAGS_MASK))
+    return;
+
+  /* probes for other items don't matter */
+  if (pad->num_probes && probes_match (pad, GST_PAD_PROBE_TYPE_BUFFER |
+          GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH))
+    return;
+
+  if (GST_PAD_IS_SRC (pad)) {
+    if (GST_PAD_PEER (pad) == NULL)
+      return;
+    /* wait until the last push on the old peer finished */
+    if (priv->fast_hold || g_atomic_int_get (&priv->fast_users) > 0)
+      return;
+    priv->fast_peer = GST_PAD_PEER (pad);
+  }
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "pad is quiescent");
+  g_atomic_int_set (&priv->quiescent, TRUE);
+}
+
+/* Make buffers take the locked path again, called when something changes
+ * that is checked there. Must be called with object lock */
+static void
+clear_quiescent (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+
+  if (!g_atomic_int_get (&priv->quiescent))
+    return;
+
+  g_atomic_int_set (&priv->quiescent, FALSE);
+
+  /* pushes on the fast path don't take a ref to the peer, keep it alive
+   * until the last one is done, see fast_push_done() */
+  if (g_atomic_int_get (&priv->fast_users) > 0 && priv->fast_hold == NULL)
+    priv->fast_hold = gst_object_ref (priv->fast_peer);
+}
+
+/* check if gst_pad_push() must go through the batching code, because
+ * batching is enabled or buffers are still collected. Must be called with
+ * object lock */
+static inline void
+update_batching (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+
+  g_atomic_int_set (&priv->batching, priv->batch_size > 1
+      || priv->batch != NULL);
+}
+
+/* Forget the buffers collected for the next list push, called when the
+ * pad starts flushing. Must be called with object lock */
+static void
+drop_batch (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+
+  if (priv->batch) {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "dropping %u batched buffers",
+        gst_buffer_list_length (priv->batch));
+    gst_buffer_list_unref (priv->batch);
+    priv->batch = NULL;
+    update_batching (pad);
+  }
+  priv->batch_ret = GST_FLOW_OK;
+}
+
+static inline gboolean
+is_quiescent (GstPad * pad)
+{
+  return g_atomic_int_get (&pad->priv->quiescent) &&
+      (g_atomic_int_get ((gint *) & GST_OBJECT_FLAGS (pad)) &
+      QUIESCENT_FLAGS_MASK) == 0;
 }
 
 /* called when setting the pad inactive. It removes all sticky events from
@@ -367,6 +572,8 @@ remove_events (GstPad * pad)
   GArray *events;
 
   events = pad->priv->events;
+  pad->priv->events_present = 0;
+  pad->priv->events_pending = 0;
 
   len = events->len;
   for (i = 0; i < len; i++) {
@@ -387,55 +594,138 @@ remove_events (GstPad * pad)
   }
   GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
   g_array_set_size (events, 0);
+  pad->priv->events_present = 0;
+  pad->priv->events_pending = 0;
   pad->priv->events_cookie++;
+  clear_quiescent (pad);
 }
 
-/* should be called with object lock */
+/* Rebuild the index after events were added to or removed from the array.
+ * The events are sorted by type so all events of a slot are next to each
+ * other, except that EOS can be stored before later types. Must be called
+ * with object lock */
+static void
+reindex_events (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+  GArray *events = priv->events;
+  guint i;
+
+  priv->events_present = 0;
+  priv->events_pending = 0;
+
+  for (i = 0; i < events->len; i++) {
+    PadEvent *ev = &g_array_index (events, PadEvent, i);
+    guint32 bit;
+
+    if (ev->event == NULL)
+      continue;
+
+    bit = EVENT_SLOT_BIT (GST_EVENT_TYPE (ev->event));
+    if ((priv->events_present & bit) == 0) {
+      priv->events_present |= bit;
+      priv->events_index[EVENT_SLOT (GST_EVENT_TYPE (ev->event))] = i;
+    }
+    if (!ev->received)
+      priv->events_pending |= bit;
+  }
+}
+
+/* get the first event of @slot at or after position @i, NULL when there
+ * are no more. Must be called with object lock */
 static PadEvent *
-find_event_by_type (GstPad * pad, GstEventType type, guint idx)
+slot_next_event (GstPad * pad, guint slot, guint * i)
 {
-  guint i, len;
-  GArray *events;
-  PadEvent *ev;
+  GArray *events = pad->priv->events;
 
-  events = pad->priv->events;
-  len = events->len;
+  for (; *i < events->len; (*i)++) {
+    PadEvent *ev = &g_array_index (events, PadEvent, *i);
+    GstEventType type;
 
-  for (i = 0; i < len; i++) {
-    ev = &g_array_index (events, PadEvent, i);
     if (ev->event == NULL)
       continue;
 
+    type = GST_EVENT_TYPE (ev->event);
+    if (EVENT_SLOT (type) == slot)
+      return ev;
+    if (type != GST_EVENT_EOS)
+      break;
+  }
+  return NULL;
+}
+
+/* recheck if @slot has events that were not received. Must be called with
+ * object lock */
+static void
+update_slot_pending (GstPad * pad, guint slot)
+{
+  GstPadPrivate *priv = pad->priv;
+  PadEvent *ev;
+  guint i;
+
+  priv->events_pending &= ~(1U << slot);
+  if ((priv->events_present & (1U << slot)) == 0)
+    return;
+
+  for (i = priv->events_index[slot]; (ev = slot_next_event (pad, slot, &i));
+      i++) {
+    if (!ev->received) {
+      priv->events_pending |= 1U << slot;
+      break;
+    }
+  }
+}
+
+/* mark @ev to be sent again, the caller sets the PENDING_EVENTS flag.
+ * Must be called with object lock */
+static void
+mark_event_pending (GstPad * pad, PadEvent * ev)
+{
+  ev->received = FALSE;
+  pad->priv->events_pending |= EVENT_SLOT_BIT (GST_EVENT_TYPE (ev->event));
+}
+
+/* should be called with object lock */
+static PadEvent *
+find_event_by_type (GstPad * pad, GstEventType type, guint idx)
+{
+  GstPadPrivate *priv = pad->priv;
+  guint i, slot;
+  PadEvent *ev;
+
+  slot = EVENT_SLOT (type);
+  if ((priv->events_present & (1U << slot)) == 0)
+    return NULL;
+
+  for (i = priv->events_index[slot]; (ev = slot_next_event (pad, slot, &i));
+      i++) {
     if (GST_EVENT_TYPE (ev->event) == type) {
       if (idx == 0)
-        goto found;
+        return ev;
       idx--;
     }
   }
-  ev = NULL;
-found:
-  return ev;
+  return NULL;
 }
 
 /* should be called with OBJECT lock */
 static PadEvent *
 find_event (GstPad * pad, GstEvent * event)
 {
-  guint i, len;
-  GArray *events;
+  GstPadPrivate *priv = pad->priv;
+  guint i, slot;
   PadEvent *ev;
 
-  events = pad->priv->events;
-  len = events->len;
+  slot = EVENT_SLOT (GST_EVENT_TYPE (event));
+  if ((priv->events_present & (1U << slot)) == 0)
+    return NULL;
 
-  for (i = 0; i < len; i++) {
-    ev = &g_array_index (events, PadEvent, i);
+  for (i = priv->events_index[slot]; (ev = slot_next_event (pad, slot, &i));
+      i++) {
     if (event == ev->event)
-      goto found;
+      return ev;
   }
-  ev = NULL;
-found:
-  return ev;
+  return NULL;
 }
 
 /* should be called with OBJECT lock */
@@ -445,6 +735,10 @@ remove_event_by_type (GstPad * pad, GstEventType type)
   guint i, len;
   GArray *events;
   PadEvent *ev;
+  gboolean removed = FALSE;
+
+  if ((pad->priv->events_present & EVENT_SLOT_BIT (type)) == 0)
+    return;
 
   events = pad->priv->events;
   len = events->len;
@@ -462,11 +756,15 @@ remove_event_by_type (GstPad * pad, GstEventType type)
     g_array_remove_index (events, i);
     len--;
     pad->priv->events_cookie++;
+    clear_quiescent (pad);
+    removed = TRUE;
     continue;
 
   next:
     i++;
   }
+  if (removed)
+    reindex_events (pad);
 }
 
 /* check all events on srcpad against those on sinkpad. All events that are not
@@ -490,7 +788,7 @@ schedule_events (GstPad * srcpad, GstPad * sinkpad)
       continue;
 
     if (sinkpad == NULL || !find_event (sinkpad, ev->event)) {
-      ev->received = FALSE;
+      mark_event_pending (srcpad, ev);
       pending = TRUE;
     }
   }
@@ -538,7 +836,10 @@ restart:
     }
 
     /* store the received state */
-    ev->received = ev_ret.received;
+    if (ev->received != ev_ret.received) {
+      ev->received = ev_ret.received;
+      update_slot_pending (pad, EVENT_SLOT (GST_EVENT_TYPE (ev->event)));
+    }
 
     /* if the event changed, we need to do something */
     if (G_UNLIKELY (ev->event != ev_ret.event)) {
@@ -547,10 +848,12 @@ restart:
         g_array_remove_index (events, i);
         len--;
         cookie = ++pad->priv->events_cookie;
+        reindex_events (pad);
         continue;
       } else {
         /* function gave a new event for us */
         gst_event_take (&ev->event, ev_ret.event);
+        reindex_events (pad);
       }
     } else {
       /* just unref, nothing changed */
@@ -563,6 +866,75 @@ restart:
   }
 }
 
+/* get the pending slot whose events come first in the array */
+static guint
+next_pending_slot (GstPad * pad, guint32 todo)
+{
+  guint slot, best = 0;
+  gboolean found = FALSE;
+
+  for (slot = 0; todo; slot++, todo >>= 1) {
+    if ((todo & 1) && (!found ||
+            pad->priv->events_index[slot] < pad->priv->events_index[best])) {
+      best = slot;
+      found = TRUE;
+    }
+  }
+  return best;
+}
+
+/* like events_foreach() but only for the events that were not received
+ * yet, so that the cost depends on the number of changed events. @func
+ * must not replace or remove the event. should be called with pad LOCK */
+static void
+pending_events_foreach (GstPad * pad, PadEventFunction func,
+    gpointer user_data)
+{
+  GstPadPrivate *priv = pad->priv;
+  guint32 todo;
+  guint cookie;
+
+restart:
+  cookie = priv->events_cookie;
+  todo = priv->events_pending & priv->events_present;
+  while (todo) {
+    guint slot, i;
+    PadEvent *ev;
+    gboolean ret = TRUE;
+
+    slot = next_pending_slot (pad, todo);
+    todo &= ~(1U << slot);
+
+    for (i = priv->events_index[slot]; (ev = slot_next_event (pad, slot, &i));
+        i++) {
+      PadEvent ev_ret;
+
+      if (ev->received)
+        continue;
+
+      /* take aditional ref, func might release the lock */
+      ev_ret.event = gst_event_ref (ev->event);
+      ev_ret.received = FALSE;
+
+      ret = func (pad, &ev_ret, user_data);
+
+      gst_event_unref (ev_ret.event);
+
+      /* the lock might have been released and the events could have
+       * changed */
+      if (G_UNLIKELY (cookie != priv->events_cookie))
+        goto restart;
+
+      ev->received = ev_ret.received;
+      if (!ret)
+        break;
+    }
+    update_slot_pending (pad, slot);
+    if (!ret)
+      break;
+  }
+}
+
 /* should be called with LOCK */
 static GstEvent *
 apply_pad_offset (GstPad * pad, GstEvent * event)
@@ -624,6 +996,7 @@ gst_pad_dispose (GObject * object)
   GST_OBJECT_UNLOCK (pad);
 
   g_hook_list_clear (&pad->probes);
+  pad->priv->probe_mask = 0;
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -665,6 +1038,9 @@ gst_pad_finalize (GObject * object)
   g_rec_mutex_clear (&pad->stream_rec_lock);
   g_cond_clear (&pad->block_cond);
   g_array_free (pad->priv->events, TRUE);
+  gst_caps_replace (&pad->priv->accepted_caps, NULL);
+  if (pad->priv->batch)
+    gst_buffer_list_unref (pad->priv->batch);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -859,6 +1235,8 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
       GST_DEBUG_OBJECT (pad, "setting PAD_MODE NONE, set flushing");
       GST_PAD_SET_FLUSHING (pad);
       GST_PAD_MODE (pad) = new_mode;
+      clear_quiescent (pad);
+      drop_batch (pad);
       /* unlock blocked pads so element can resume and stop */
       GST_PAD_BLOCK_BROADCAST (pad);
       GST_OBJECT_UNLOCK (pad);
@@ -870,6 +1248,7 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
           gst_pad_mode_get_name (new_mode));
       GST_PAD_UNSET_FLUSHING (pad);
       GST_PAD_MODE (pad) = new_mode;
+      clear_quiescent (pad);
       if (GST_PAD_IS_SINK (pad)) {
         GstPad *peer;
         /* make sure the peer src pad sends us all events */
@@ -905,6 +1284,7 @@ post_activate (GstPad * pad, GstPadMode new_mode)
       GST_DEBUG_OBJECT (pad, "stopped streaming");
       GST_OBJECT_LOCK (pad);
       remove_events (pad);
+      clear_accepted_caps (pad);
       GST_OBJECT_UNLOCK (pad);
       GST_PAD_STREAM_UNLOCK (pad);
       break;
@@ -1230,6 +1610,8 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
   /* add the probe */
   g_hook_prepend (&pad->probes, hook);
   pad->num_probes++;
+  pad->priv->probe_mask |= mask;
+  clear_quiescent (pad);
   /* incremenent cookie so that the new hook get's called */
   pad->priv->probe_list_cookie++;
 
@@ -1249,7 +1631,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* call the callback if we need to be called for idle callbacks */
   if ((mask & GST_PAD_PROBE_TYPE_IDLE) && (callback != NULL)) {
-    if (pad->priv->using > 0) {
+    if (pad->priv->using > 0 || g_atomic_int_get (&pad->priv->fast_users) > 0) {
       /* the pad is in use, we can't signal the idle callback yet. Since we set the
        * flag above, the last thread to leave the push will do the callback. New
        * threads going into the push will block. */
@@ -1276,11 +1658,12 @@ static void
 cleanup_hook (GstPad * pad, GHook * hook)
 {
   GstPadProbeType type;
+  GHook *walk;
 
   if (!G_HOOK_IS_VALID (hook))
     return;
 
-  type = (hook->flags) >> G_HOOK_FLAG_USER_SHIFT;
+  type = PROBE_FLAGS (hook);
 
   if (type & GST_PAD_PROBE_TYPE_BLOCKING) {
     /* unblock when we remove the last blocking probe */
@@ -1295,6 +1678,13 @@ cleanup_hook (GstPad * pad, GHook * hook)
   }
   g_hook_destroy_link (&pad->probes, hook);
   pad->num_probes--;
+
+  /* collect the flags of the remaining probes */
+  pad->priv->probe_mask = 0;
+  for (walk = pad->probes.hooks; walk; walk = walk->next) {
+    if (G_HOOK_IS_VALID (walk))
+      pad->priv->probe_mask |= PROBE_FLAGS (walk);
+  }
 }
 
 /**
@@ -1451,9 +1841,39 @@ gst_pad_mark_reconfigure (GstPad * pad)
 
   GST_OBJECT_LOCK (pad);
   GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+  clear_accepted_caps (pad);
   GST_OBJECT_UNLOCK (pad);
 }
 
+/**
+ * gst_pad_get_skipped_negotiations:
+ * @pad: the #GstPad to check
+ *
+ * Get the number of CAPS events received on @pad for which the accept-caps
+ * query was skipped because the same fixed caps had already been accepted
+ * from the same peer.
+ *
+ * The remembered caps are forgotten when the pad is relinked, deactivated
+ * or marked for reconfiguration, or when a RECONFIGURE event passes it.
+ *
+ * Returns: the number of skipped negotiations
+ *
+ * Since: 1.2
+ */
+guint
+gst_pad_get_skipped_negotiations (GstPad * pad)
+{
+  guint skipped;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), 0);
+
+  GST_OBJECT_LOCK (pad);
+  skipped = pad->priv->skipped_negotiations;
+  GST_OBJECT_UNLOCK (pad);
+
+  return skipped;
+}
+
 /**
  * gst_pad_set_activate_function:
  * @p: a #GstPad.
@@ -1696,6 +2116,10 @@ gst_pad_set_query_function_full (GstPad * pad, GstPadQueryFunction query,
   pad->querydata = user_data;
   pad->querynotify = notify;
 
+  GST_OBJECT_LOCK (pad);
+  clear_accepted_caps (pad);
+  GST_OBJECT_UNLOCK (pad);
+
   GST_CAT_DEBUG_OBJECT (GST_CAT_PADS, pad, "queryfunc set to %s",
       GST_DEBUG_FUNCPTR_NAME (query));
 }
@@ -1879,9 +2303,14 @@ no_src_parent:
 no_sink_parent:
 
   /* first clear peers */
+  clear_quiescent (srcpad);
+
   GST_PAD_PEER (srcpad) = NULL;
   GST_PAD_PEER (sinkpad) = NULL;
 
+  clear_accepted_caps (srcpad);
+  clear_accepted_caps (sinkpad);
+
   GST_OBJECT_UNLOCK (sinkpad);
   GST_OBJECT_UNLOCK (srcpad);
 
@@ -3023,7 +3452,7 @@ probe_hook_marshal (GHook * hook, ProbeMarshall * data)
 
   PROBE_COOKIE (hook) = data->cookie;
 
-  flags = hook->flags >> G_HOOK_FLAG_USER_SHIFT;
+  flags = PROBE_FLAGS (hook);
   type = info->type;
 
   /* one of the data types */
@@ -3098,7 +3527,7 @@ no_match:
 /* a probe that does not take or return any data */
 #define PROBE_NO_DATA(pad,mask,label,defaultval)                \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (G_UNLIKELY (pad->num_probes) && probes_match (pad, mask)) {	\
       /* pass NULL as the data item */                          \
       GstPadProbeInfo info = { mask, 0, NULL, 0, 0 };           \
       ret = do_probe_callbacks (pad, &info, defaultval);	\
@@ -3109,7 +3538,7 @@ no_match:
 
 #define PROBE_FULL(pad,mask,data,offs,size,label)               \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (G_UNLIKELY (pad->num_probes) && probes_match (pad, mask)) {	\
       /* pass the data item */                                  \
       GstPadProbeInfo info = { mask, 0, data, offs, size };     \
       ret = do_probe_callbacks (pad, &info, GST_FLOW_OK);	\
@@ -3273,7 +3702,7 @@ gst_pad_set_offset (GstPad * pad, gint64 offset)
 
   /* resend the last segment event on next buffer push */
   if ((ev = find_event_by_type (pad, GST_EVENT_SEGMENT, 0))) {
-    ev->received = FALSE;
+    mark_event_pending (pad, ev);
     GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_PENDING_EVENTS);
   }
 
@@ -3373,8 +3802,8 @@ check_sticky (GstPad * pad, GstEvent * event)
   if (G_UNLIKELY (GST_PAD_HAS_PENDING_EVENTS (pad))) {
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
-    GST_DEBUG_OBJECT (pad, "pushing all sticky events");
-    events_foreach (pad, push_sticky, &data);
+    GST_DEBUG_OBJECT (pad, "pushing pending sticky events");
+    pending_events_foreach (pad, push_sticky, &data);
 
     /* If there's an EOS event we must push it downstream
      * even if sending a previous sticky event failed.
@@ -3663,6 +4092,12 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
 
   GST_PAD_STREAM_LOCK (pad);
 
+  /* nothing changed since the last buffer, no need to check anything */
+  if (G_LIKELY (is_quiescent (pad))) {
+    parent = GST_OBJECT_PARENT (pad);
+    goto chain;
+  }
+
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
@@ -3690,9 +4125,12 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
 
   PROBE_PUSH (pad, type, data, probe_stopped);
 
+  publish_quiescent (pad);
+
   parent = GST_OBJECT_PARENT (pad);
   GST_OBJECT_UNLOCK (pad);
 
+chain:
   /* NOTE: we read the chainfunc unlocked.
    * we cannot hold the lock for the pad so we might send
    * the data to the wrong function. This is not really a
@@ -3832,23 +4270,51 @@ gst_pad_chain_list_default (GstPad * pad, GstObject * parent,
   guint i, len;
   GstBuffer *buffer;
   GstFlowReturn ret;
+  GstPadChainFunction chainfunc;
+  BatchScope scope = { NULL }, *outer;
+  GSList *walk;
 
   GST_INFO_OBJECT (pad, "chaining each group in list as a merged buffer");
 
   len = gst_buffer_list_length (list);
 
+  /* buffers pushed on batching pads while we chain the list are collected
+   * and pushed as lists when we are done */
+  outer = g_private_get (&batch_scope);
+  g_private_set (&batch_scope, &scope);
+
   ret = GST_FLOW_OK;
   for (i = 0; i < len; i++) {
-    buffer = gst_buffer_list_get (list, i);
-    ret =
-        gst_pad_chain_data_unchecked (pad,
-        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH,
-        gst_buffer_ref (buffer));
+    buffer = gst_buffer_ref (gst_buffer_list_get (list, i));
+
+    /* the checks were done for the list, as long as nothing changed the
+     * chain function can be called directly */
+    if (G_LIKELY (is_quiescent (pad)
+            && (chainfunc = GST_PAD_CHAINFUNC (pad)) != NULL))
+      ret = chainfunc (pad, parent, buffer);
+    else
+      ret = gst_pad_chain_data_unchecked (pad,
+          GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+
     if (ret != GST_FLOW_OK)
       break;
   }
   gst_buffer_list_unref (list);
 
+  g_private_set (&batch_scope, outer);
+
+  scope.pads = g_slist_reverse (scope.pads);
+  for (walk = scope.pads; walk; walk = g_slist_next (walk)) {
+    GstPad *srcpad = walk->data;
+    GstFlowReturn bret;
+
+    bret = gst_pad_push_batch (srcpad);
+    if (ret == GST_FLOW_OK)
+      ret = bret;
+    gst_object_unref (srcpad);
+  }
+  g_slist_free (scope.pads);
+
   return ret;
 }
 
@@ -3888,13 +4354,59 @@ gst_pad_chain_list (GstPad * pad, GstBufferList * list)
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
 
+/* called by the last thread leaving the fast path after the pad stopped
+ * being quiescent. It drops the ref that kept the peer alive and does the
+ * idle callbacks that could not be done while the pad was in use */
+static GstFlowReturn
+fast_push_done (GstPad * pad, GstFlowReturn ret, gboolean pushed)
+{
+  GstPad *hold = NULL;
+
+  GST_OBJECT_LOCK (pad);
+  if (g_atomic_int_get (&pad->priv->fast_users) == 0) {
+    hold = pad->priv->fast_hold;
+    pad->priv->fast_hold = NULL;
+  }
+  if (pushed && pad->priv->using == 0) {
+    PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
+        probe_stopped, ret);
+  }
+probe_stopped:
+  GST_OBJECT_UNLOCK (pad);
+
+  if (hold)
+    gst_object_unref (hold);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 {
   GstPad *peer;
   GstFlowReturn ret;
 
+  /* steady state, go straight to the peer without taking the lock. The
+   * fast_users count makes sure the peer stays alive, see clear_quiescent() */
+  g_atomic_int_inc (&pad->priv->fast_users);
+  if (G_LIKELY (is_quiescent (pad))) {
+    ret = gst_pad_chain_data_unchecked (pad->priv->fast_peer, type, data);
+
+    if (g_atomic_int_dec_and_test (&pad->priv->fast_users) &&
+        G_UNLIKELY (!g_atomic_int_get (&pad->priv->quiescent)))
+      ret = fast_push_done (pad, ret, TRUE);
+
+    return ret;
+  }
+  g_atomic_int_add (&pad->priv->fast_users, -1);
+
   GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (pad->priv->fast_hold)) {
+    /* we might have been the last one to leave the fast path */
+    GST_OBJECT_UNLOCK (pad);
+    fast_push_done (pad, GST_FLOW_OK, FALSE);
+    GST_OBJECT_LOCK (pad);
+  }
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
 
@@ -3944,11 +4456,15 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   GST_OBJECT_LOCK (pad);
   pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (pad->priv->using == 0 &&
+      g_atomic_int_get (&pad->priv->fast_users) == 0) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped, ret);
   }
+  /* next buffers can skip the checks above if nothing changes */
+  if (ret == GST_FLOW_OK)
+    publish_quiescent (pad);
   GST_OBJECT_UNLOCK (pad);
 
   return ret;
@@ -4012,6 +4528,89 @@ not_linked:
   }
 }
 
+/* add @buffer to the batch of @pad and push the batch when it is full */
+static GstFlowReturn
+gst_pad_push_batched (GstPad * pad, GstBuffer * buffer)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstBufferList *list = NULL;
+  GstClockTime ts;
+  GstFlowReturn ret;
+
+  ts = GST_BUFFER_DTS (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_PTS (buffer);
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+    goto flushing;
+
+  /* a batch pushed before an event failed, report it now */
+  if (G_UNLIKELY ((ret = priv->batch_ret) != GST_FLOW_OK)) {
+    priv->batch_ret = GST_FLOW_OK;
+    goto batch_failed;
+  }
+
+  if (priv->batch == NULL) {
+    BatchScope *scope;
+
+    /* batching was disabled */
+    if (G_UNLIKELY (priv->batch_size <= 1)) {
+      GST_OBJECT_UNLOCK (pad);
+      return gst_pad_push_data (pad,
+          GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+    }
+    priv->batch = gst_buffer_list_new_sized (priv->batch_size);
+    priv->batch_start = ts;
+    priv->batch_start_time = g_get_monotonic_time ();
+
+    if ((scope = g_private_get (&batch_scope)))
+      scope->pads = g_slist_prepend (scope->pads, gst_object_ref (pad));
+  }
+  gst_buffer_list_add (priv->batch, buffer);
+
+  /* the latency is checked against the timestamps and against the time that
+   * passed since the batch was started, for buffers without timestamps or
+   * that arrive slower than real time */
+  if (gst_buffer_list_length (priv->batch) >= priv->batch_size ||
+      (GST_CLOCK_TIME_IS_VALID (priv->batch_latency) &&
+          ((GST_CLOCK_TIME_IS_VALID (priv->batch_start) &&
+                  GST_CLOCK_TIME_IS_VALID (ts) &&
+                  ts >= priv->batch_start + priv->batch_latency) ||
+              g_get_monotonic_time () - priv->batch_start_time >=
+              (gint64) GST_TIME_AS_USECONDS (priv->batch_latency)))) {
+    list = priv->batch;
+    priv->batch = NULL;
+  }
+  update_batching (pad);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  return gst_pad_push_data (pad,
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+
+  /* ERRORS */
+flushing:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "batching, but pad was flushing");
+    drop_batch (pad);
+    GST_OBJECT_UNLOCK (pad);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+batch_failed:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "previous batch failed, return %s", gst_flow_get_name (ret));
+    GST_OBJECT_UNLOCK (pad);
+    gst_buffer_unref (buffer);
+    return ret;
+  }
+}
+
 /**
  * gst_pad_push:
  * @pad: a source #GstPad, returns #GST_FLOW_ERROR if not.
@@ -4041,6 +4640,9 @@ gst_pad_push (GstPad * pad, GstBuffer * buffer)
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batching)))
+    return gst_pad_push_batched (pad, buffer);
+
   return gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
 }
@@ -4076,6 +4678,117 @@ gst_pad_push_list (GstPad * pad, GstBufferList * list)
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
+  /* keep the order with the buffers that were batched before */
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batching))) {
+    GstFlowReturn ret;
+
+    if ((ret = gst_pad_push_batch (pad)) != GST_FLOW_OK) {
+      gst_buffer_list_unref (list);
+      return ret;
+    }
+  }
+
+  return gst_pad_push_data (pad,
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+}
+
+/**
+ * gst_pad_set_batching:
+ * @pad: a source #GstPad
+ * @max_buffers: the maximum number of buffers in a batch, 0 or 1 to disable
+ *     batching
+ * @max_latency: the maximum timestamp difference between the first and the
+ *     last buffer of a batch or #GST_CLOCK_TIME_NONE
+ *
+ * Make gst_pad_push() collect buffers and push them as a #GstBufferList
+ * to the peer of @pad, so that probes, sticky events and locking are
+ * handled once per batch instead of once per buffer.
+ *
+ * A batch is pushed when it contains @max_buffers buffers, when the
+ * timestamp of a buffer is @max_latency or more after the first buffer
+ * of the batch or when a buffer is pushed @max_latency or more after the
+ * first buffer of the batch was pushed. It is also pushed before a
+ * serialized event or buffer list is pushed on @pad and with
+ * gst_pad_push_batch(). When buffers are pushed from the chain function of
+ * an element that gets a buffer list on a pad without a chainlist function,
+ * the batch is also pushed when the element is done with the list.
+ *
+ * The batch is only checked when a buffer is pushed, there is no timer that
+ * pushes it. A source that stops producing buffers keeps the collected
+ * buffers until it pushes again. Elements that push on @pad from their own
+ * thread, such as live sources, should call gst_pad_push_batch() before they
+ * wait for more data.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_pad_set_batching (GstPad * pad, guint max_buffers,
+    GstClockTime max_latency)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+  g_return_if_fail (GST_PAD_IS_SRC (pad));
+
+  GST_OBJECT_LOCK (pad);
+  GST_DEBUG_OBJECT (pad, "batching up to %u buffers and %" GST_TIME_FORMAT,
+      max_buffers, GST_TIME_ARGS (max_latency));
+  /* a pending batch is pushed with the next buffer when disabled */
+  pad->priv->batch_size = max_buffers;
+  pad->priv->batch_latency = max_latency;
+  update_batching (pad);
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/**
+ * gst_pad_push_batch:
+ * @pad: a source #GstPad, returns #GST_FLOW_ERROR if not.
+ *
+ * Pushes the buffers that were collected on @pad because of
+ * gst_pad_set_batching() as a #GstBufferList to the peer of @pad.
+ *
+ * When pushing a batch before a serialized event failed, that error is
+ * returned and cleared and the collected buffers are dropped.
+ *
+ * Returns: a #GstFlowReturn from the peer pad or #GST_FLOW_OK when there
+ * were no buffers to push.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+GstFlowReturn
+gst_pad_push_batch (GstPad * pad)
+{
+  GstBufferList *list;
+  GstFlowReturn ret;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
+
+  GST_OBJECT_LOCK (pad);
+  list = pad->priv->batch;
+  pad->priv->batch = NULL;
+  ret = pad->priv->batch_ret;
+  pad->priv->batch_ret = GST_FLOW_OK;
+  update_batching (pad);
+  GST_OBJECT_UNLOCK (pad);
+
+  /* a batch pushed before an event failed, report it now */
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "previous batch failed, return %s", gst_flow_get_name (ret));
+    if (list)
+      gst_buffer_list_unref (list);
+    return ret;
+  }
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "pushing batch of %u buffers",
+      gst_buffer_list_length (list));
+
   return gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
@@ -4472,26 +5185,38 @@ store_sticky_event (GstPad * pad, GstEvent * event)
     name = gst_structure_get_name (gst_event_get_structure (event));
 
   events = pad->priv->events;
-  len = events->len;
-
-  for (i = 0; i < len; i++) {
-    PadEvent *ev = &g_array_index (events, PadEvent, i);
 
-    if (ev->event == NULL)
-      continue;
+  /* look for an event to replace in the index first */
+  if (pad->priv->events_present & EVENT_SLOT_BIT (type)) {
+    guint slot = EVENT_SLOT (type);
+    PadEvent *ev;
 
-    if (type == GST_EVENT_TYPE (ev->event)) {
+    for (i = pad->priv->events_index[slot];
+        (ev = slot_next_event (pad, slot, &i)); i++) {
+      if (type != GST_EVENT_TYPE (ev->event))
+        continue;
       /* matching types, check matching name if needed */
       if (name && !gst_event_has_name (ev->event, name))
         continue;
 
       /* overwrite */
       if ((res = gst_event_replace (&ev->event, event)))
-        ev->received = FALSE;
+        mark_event_pending (pad, ev);
 
-      insert = FALSE;
-      break;
+      goto stored;
     }
+  }
+
+  /* find the position for a new event */
+  len = events->len;
+  for (i = 0; i < len; i++) {
+    PadEvent *ev = &g_array_index (events, PadEvent, i);
+
+    if (ev->event == NULL)
+      continue;
+
+    if (type == GST_EVENT_TYPE (ev->event))
+      continue;
 
     if (type < GST_EVENT_TYPE (ev->event) || (type != GST_EVENT_TYPE (ev->event)
             && GST_EVENT_TYPE (ev->event) == GST_EVENT_EOS)) {
@@ -4512,11 +5237,14 @@ store_sticky_event (GstPad * pad, GstEvent * event)
     ev.event = gst_event_ref (event);
     ev.received = FALSE;
     g_array_insert_val (events, i, ev);
+    reindex_events (pad);
     res = TRUE;
   }
 
+stored:
   if (res) {
     pad->priv->events_cookie++;
+    clear_quiescent (pad);
     GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
     GST_LOG_OBJECT (pad, "stored sticky event %s", GST_EVENT_TYPE_NAME (event));
@@ -4608,6 +5336,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   switch (event_type) {
     case GST_EVENT_FLUSH_START:
       GST_PAD_SET_FLUSHING (pad);
+      drop_batch (pad);
 
       GST_PAD_BLOCK_BROADCAST (pad);
       type |= GST_PAD_PROBE_TYPE_EVENT_FLUSH;
@@ -4642,6 +5371,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
         case GST_EVENT_RECONFIGURE:
           if (GST_PAD_IS_SINK (pad))
             GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+          clear_accepted_caps (pad);
           break;
         default:
           break;
@@ -4664,7 +5394,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
     /* Push all sticky events before our current one
      * that have changed */
-    events_foreach (pad, sticky_changed, &data);
+    pending_events_foreach (pad, sticky_changed, &data);
   }
 
   /* now check the peer pad */
@@ -4760,6 +5490,7 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
   gboolean res = FALSE;
   GstPadProbeType type;
   gboolean sticky, serialized;
+  GstFlowReturn batch_ret;
 
   g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
   g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
@@ -4768,6 +5499,13 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
     if (G_UNLIKELY (!GST_EVENT_IS_DOWNSTREAM (event)))
       goto wrong_direction;
     type = GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM;
+
+    /* batched buffers go before serialized events */
+    if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batching))
+        && GST_EVENT_IS_SERIALIZED (event)) {
+      if ((batch_ret = gst_pad_push_batch (pad)) != GST_FLOW_OK)
+        goto batch_failed;
+    }
   } else if (GST_PAD_IS_SINK (pad)) {
     if (G_UNLIKELY (!GST_EVENT_IS_UPSTREAM (event)))
       goto wrong_direction;
@@ -4847,6 +5585,21 @@ eos:
     gst_event_unref (event);
     return FALSE;
   }
+batch_failed:
+  {
+    GST_DEBUG_OBJECT (pad, "pushing batch before %s event failed: %s",
+        GST_EVENT_TYPE_NAME (event), gst_flow_get_name (batch_ret));
+    GST_OBJECT_LOCK (pad);
+    /* the next buffer reports the error to the streaming thread as well */
+    pad->priv->batch_ret = batch_ret;
+    /* like after a failed data push, sticky events are kept and pushed with
+     * the next data */
+    if (GST_EVENT_IS_STICKY (event))
+      store_sticky_event (pad, event);
+    GST_OBJECT_UNLOCK (pad);
+    gst_event_unref (event);
+    return FALSE;
+  }
 }
 
 /* Check if we can call the event function with the given event */
@@ -4858,9 +5611,25 @@ pre_eventfunc_check (GstPad * pad, GstEvent * event)
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_CAPS:
     {
+      gboolean accepted;
+
       /* backwards compatibility mode for caps */
       gst_event_parse_caps (event, &caps);
 
+      /* skip the query when the peer sends the same fixed caps again, for
+       * example after a flushing seek */
+      GST_OBJECT_LOCK (pad);
+      accepted = check_accepted_caps (pad, caps);
+      if (accepted)
+        pad->priv->skipped_negotiations++;
+      GST_OBJECT_UNLOCK (pad);
+
+      if (accepted) {
+        GST_CAT_LOG_OBJECT (GST_CAT_CAPS, pad,
+            "caps %" GST_PTR_FORMAT " accepted before", caps);
+        break;
+      }
+
       if (!gst_pad_query_accept_caps (pad, caps))
         goto not_accepted;
       break;
@@ -4906,6 +5675,7 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
         goto flushing;
 
       GST_PAD_SET_FLUSHING (pad);
+      drop_batch (pad);
       GST_CAT_DEBUG_OBJECT (GST_CAT_EVENT, pad, "set flush flag");
       break;
     case GST_EVENT_FLUSH_STOP:
@@ -4930,6 +5700,7 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
     case GST_EVENT_RECONFIGURE:
       if (GST_PAD_IS_SRC (pad))
         GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+      clear_accepted_caps (pad);
     default:
       GST_CAT_DEBUG_OBJECT (GST_CAT_EVENT, pad,
           "have event type %" GST_PTR_FORMAT, event);
@@ -5003,6 +5774,8 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
   if (sticky) {
     if (ret == GST_FLOW_OK) {
       GST_OBJECT_LOCK (pad);
+      if (event_type == GST_EVENT_CAPS)
+        store_accepted_caps (pad, event);
       /* after the event function accepted the event, we can store the sticky
        * event on the pad */
       switch (store_sticky_event (pad, event)) {
@@ -5014,6 +5787,10 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
           break;
       }
       GST_OBJECT_UNLOCK (pad);
+    } else if (event_type == GST_EVENT_CAPS) {
+      GST_OBJECT_LOCK (pad);
+      clear_accepted_caps (pad);
+      GST_OBJECT_UNLOCK (pad);
     }
     gst_event_unref (event);
   }
@@ -874,6 +874,7 @@ gboolean		gst_pad_is_blocking			(GstPad *pad);
 void                    gst_pad_mark_reconfigure                (GstPad *pad);
 gboolean		gst_pad_needs_reconfigure               (GstPad *pad);
 gboolean		gst_pad_check_reconfigure               (GstPad *pad);
+guint                   gst_pad_get_skipped_negotiations        (GstPad *pad);
 
 void			gst_pad_set_element_private		(GstPad *pad, gpointer priv);
 gpointer		gst_pad_get_element_private		(GstPad *pad);
@@ -956,6 +957,9 @@ void                    gst_pad_set_offset                      (GstPad *pad, gi
 /* data passing functions to peer */
 GstFlowReturn		gst_pad_push				(GstPad *pad, GstBuffer *buffer);
 GstFlowReturn		gst_pad_push_list			(GstPad *pad, GstBufferList *list);
+void                    gst_pad_set_batching                    (GstPad *pad, guint max_buffers,
+                                                                 GstClockTime max_latency);
+GstFlowReturn           gst_pad_push_batch                      (GstPad *pad);
 GstFlowReturn		gst_pad_pull_range			(GstPad *pad, guint64 offset, guint size,
 								 GstBuffer **buffer);
 gboolean		gst_pad_push_event			(GstPad *pad, GstEvent *event);
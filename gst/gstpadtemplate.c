@@ -401,9 +401,13 @@ gst_pad_template_set_property (GObject * object, guint prop_id,
       GST_PAD_TEMPLATE_PRESENCE (object) =
           (GstPadPresence) g_value_get_enum (value);
       break;
-    case PROP_CAPS:
-      GST_PAD_TEMPLATE_CAPS (object) = g_value_dup_boxed (value);
+    case PROP_CAPS:{
+      GstCaps *caps = g_value_dup_boxed (value);
+
+      /* template caps are immutable, share them between equal templates */
+      GST_PAD_TEMPLATE_CAPS (object) = caps ? gst_caps_intern (caps) : NULL;
       break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -68,7 +68,8 @@ static const gchar *_quark_strings[] = {
   "GstEventSegmentDone",
   "GstEventStreamStart", "stream-id", "GstEventContext", "GstQueryContext",
   "GstMessageNeedContext", "GstMessageHaveContext", "context", "context-types",
-  "GstMessageStreamStart", "group-id", "uri-redirection"
+  "GstMessageStreamStart", "group-id", "uri-redirection",
+  "thread-cache"
 };
 
 GQuark _priv_gst_quark_table[GST_QUARK_MAX];
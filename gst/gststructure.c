@@ -78,6 +78,21 @@ struct _GstStructureField
   GValue value;
 };
 
+/* hash index from field name to position in the fields array, built lazily
+ * for structures with many fields. A slot contains the position + 1 of the
+ * field, 0 for an empty slot. */
+typedef struct
+{
+  guint mask;
+  guint32 slots[1];
+} GstStructureIndex;
+
+/* minimum number of fields before lookups use an index */
+#define INDEX_MIN_FIELDS 16
+
+/* minimum number of fields stored in the structure allocation itself */
+#define INLINE_FIELDS 4
+
 typedef struct
 {
   GstStructure s;
@@ -85,14 +100,29 @@ typedef struct
   /* owned by parent structure, NULL if no parent */
   gint *parent_refcount;
 
-  GArray *fields;
+  guint fields_len;
+  guint fields_alloc;
+  /* points to arr or to an external array once the fields don't fit anymore */
+  GstStructureField *fields;
+
+  GstStructureIndex *index;
+
+  guint n_inline;
+  GstStructureField arr[1];
 } GstStructureImpl;
 
 #define GST_STRUCTURE_REFCOUNT(s) (((GstStructureImpl*)(s))->parent_refcount)
 #define GST_STRUCTURE_FIELDS(s) (((GstStructureImpl*)(s))->fields)
+#define GST_STRUCTURE_LEN(s) (((GstStructureImpl*)(s))->fields_len)
+#define GST_STRUCTURE_INDEX(s) (((GstStructureImpl*)(s))->index)
+
+#define GST_STRUCTURE_FIELDS_INLINED(s) \
+    (GST_STRUCTURE_FIELDS(s) == ((GstStructureImpl*)(s))->arr)
+#define GST_STRUCTURE_IMPL_SIZE(n_inline) \
+    (sizeof (GstStructureImpl) + ((n_inline) - 1) * sizeof (GstStructureField))
 
 #define GST_STRUCTURE_FIELD(structure, index) \
-    &g_array_index(GST_STRUCTURE_FIELDS(structure), GstStructureField, (index))
+    (&GST_STRUCTURE_FIELDS(structure)[(index)])
 
 #define IS_MUTABLE(structure) \
     (!GST_STRUCTURE_REFCOUNT(structure) || \
@@ -133,17 +163,59 @@ _priv_gst_structure_initialize (void)
       "GstStructure debug");
 }
 
+/* append @field without checking for an existing field with the same name,
+ * the value is not copied */
+static void
+gst_structure_append_field (GstStructure * structure, GstStructureField * field)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+
+  if (G_UNLIKELY (impl->fields_len == impl->fields_alloc)) {
+    impl->fields_alloc *= 2;
+    if (impl->fields == impl->arr) {
+      impl->fields = g_new (GstStructureField, impl->fields_alloc);
+      memcpy (impl->fields, impl->arr,
+          impl->fields_len * sizeof (GstStructureField));
+    } else {
+      impl->fields = g_renew (GstStructureField, impl->fields,
+          impl->fields_alloc);
+    }
+  }
+  impl->fields[impl->fields_len++] = *field;
+}
+
+/* remove the field at @index, the following fields keep their order */
+static void
+gst_structure_remove_field_index (GstStructure * structure, guint index)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+
+  impl->fields_len--;
+  if (index < impl->fields_len)
+    memmove (&impl->fields[index], &impl->fields[index + 1],
+        (impl->fields_len - index) * sizeof (GstStructureField));
+}
+
+/* the first fields are allocated together with the structure, so that
+ * small structures like the ones of most events and queries only need a
+ * single allocation */
 static GstStructure *
 gst_structure_new_id_empty_with_size (GQuark quark, guint prealloc)
 {
   GstStructureImpl *structure;
+  guint n_inline;
+
+  n_inline = MAX (prealloc, INLINE_FIELDS);
 
-  structure = g_slice_new (GstStructureImpl);
+  structure = g_slice_alloc (GST_STRUCTURE_IMPL_SIZE (n_inline));
   ((GstStructure *) structure)->type = _gst_structure_type;
   ((GstStructure *) structure)->name = quark;
   GST_STRUCTURE_REFCOUNT (structure) = NULL;
-  GST_STRUCTURE_FIELDS (structure) =
-      g_array_sized_new (FALSE, FALSE, sizeof (GstStructureField), prealloc);
+  structure->n_inline = n_inline;
+  structure->fields_len = 0;
+  structure->fields_alloc = n_inline;
+  structure->fields = structure->arr;
+  GST_STRUCTURE_INDEX (structure) = NULL;
 
   GST_TRACE ("created structure %p", structure);
 
@@ -337,7 +409,7 @@ gst_structure_copy (const GstStructure * structure)
 
   g_return_val_if_fail (structure != NULL, NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   new_structure = gst_structure_new_id_empty_with_size (structure->name, len);
 
   for (i = 0; i < len; i++) {
@@ -347,7 +419,7 @@ gst_structure_copy (const GstStructure * structure)
 
     new_field.name = field->name;
     gst_value_init_and_copy (&new_field.value, &field->value);
-    g_array_append_val (GST_STRUCTURE_FIELDS (new_structure), new_field);
+    gst_structure_append_field (new_structure, &new_field);
   }
   GST_CAT_TRACE (GST_CAT_PERFORMANCE, "doing copy %p -> %p",
       structure, new_structure);
@@ -371,7 +443,7 @@ gst_structure_free (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (GST_STRUCTURE_REFCOUNT (structure) == NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
@@ -379,13 +451,16 @@ gst_structure_free (GstStructure * structure)
       g_value_unset (&field->value);
     }
   }
-  g_array_free (GST_STRUCTURE_FIELDS (structure), TRUE);
+  if (!GST_STRUCTURE_FIELDS_INLINED (structure))
+    g_free (GST_STRUCTURE_FIELDS (structure));
+  g_free (GST_STRUCTURE_INDEX (structure));
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
 #endif
   GST_TRACE ("free structure %p", structure);
 
-  g_slice_free1 (sizeof (GstStructureImpl), structure);
+  g_slice_free1 (GST_STRUCTURE_IMPL_SIZE (((GstStructureImpl *)
+              structure)->n_inline), structure);
 }
 
 /**
@@ -757,6 +832,93 @@ gst_structure_new_id (GQuark name_quark, GQuark field_quark, ...)
   return s;
 }
 
+#define INDEX_HASH(q) (((guint) (q) * 0x9e3779b1u) >> 7)
+
+/* insert the field at @pos, the index must have free slots */
+static inline void
+gst_structure_index_insert (GstStructureIndex * index, GQuark name, guint pos)
+{
+  guint i;
+
+  for (i = INDEX_HASH (name) & index->mask; index->slots[i];
+      i = (i + 1) & index->mask);
+  index->slots[i] = pos + 1;
+}
+
+static GstStructureIndex *
+gst_structure_index_new (const GstStructure * structure)
+{
+  GstStructureIndex *index;
+  guint i, size, len;
+
+  len = GST_STRUCTURE_LEN (structure);
+
+  /* keep the load factor below 1/2 */
+  for (size = 32; size < 2 * len; size <<= 1);
+
+  index = g_malloc0 (sizeof (GstStructureIndex) + (size - 1) *
+      sizeof (guint32));
+  index->mask = size - 1;
+  for (i = 0; i < len; i++)
+    gst_structure_index_insert (index, GST_STRUCTURE_FIELD (structure,
+            i)->name, i);
+
+  return index;
+}
+
+/* called after the fields array changed in a way that invalidates the
+ * positions in the index. The structure is mutable, so nobody else can be
+ * looking at the index. */
+static inline void
+gst_structure_index_clear (GstStructure * structure)
+{
+  g_free (GST_STRUCTURE_INDEX (structure));
+  GST_STRUCTURE_INDEX (structure) = NULL;
+}
+
+/* a field was appended at @pos */
+static inline void
+gst_structure_index_append (GstStructure * structure, GQuark name, guint pos)
+{
+  GstStructureIndex *index = GST_STRUCTURE_INDEX (structure);
+
+  if (index == NULL)
+    return;
+
+  if (2 * (pos + 1) > index->mask + 1)
+    gst_structure_index_clear (structure);
+  else
+    gst_structure_index_insert (index, name, pos);
+}
+
+static GstStructureField *
+gst_structure_index_lookup (const GstStructure * structure, GQuark field_id)
+{
+  GstStructureIndex *index;
+  guint i, pos;
+
+  index = g_atomic_pointer_get (&GST_STRUCTURE_INDEX (structure));
+  if (G_UNLIKELY (index == NULL)) {
+    /* lookups can happen concurrently on a structure that is not mutable,
+     * publish the new index atomically and keep the one that won */
+    index = gst_structure_index_new (structure);
+    if (!g_atomic_pointer_compare_and_exchange (&GST_STRUCTURE_INDEX
+            (structure), NULL, index)) {
+      g_free (index);
+      index = g_atomic_pointer_get (&GST_STRUCTURE_INDEX (structure));
+    }
+  }
+
+  for (i = INDEX_HASH (field_id) & index->mask; (pos = index->slots[i]);
+      i = (i + 1) & index->mask) {
+    GstStructureField *field = GST_STRUCTURE_FIELD (structure, pos - 1);
+
+    if (field->name == field_id)
+      return field;
+  }
+  return NULL;
+}
+
 #if GST_VERSION_NANO == 1
 #define GIT_G_WARNING g_warning
 #else
@@ -771,7 +933,7 @@ static void
 gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
-  guint i, len = GST_STRUCTURE_FIELDS (structure)->len;
+  guint i, len = GST_STRUCTURE_LEN (structure);
 
   if (G_UNLIKELY (G_VALUE_HOLDS_STRING (&field->value))) {
     const gchar *s;
@@ -821,17 +983,15 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (G_UNLIKELY (f != NULL)) {
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
-  g_array_append_val (GST_STRUCTURE_FIELDS (structure), *field);
+  gst_structure_append_field (structure, field);
+  gst_structure_index_append (structure, field->name, len);
 }
 
 /* If there is no field with the given ID, NULL is returned.
@@ -842,7 +1002,10 @@ gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
   GstStructureField *field;
   guint i, len;
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
+
+  if (len >= INDEX_MIN_FIELDS)
+    return gst_structure_index_lookup (structure, field_id);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -929,27 +1092,25 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
 {
   GstStructureField *field;
   GQuark id;
-  guint i, len;
+  guint i;
 
   g_return_if_fail (structure != NULL);
   g_return_if_fail (fieldname != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
   id = g_quark_from_string (fieldname);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
 
-  for (i = 0; i < len; i++) {
-    field = GST_STRUCTURE_FIELD (structure, i);
+  field = gst_structure_id_get_field (structure, id);
+  if (field == NULL)
+    return;
 
-    if (field->name == id) {
-      if (G_IS_VALUE (&field->value)) {
-        g_value_unset (&field->value);
-      }
-      GST_STRUCTURE_FIELDS (structure) =
-          g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
-      return;
-    }
+  if (G_IS_VALUE (&field->value)) {
+    g_value_unset (&field->value);
   }
+  /* removing shifts the following fields, keep them in insertion order */
+  i = field - GST_STRUCTURE_FIELD (structure, 0);
+  gst_structure_remove_field_index (structure, i);
+  gst_structure_index_clear (structure);
 }
 
 /**
@@ -1015,15 +1176,15 @@ gst_structure_remove_all_fields (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
-  for (i = GST_STRUCTURE_FIELDS (structure)->len - 1; i >= 0; i--) {
+  for (i = GST_STRUCTURE_LEN (structure) - 1; i >= 0; i--) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
     if (G_IS_VALUE (&field->value)) {
       g_value_unset (&field->value);
     }
-    GST_STRUCTURE_FIELDS (structure) =
-        g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
   }
+  GST_STRUCTURE_LEN (structure) = 0;
+  gst_structure_index_clear (structure);
 }
 
 /**
@@ -1066,7 +1227,7 @@ gst_structure_n_fields (const GstStructure * structure)
 {
   g_return_val_if_fail (structure != NULL, 0);
 
-  return GST_STRUCTURE_FIELDS (structure)->len;
+  return GST_STRUCTURE_LEN (structure);
 }
 
 /**
@@ -1084,7 +1245,7 @@ gst_structure_nth_field_name (const GstStructure * structure, guint index)
   GstStructureField *field;
 
   g_return_val_if_fail (structure != NULL, NULL);
-  g_return_val_if_fail (index < GST_STRUCTURE_FIELDS (structure)->len, NULL);
+  g_return_val_if_fail (index < GST_STRUCTURE_LEN (structure), NULL);
 
   field = GST_STRUCTURE_FIELD (structure, index);
 
@@ -1114,7 +1275,7 @@ gst_structure_foreach (const GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1151,7 +1312,7 @@ gst_structure_map_in_place (GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (IS_MUTABLE (structure), FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1781,7 +1942,7 @@ priv_gst_structure_append_to_gstring (const GstStructure * structure,
 
   g_return_val_if_fail (s != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     char *t;
     GType type;
@@ -2136,6 +2297,148 @@ gst_structure_parse_field (gchar * str,
   return TRUE;
 }
 
+/* Parses a plain decimal number without leading zeroes, which is how
+ * integers and fractions are written almost everywhere. Anything else,
+ * including hex and octal notation, is left to gst_value_deserialize(). */
+static gboolean
+gst_structure_parse_decimal (const gchar * s, const gchar ** end, gint * val)
+{
+  gboolean negative = FALSE;
+  gint64 v = 0;
+  gint digits = 0;
+
+  if (*s == '-') {
+    negative = TRUE;
+    s++;
+  }
+  if (*s == '0' && g_ascii_isalnum (s[1]))
+    return FALSE;
+
+  while (g_ascii_isdigit (*s)) {
+    /* more than 10 digits never fit in a gint */
+    if (++digits > 10)
+      return FALSE;
+    v = v * 10 + (*s - '0');
+    s++;
+  }
+  if (digits == 0)
+    return FALSE;
+
+  if (negative)
+    v = -v;
+  if (v < G_MININT || v > G_MAXINT)
+    return FALSE;
+
+  *val = v;
+  *end = s;
+  return TRUE;
+}
+
+static gboolean
+gst_structure_parse_boolean (const gchar * s, gboolean * val)
+{
+  if (g_ascii_strcasecmp (s, "true") == 0 || g_ascii_strcasecmp (s, "yes") == 0
+      || g_ascii_strcasecmp (s, "t") == 0) {
+    *val = TRUE;
+    return TRUE;
+  }
+  if (g_ascii_strcasecmp (s, "false") == 0 || g_ascii_strcasecmp (s, "no") == 0
+      || g_ascii_strcasecmp (s, "f") == 0) {
+    *val = FALSE;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* Words that gst_value_deserialize() turns into a number */
+static gboolean
+gst_structure_is_numeric_word (const gchar * s)
+{
+  return g_ascii_strcasecmp (s, "min") == 0 ||
+      g_ascii_strcasecmp (s, "max") == 0 ||
+      g_ascii_strcasecmp (s, "little_endian") == 0 ||
+      g_ascii_strcasecmp (s, "big_endian") == 0 ||
+      g_ascii_strcasecmp (s, "byte_order") == 0 ||
+      g_ascii_strncasecmp (s, "inf", 3) == 0 ||
+      g_ascii_strncasecmp (s, "nan", 3) == 0;
+}
+
+/* Deserializes the most common values in caps strings without going through
+ * gst_value_deserialize(), which for values without a type means trying
+ * every candidate type in turn. @value is uninitialized and is only
+ * initialized when TRUE is returned. For untyped values the result must be
+ * the same as the first type in the try_types list of
+ * gst_structure_parse_value() that accepts the string. */
+static gboolean
+gst_structure_parse_value_fast (const gchar * s, GType type, GValue * value)
+{
+  const gchar *end;
+  gboolean b;
+  gint num, den;
+
+  if (type == G_TYPE_INVALID) {
+    if (gst_structure_parse_decimal (s, &end, &num)) {
+      if (*end == '\0') {
+        g_value_init (value, G_TYPE_INT);
+        g_value_set_int (value, num);
+        return TRUE;
+      }
+      if (*end == '/' && gst_structure_parse_decimal (end + 1, &end, &den)
+          && *end == '\0' && den != 0) {
+        g_value_init (value, GST_TYPE_FRACTION);
+        gst_value_set_fraction (value, num, den);
+        return TRUE;
+      }
+      return FALSE;
+    }
+    if (!g_ascii_isalpha (*s) || gst_structure_is_numeric_word (s))
+      return FALSE;
+    if (gst_structure_parse_boolean (s, &b)) {
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, b);
+      return TRUE;
+    }
+    /* unquoted strings only contain ASCII, no need to validate them */
+    if (strcmp (s, "NULL") == 0)
+      return FALSE;
+    g_value_init (value, G_TYPE_STRING);
+    g_value_set_string (value, s);
+    return TRUE;
+  } else if (type == G_TYPE_STRING) {
+    if (*s == '"' || strcmp (s, "NULL") == 0)
+      return FALSE;
+    g_value_init (value, G_TYPE_STRING);
+    g_value_set_string (value, s);
+    return TRUE;
+  } else if (type == G_TYPE_INT) {
+    if (!gst_structure_parse_decimal (s, &end, &num) || *end != '\0')
+      return FALSE;
+    g_value_init (value, G_TYPE_INT);
+    g_value_set_int (value, num);
+    return TRUE;
+  } else if (type == GST_TYPE_FRACTION) {
+    if (!gst_structure_parse_decimal (s, &end, &num))
+      return FALSE;
+    den = 1;
+    if (*end == '/' && (!gst_structure_parse_decimal (end + 1, &end, &den)
+            || den == 0))
+      return FALSE;
+    if (*end != '\0')
+      return FALSE;
+    g_value_init (value, GST_TYPE_FRACTION);
+    gst_value_set_fraction (value, num, den);
+    return TRUE;
+  } else if (type == G_TYPE_BOOLEAN) {
+    if (!gst_structure_parse_boolean (s, &b))
+      return FALSE;
+    g_value_init (value, G_TYPE_BOOLEAN);
+    g_value_set_boolean (value, b);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 static gboolean
 gst_structure_parse_value (gchar * str,
     gchar ** after, GValue * value, GType default_type)
@@ -2199,6 +2502,7 @@ gst_structure_parse_value (gchar * str,
           { G_TYPE_INT, G_TYPE_DOUBLE, GST_TYPE_FRACTION, G_TYPE_BOOLEAN,
         G_TYPE_STRING
       };
+      gboolean quoted = (*s == '"');
       int i;
 
       if (G_UNLIKELY (!gst_structure_parse_string (s, &value_end, &s, TRUE)))
@@ -2207,16 +2511,20 @@ gst_structure_parse_value (gchar * str,
       c = *value_end;
       *value_end = '\0';
 
-      for (i = 0; i < G_N_ELEMENTS (try_types); i++) {
-        g_value_init (value, try_types[i]);
-        ret = gst_value_deserialize (value, value_s);
-        if (ret)
-          break;
-        g_value_unset (value);
+      /* quoted values can still turn out to be numbers, leave those to the
+       * generic code */
+      if (!quoted && gst_structure_parse_value_fast (value_s, type, value)) {
+        ret = TRUE;
+      } else {
+        for (i = 0; i < G_N_ELEMENTS (try_types); i++) {
+          g_value_init (value, try_types[i]);
+          ret = gst_value_deserialize (value, value_s);
+          if (ret)
+            break;
+          g_value_unset (value);
+        }
       }
     } else {
-      g_value_init (value, type);
-
       if (G_UNLIKELY (!gst_structure_parse_string (s, &value_end, &s,
                   (type != G_TYPE_STRING))))
         return FALSE;
@@ -2224,9 +2532,14 @@ gst_structure_parse_value (gchar * str,
       c = *value_end;
       *value_end = '\0';
 
-      ret = gst_value_deserialize (value, value_s);
-      if (G_UNLIKELY (!ret))
-        g_value_unset (value);
+      if (gst_structure_parse_value_fast (value_s, type, value)) {
+        ret = TRUE;
+      } else {
+        g_value_init (value, type);
+        ret = gst_value_deserialize (value, value_s);
+        if (G_UNLIKELY (!ret))
+          g_value_unset (value);
+      }
     }
     *value_end = c;
   }
@@ -2328,6 +2641,54 @@ gst_structure_new_from_string (const gchar * string)
   return gst_structure_from_string (string, NULL);
 }
 
+/**
+ * gst_structure_to_binary:
+ * @structure: a #GstStructure
+ * @size: (out): location for the size of the returned data
+ *
+ * Serializes @structure into a compact binary form that is much faster to
+ * create and parse than the string form. See gst_value_to_binary() for
+ * details. Use gst_structure_from_binary() to turn the data back into a
+ * structure.
+ *
+ * Returns: (transfer full) (array length=size): the serialized data, free
+ *     with g_free(), or %NULL if a field could not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_structure_to_binary (const GstStructure * structure, gsize * size)
+{
+  g_return_val_if_fail (structure != NULL, NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  return _priv_gst_binary_serialize (GST_BINARY_KIND_STRUCTURE, structure,
+      size);
+}
+
+/**
+ * gst_structure_from_binary:
+ * @data: (array length=size): data created with gst_structure_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes a structure created with gst_structure_to_binary().
+ *
+ * Free-function: gst_structure_free
+ *
+ * Returns: (transfer full): a new #GstStructure or %NULL when the data could
+ *     not be parsed.
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_structure_from_binary (const guint8 * data, gsize size)
+{
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  return _priv_gst_binary_deserialize (GST_BINARY_KIND_STRUCTURE, data, size,
+      NULL);
+}
+
 /**
  * gst_structure_from_string:
  * @string: a string representation of a #GstStructure.
@@ -3050,8 +3411,8 @@ gst_structure_is_equal (const GstStructure * structure1,
   if (structure1->name != structure2->name) {
     return FALSE;
   }
-  if (GST_STRUCTURE_FIELDS (structure1)->len !=
-      GST_STRUCTURE_FIELDS (structure2)->len) {
+  if (GST_STRUCTURE_LEN (structure1) !=
+      GST_STRUCTURE_LEN (structure2)) {
     return FALSE;
   }
 
@@ -3059,6 +3420,40 @@ gst_structure_is_equal (const GstStructure * structure1,
       (gpointer) structure2);
 }
 
+/**
+ * gst_structure_hash:
+ * @structure: a #GstStructure
+ *
+ * Calculates a hash value for @structure from its name and the names and
+ * values of its fields. The order of the fields does not influence the
+ * result, structures for which gst_structure_is_equal() returns %TRUE have
+ * the same hash. See also gst_value_hash().
+ *
+ * Returns: the hash of @structure
+ *
+ * Since: 1.2
+ */
+guint
+gst_structure_hash (const GstStructure * structure)
+{
+  GstStructureField *field;
+  guint i, len, h, fields = 0;
+
+  g_return_val_if_fail (structure != NULL, 0);
+
+  h = g_str_hash (g_quark_to_string (structure->name));
+
+  len = GST_STRUCTURE_LEN (structure);
+  for (i = 0; i < len; i++) {
+    field = GST_STRUCTURE_FIELD (structure, i);
+    /* sum up the fields so that their order does not matter */
+    fields += g_str_hash (g_quark_to_string (field->name)) * 31 +
+        gst_value_hash (&field->value);
+  }
+
+  return (h * 31 + fields) * 31 + len;
+}
+
 
 typedef struct
 {
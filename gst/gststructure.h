@@ -264,6 +264,12 @@ gchar *               gst_structure_to_string    (const GstStructure * structure
 GstStructure *        gst_structure_from_string  (const gchar * string,
                                                   gchar      ** end) G_GNUC_MALLOC;
 
+guint8 *              gst_structure_to_binary    (const GstStructure * structure,
+                                                  gsize              * size) G_GNUC_MALLOC;
+
+GstStructure *        gst_structure_from_binary  (const guint8 * data,
+                                                  gsize          size) G_GNUC_MALLOC;
+
 gboolean              gst_structure_fixate_field_nearest_int      (GstStructure * structure,
                                                                    const char   * field_name,
                                                                    int            target);
@@ -293,6 +299,8 @@ void                  gst_structure_fixate        (GstStructure * structure);
 gboolean              gst_structure_is_equal      (const GstStructure * structure1,
                                                    const GstStructure * structure2);
 
+guint                 gst_structure_hash          (const GstStructure * structure);
+
 gboolean              gst_structure_is_subset     (const GstStructure * subset,
                                                    const GstStructure * superset);
 
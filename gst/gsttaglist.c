@@ -876,6 +876,61 @@ gst_tag_list_new_from_string (const gchar * str)
   return tag_list;
 }
 
+/**
+ * gst_tag_list_to_binary:
+ * @list: a #GstTagList
+ * @size: (out): location for the size of the returned data
+ *
+ * Serializes a tag list into a compact binary form, see
+ * gst_value_to_binary(). Like the string form, the scope of the tag list is
+ * not serialized.
+ *
+ * Returns: (transfer full) (array length=size): the serialized data, free
+ *     with g_free(), or %NULL in case of an error.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_tag_list_to_binary (const GstTagList * list, gsize * size)
+{
+  g_return_val_if_fail (GST_IS_TAG_LIST (list), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  return _priv_gst_binary_serialize (GST_BINARY_KIND_TAG_LIST,
+      GST_TAG_LIST_STRUCTURE (list), size);
+}
+
+/**
+ * gst_tag_list_new_from_binary:
+ * @data: (array length=size): data created with gst_tag_list_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes a tag list created with gst_tag_list_to_binary().
+ *
+ * Returns: a new #GstTagList, or NULL in case of an error.
+ *
+ * Since: 1.2
+ */
+GstTagList *
+gst_tag_list_new_from_binary (const guint8 * data, gsize size)
+{
+  GstStructure *s;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  s = _priv_gst_binary_deserialize (GST_BINARY_KIND_TAG_LIST, data, size,
+      NULL);
+  if (s == NULL)
+    return NULL;
+
+  if (!gst_structure_has_name (s, "taglist")) {
+    gst_structure_free (s);
+    return NULL;
+  }
+
+  return gst_tag_list_new_internal (s);
+}
+
 /**
  * gst_tag_list_n_tags:
  * @list: A #GstTagList.
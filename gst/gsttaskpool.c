@@ -29,6 +29,10 @@
  *
  * Subclasses can be made to create custom threads.
  *
+ * The threads of the default implementation can be pinned to the CPUs of a
+ * NUMA node with gst_task_pool_set_numa_node(), which is useful together
+ * with buffer pools that allocate memory on the same node.
+ *
  * Last reviewed on 2009-04-23 (0.10.24)
  */
 
@@ -37,9 +41,25 @@
 #include "gstinfo.h"
 #include "gsttaskpool.h"
 
+#ifdef HAVE_SCHED_SETAFFINITY
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (taskpool_debug);
 #define GST_CAT_DEFAULT (taskpool_debug)
 
+#define GST_TASK_POOL_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_TASK_POOL, GstTaskPoolPrivate))
+
+typedef struct _GstTaskPoolPrivate GstTaskPoolPrivate;
+
+struct _GstTaskPoolPrivate
+{
+  gint numa_node;
+};
+
 #ifndef GST_DISABLE_GST_DEBUG
 static void gst_task_pool_finalize (GObject * object);
 #endif
@@ -57,12 +77,109 @@ typedef struct
   gpointer user_data;
 } TaskData;
 
+#ifdef HAVE_SCHED_SETAFFINITY
+typedef struct
+{
+  gint node;
+  cpu_set_t orig_set;
+} ThreadAffinity;
+
+/* the node the current thread is pinned to */
+static GPrivate thread_affinity = G_PRIVATE_INIT (g_free);
+
+static gboolean
+get_node_cpus (gint node, cpu_set_t * set)
+{
+  gchar *filename, *contents, **ranges;
+  gboolean res = FALSE;
+  guint i;
+
+  filename = g_strdup_printf ("/sys/devices/system/node/node%d/cpulist", node);
+  if (!g_file_get_contents (filename, &contents, NULL, NULL))
+    goto done;
+
+  /* the format is a list of ranges like 0-7,16-23 */
+  CPU_ZERO (set);
+  ranges = g_strsplit (g_strstrip (contents), ",", -1);
+  for (i = 0; ranges[i]; i++) {
+    guint first, last, cpu;
+
+    switch (sscanf (ranges[i], "%u-%u", &first, &last)) {
+      case 1:
+        last = first;
+        break;
+      case 2:
+        break;
+      default:
+        continue;
+    }
+    for (cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET (cpu, set);
+      res = TRUE;
+    }
+  }
+  g_strfreev (ranges);
+  g_free (contents);
+
+done:
+  g_free (filename);
+  return res;
+}
+#endif
+
+/* make the current thread run on the CPUs of @node or on its original CPUs
+ * when @node is -1. Threads are shared between pools so we always need to
+ * check the current affinity. */
+static void
+update_thread_affinity (gint node)
+{
+#ifdef HAVE_SCHED_SETAFFINITY
+  ThreadAffinity *affinity;
+  cpu_set_t set;
+
+  affinity = g_private_get (&thread_affinity);
+  if (G_LIKELY (affinity == NULL && node < 0))
+    return;
+
+  if (affinity == NULL) {
+    affinity = g_new (ThreadAffinity, 1);
+    affinity->node = -1;
+    if (sched_getaffinity (0, sizeof (cpu_set_t), &affinity->orig_set) < 0) {
+      g_free (affinity);
+      return;
+    }
+    g_private_set (&thread_affinity, affinity);
+  }
+
+  if (affinity->node == node)
+    return;
+
+  if (node < 0) {
+    set = affinity->orig_set;
+  } else if (!get_node_cpus (node, &set)) {
+    GST_WARNING ("could not get CPUs of NUMA node %d", node);
+    return;
+  }
+
+  if (sched_setaffinity (0, sizeof (cpu_set_t), &set) < 0) {
+    GST_WARNING ("could not pin thread to NUMA node %d: %s", node,
+        g_strerror (errno));
+    return;
+  }
+  GST_DEBUG ("pinned thread %p to NUMA node %d", g_thread_self (), node);
+  affinity->node = node;
+#endif
+}
+
 static void
 default_func (TaskData * tdata, GstTaskPool * pool)
 {
   GstTaskPoolFunction func;
   gpointer user_data;
 
+  update_thread_affinity (g_atomic_int_get (&GST_TASK_POOL_GET_PRIVATE
+          (pool)->numa_node));
+
   func = tdata->func;
   user_data = tdata->user_data;
   g_slice_free (TaskData, tdata);
@@ -128,6 +245,8 @@ gst_task_pool_class_init (GstTaskPoolClass * klass)
   gobject_class = (GObjectClass *) klass;
   gsttaskpool_class = (GstTaskPoolClass *) klass;
 
+  g_type_class_add_private (klass, sizeof (GstTaskPoolPrivate));
+
 #ifndef GST_DISABLE_GST_DEBUG
   gobject_class->finalize = gst_task_pool_finalize;
 #endif
@@ -141,6 +260,7 @@ gst_task_pool_class_init (GstTaskPoolClass * klass)
 static void
 gst_task_pool_init (GstTaskPool * pool)
 {
+  GST_TASK_POOL_GET_PRIVATE (pool)->numa_node = -1;
 }
 
 #ifndef GST_DISABLE_GST_DEBUG
@@ -270,3 +390,48 @@ gst_task_pool_join (GstTaskPool * pool, gpointer id)
   if (klass->join)
     klass->join (pool, id);
 }
+
+/**
+ * gst_task_pool_set_numa_node:
+ * @pool: a #GstTaskPool
+ * @node: a NUMA node or -1
+ *
+ * Pin the threads of @pool to the CPUs of NUMA @node. Tasks pushed
+ * afterwards will run on a thread that is pinned to @node. Use -1 to not
+ * pin the threads, which is the default.
+ *
+ * Only the default implementation honours this setting and only on systems
+ * that support setting the thread affinity.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_task_pool_set_numa_node (GstTaskPool * pool, gint node)
+{
+  g_return_if_fail (GST_IS_TASK_POOL (pool));
+  g_return_if_fail (node >= -1);
+
+  g_atomic_int_set (&GST_TASK_POOL_GET_PRIVATE (pool)->numa_node, node);
+}
+
+/**
+ * gst_task_pool_get_numa_node:
+ * @pool: a #GstTaskPool
+ *
+ * Get the NUMA node the threads of @pool are pinned to.
+ *
+ * Returns: the NUMA node or -1 when the threads are not pinned.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gint
+gst_task_pool_get_numa_node (GstTaskPool * pool)
+{
+  g_return_val_if_fail (GST_IS_TASK_POOL (pool), -1);
+
+  return g_atomic_int_get (&GST_TASK_POOL_GET_PRIVATE (pool)->numa_node);
+}
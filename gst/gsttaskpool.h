@@ -96,6 +96,9 @@ void            gst_task_pool_join        (GstTaskPool *pool, gpointer id);
 
 void		gst_task_pool_cleanup     (GstTaskPool *pool);
 
+void            gst_task_pool_set_numa_node (GstTaskPool *pool, gint node);
+gint            gst_task_pool_get_numa_node (GstTaskPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_TASK_POOL_H__ */
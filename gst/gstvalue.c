@@ -168,6 +168,206 @@ gst_value_hash_add_type (GType type, const GstValueTable * table)
   g_hash_table_insert (gst_value_hash, (gpointer) type, (gpointer) table);
 }
 
+/* The union, intersect and subtract functions are looked up for every pair of
+ * values that is compared during caps negotiation. Instead of scanning the
+ * registered functions, every type that takes part in one of them gets a
+ * small index and the functions are stored in a matrix indexed by the index
+ * of both types. The matrix is rebuilt whenever a function is registered. */
+typedef struct _GstValueDispatchEntry GstValueDispatchEntry;
+struct _GstValueDispatchEntry
+{
+  GstValueUnionFunc union_func;
+  GstValueIntersectFunc intersect_func;
+  GstValueSubtractFunc subtract_func;
+  /* the registered function takes the values in the other order */
+  guint8 union_swap;
+  guint8 intersect_swap;
+};
+
+typedef struct _GstValueDispatch GstValueDispatch;
+struct _GstValueDispatch
+{
+  guint n_types;
+  guint mask;
+  /* open addressed map of type to index, 0 marks an empty slot */
+  GType *types;
+  guint *index;
+  /* n_types * n_types entries */
+  GstValueDispatchEntry *entries;
+};
+
+#define DISPATCH_HASH(type) ((guint) (((type) >> 2) * 0x9E3779B1u))
+
+static GstValueDispatch *gst_value_dispatch;
+
+/* Compare functions of types that are not registered themselves but derive
+ * from a registered type, filled on first use. Lookups only take the read
+ * lock so that concurrent compares don't serialize on it. */
+static GHashTable *gst_value_compare_cache;
+static GRWLock compare_cache_lock;
+
+static inline gint
+gst_value_dispatch_index (const GstValueDispatch * dispatch, GType type)
+{
+  guint slot = DISPATCH_HASH (type) & dispatch->mask;
+
+  while (dispatch->types[slot] != 0) {
+    if (dispatch->types[slot] == type)
+      return dispatch->index[slot];
+    slot = (slot + 1) & dispatch->mask;
+  }
+  return -1;
+}
+
+static inline const GstValueDispatchEntry *
+gst_value_dispatch_lookup (GType type1, GType type2)
+{
+  const GstValueDispatch *dispatch = gst_value_dispatch;
+  gint i1, i2;
+
+  if (G_UNLIKELY (dispatch == NULL))
+    return NULL;
+
+  if ((i1 = gst_value_dispatch_index (dispatch, type1)) < 0)
+    return NULL;
+  if ((i2 = gst_value_dispatch_index (dispatch, type2)) < 0)
+    return NULL;
+
+  return &dispatch->entries[i1 * dispatch->n_types + i2];
+}
+
+static void
+gst_value_dispatch_add_type (GstValueDispatch * dispatch, GType type)
+{
+  guint slot = DISPATCH_HASH (type) & dispatch->mask;
+
+  while (dispatch->types[slot] != 0) {
+    if (dispatch->types[slot] == type)
+      return;
+    slot = (slot + 1) & dispatch->mask;
+  }
+  dispatch->types[slot] = type;
+  dispatch->index[slot] = dispatch->n_types++;
+}
+
+static void
+gst_value_dispatch_free (GstValueDispatch * dispatch)
+{
+  g_free (dispatch->types);
+  g_free (dispatch->index);
+  g_free (dispatch->entries);
+  g_slice_free (GstValueDispatch, dispatch);
+}
+
+/* Not thread-safe, like the registration functions calling it */
+static void
+gst_value_dispatch_rebuild (void)
+{
+  GstValueDispatch *dispatch;
+  GstValueDispatchEntry *entry;
+  guint i, len, max_types, size;
+  gint i1, i2;
+
+  max_types = 2 * (gst_value_union_funcs->len +
+      gst_value_intersect_funcs->len + gst_value_subtract_funcs->len);
+
+  /* keep the map at most half full */
+  size = 8;
+  while (size < 2 * max_types)
+    size <<= 1;
+
+  dispatch = g_slice_new0 (GstValueDispatch);
+  dispatch->mask = size - 1;
+  dispatch->types = g_new0 (GType, size);
+  dispatch->index = g_new0 (guint, size);
+
+  len = gst_value_union_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueUnionInfo *info =
+        &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+
+    gst_value_dispatch_add_type (dispatch, info->type1);
+    gst_value_dispatch_add_type (dispatch, info->type2);
+  }
+  len = gst_value_intersect_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueIntersectInfo *info =
+        &g_array_index (gst_value_intersect_funcs, GstValueIntersectInfo, i);
+
+    gst_value_dispatch_add_type (dispatch, info->type1);
+    gst_value_dispatch_add_type (dispatch, info->type2);
+  }
+  len = gst_value_subtract_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueSubtractInfo *info =
+        &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+
+    gst_value_dispatch_add_type (dispatch, info->minuend);
+    gst_value_dispatch_add_type (dispatch, info->subtrahend);
+  }
+
+  dispatch->entries = g_new0 (GstValueDispatchEntry,
+      dispatch->n_types * dispatch->n_types);
+
+  /* the first registered function that matches wins, in either order */
+  len = gst_value_union_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueUnionInfo *info =
+        &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+
+    i1 = gst_value_dispatch_index (dispatch, info->type1);
+    i2 = gst_value_dispatch_index (dispatch, info->type2);
+
+    entry = &dispatch->entries[i1 * dispatch->n_types + i2];
+    if (entry->union_func == NULL) {
+      entry->union_func = info->func;
+      entry->union_swap = FALSE;
+    }
+    entry = &dispatch->entries[i2 * dispatch->n_types + i1];
+    if (entry->union_func == NULL) {
+      entry->union_func = info->func;
+      entry->union_swap = TRUE;
+    }
+  }
+
+  len = gst_value_intersect_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueIntersectInfo *info =
+        &g_array_index (gst_value_intersect_funcs, GstValueIntersectInfo, i);
+
+    i1 = gst_value_dispatch_index (dispatch, info->type1);
+    i2 = gst_value_dispatch_index (dispatch, info->type2);
+
+    entry = &dispatch->entries[i1 * dispatch->n_types + i2];
+    if (entry->intersect_func == NULL) {
+      entry->intersect_func = info->func;
+      entry->intersect_swap = FALSE;
+    }
+    entry = &dispatch->entries[i2 * dispatch->n_types + i1];
+    if (entry->intersect_func == NULL) {
+      entry->intersect_func = info->func;
+      entry->intersect_swap = TRUE;
+    }
+  }
+
+  len = gst_value_subtract_funcs->len;
+  for (i = 0; i < len; i++) {
+    GstValueSubtractInfo *info =
+        &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+
+    i1 = gst_value_dispatch_index (dispatch, info->minuend);
+    i2 = gst_value_dispatch_index (dispatch, info->subtrahend);
+
+    entry = &dispatch->entries[i1 * dispatch->n_types + i2];
+    if (entry->subtract_func == NULL)
+      entry->subtract_func = info->func;
+  }
+
+  if (gst_value_dispatch)
+    gst_value_dispatch_free (gst_value_dispatch);
+  gst_value_dispatch = dispatch;
+}
+
 /********
  * list *
  ********/
@@ -4328,7 +4528,9 @@ static GstValueCompareFunc
 gst_value_get_compare_func (const GValue * value1)
 {
   GstValueTable *table, *best = NULL;
-  guint i;
+  GstValueCompareFunc compare;
+  gpointer cached;
+  guint i, len;
   GType type1;
 
   type1 = G_VALUE_TYPE (value1);
@@ -4336,23 +4538,36 @@ gst_value_get_compare_func (const GValue * value1)
   /* this is a fast check */
   best = gst_value_hash_lookup_type (type1);
 
-  /* slower checks */
-  if (G_UNLIKELY (!best || !best->compare)) {
-    guint len = gst_value_table->len;
+  if (G_LIKELY (best && best->compare))
+    return best->compare;
 
-    best = NULL;
-    for (i = 0; i < len; i++) {
-      table = &g_array_index (gst_value_table, GstValueTable, i);
-      if (table->compare && g_type_is_a (type1, table->type)) {
-        if (!best || g_type_is_a (table->type, best->type))
-          best = table;
-      }
+  /* derived types are resolved once and then cached */
+  g_rw_lock_reader_lock (&compare_cache_lock);
+  if (g_hash_table_lookup_extended (gst_value_compare_cache,
+          (gpointer) type1, NULL, &cached)) {
+    g_rw_lock_reader_unlock (&compare_cache_lock);
+    return (GstValueCompareFunc) cached;
+  }
+  g_rw_lock_reader_unlock (&compare_cache_lock);
+
+  /* slower checks */
+  best = NULL;
+  len = gst_value_table->len;
+  for (i = 0; i < len; i++) {
+    table = &g_array_index (gst_value_table, GstValueTable, i);
+    if (table->compare && g_type_is_a (type1, table->type)) {
+      if (!best || g_type_is_a (table->type, best->type))
+        best = table;
     }
   }
-  if (G_LIKELY (best))
-    return best->compare;
+  compare = best ? best->compare : NULL;
 
-  return NULL;
+  g_rw_lock_writer_lock (&compare_cache_lock);
+  g_hash_table_insert (gst_value_compare_cache, (gpointer) type1,
+      (gpointer) compare);
+  g_rw_lock_writer_unlock (&compare_cache_lock);
+
+  return compare;
 }
 
 /**
@@ -4514,6 +4729,140 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
   return compare (value1, value2);
 }
 
+#define HASH_MIX(h,v) ((h) * 31 + (guint) (v))
+#define HASH_MIX64(h,v) HASH_MIX (HASH_MIX ((h), (guint64) (v) >> 32), (v))
+
+static guint
+gst_value_hash_double (gdouble d)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } u;
+
+  /* -0.0 and 0.0 compare equal */
+  u.d = (d == 0.0) ? 0.0 : d;
+
+  return HASH_MIX64 (0, u.u);
+}
+
+/**
+ * gst_value_hash:
+ * @value: a #GValue to hash
+ *
+ * Calculates a hash value for @value. Values for which gst_value_compare()
+ * returns %GST_VALUE_EQUAL have the same hash. The hash does not depend on
+ * the memory location of the value or on the process it is calculated in
+ * and can be used for hash tables and caches of values.
+ *
+ * For types for which no specific hash function is known, only the type of
+ * the value is hashed.
+ *
+ * Returns: the hash of @value
+ *
+ * Since: 1.2
+ */
+guint
+gst_value_hash (const GValue * value)
+{
+  GType type;
+  guint h, i, n;
+
+  g_return_val_if_fail (G_IS_VALUE (value), 0);
+
+  type = G_VALUE_TYPE (value);
+
+  if (type == GST_TYPE_LIST) {
+    n = VALUE_LIST_SIZE (value);
+    /* "{ 1 }" is equal to "1" */
+    if (n == 1)
+      return gst_value_hash (VALUE_LIST_GET_VALUE (value, 0));
+    /* lists of integers can be equal to an integer range, only hash the
+     * number of items for them */
+    if (n > 0 && (G_VALUE_HOLDS_INT (VALUE_LIST_GET_VALUE (value, 0)) ||
+            G_VALUE_HOLDS_INT64 (VALUE_LIST_GET_VALUE (value, 0))))
+      return HASH_MIX (G_VALUE_TYPE (VALUE_LIST_GET_VALUE (value, 0)), n);
+    /* lists are unordered */
+    h = 0;
+    for (i = 0; i < n; i++)
+      h += gst_value_hash (VALUE_LIST_GET_VALUE (value, i));
+    return HASH_MIX (h, n);
+  }
+  if (type == GST_TYPE_INT_RANGE) {
+    gint step = gst_value_get_int_range_step (value);
+
+    n = gst_value_get_int_range_max (value) / step -
+        gst_value_get_int_range_min (value) / step + 1;
+    return HASH_MIX (G_TYPE_INT, n);
+  }
+  if (type == GST_TYPE_INT64_RANGE) {
+    gint64 step = gst_value_get_int64_range_step (value);
+
+    n = gst_value_get_int64_range_max (value) / step -
+        gst_value_get_int64_range_min (value) / step + 1;
+    return HASH_MIX (G_TYPE_INT64, n);
+  }
+
+  h = (guint) type;
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      return HASH_MIX (h, value->data[0].v_uint);
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+      return HASH_MIX64 (h, value->data[0].v_ulong);
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+      return HASH_MIX64 (h, value->data[0].v_uint64);
+    case G_TYPE_FLOAT:
+      return HASH_MIX (h, gst_value_hash_double (value->data[0].v_float));
+    case G_TYPE_DOUBLE:
+      return HASH_MIX (h, gst_value_hash_double (value->data[0].v_double));
+    case G_TYPE_STRING:
+      return value->data[0].v_pointer ?
+          HASH_MIX (h, g_str_hash (value->data[0].v_pointer)) : h;
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_ARRAY) {
+    n = VALUE_LIST_SIZE (value);
+    for (i = 0; i < n; i++)
+      h = HASH_MIX (h, gst_value_hash (VALUE_LIST_GET_VALUE (value, i)));
+  } else if (type == GST_TYPE_FRACTION) {
+    /* fractions are always stored reduced */
+    h = HASH_MIX (h, value->data[0].v_int);
+    h = HASH_MIX (h, value->data[1].v_int);
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    h = HASH_MIX (h,
+        gst_value_hash_double (gst_value_get_double_range_min (value)));
+    h = HASH_MIX (h,
+        gst_value_hash_double (gst_value_get_double_range_max (value)));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    h = HASH_MIX (h, gst_value_hash (gst_value_get_fraction_range_min (value)));
+    h = HASH_MIX (h, gst_value_hash (gst_value_get_fraction_range_max (value)));
+  } else if (type == GST_TYPE_BITMASK) {
+    h = HASH_MIX64 (h, gst_value_get_bitmask (value));
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    if (s)
+      h = HASH_MIX (h, gst_structure_hash (s));
+  }
+
+  return h;
+}
+
+#undef HASH_MIX
+#undef HASH_MIX64
+
 /* union */
 
 /**
@@ -4535,25 +4884,15 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 gboolean
 gst_value_can_union (const GValue * value1, const GValue * value2)
 {
-  GstValueUnionInfo *union_info;
-  guint i, len;
+  const GstValueDispatchEntry *entry;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
-  len = gst_value_union_funcs->len;
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == G_VALUE_TYPE (value1) &&
-        union_info->type2 == G_VALUE_TYPE (value2))
-      return TRUE;
-    if (union_info->type1 == G_VALUE_TYPE (value2) &&
-        union_info->type2 == G_VALUE_TYPE (value1))
-      return TRUE;
-  }
+  entry = gst_value_dispatch_lookup (G_VALUE_TYPE (value1),
+      G_VALUE_TYPE (value2));
 
-  return FALSE;
+  return entry != NULL && entry->union_func != NULL;
 }
 
 /**
@@ -4569,9 +4908,7 @@ gst_value_can_union (const GValue * value1, const GValue * value2)
 gboolean
 gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 {
-  const GstValueUnionInfo *union_info;
-  guint i, len;
-  GType type1, type2;
+  const GstValueDispatchEntry *entry;
 
   g_return_val_if_fail (dest != NULL, FALSE);
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4579,18 +4916,13 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
   g_return_val_if_fail (gst_value_list_or_array_are_compatible (value1, value2),
       FALSE);
 
-  len = gst_value_union_funcs->len;
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
+  entry = gst_value_dispatch_lookup (G_VALUE_TYPE (value1),
+      G_VALUE_TYPE (value2));
 
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == type1 && union_info->type2 == type2) {
-      return union_info->func (dest, value1, value2);
-    }
-    if (union_info->type1 == type2 && union_info->type2 == type1) {
-      return union_info->func (dest, value2, value1);
-    }
+  if (entry && entry->union_func) {
+    if (entry->union_swap)
+      return entry->union_func (dest, value2, value1);
+    return entry->union_func (dest, value1, value2);
   }
 
   gst_value_list_concat (dest, value1, value2);
@@ -4619,6 +4951,7 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
   union_info.func = func;
 
   g_array_append_val (gst_value_union_funcs, union_info);
+  gst_value_dispatch_rebuild ();
 }
 
 /* intersection */
@@ -4638,8 +4971,7 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 gboolean
 gst_value_can_intersect (const GValue * value1, const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
+  const GstValueDispatchEntry *entry;
   GType ltype, type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4660,14 +4992,9 @@ gst_value_can_intersect (const GValue * value1, const GValue * value2)
     return TRUE;
 
   /* check registered intersect functions */
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if ((intersect_info->type1 == type1 && intersect_info->type2 == type2) ||
-        (intersect_info->type1 == type2 && intersect_info->type2 == type1))
-      return TRUE;
-  }
+  entry = gst_value_dispatch_lookup (type1, type2);
+  if (entry && entry->intersect_func)
+    return TRUE;
 
   return gst_value_can_compare (value1, value2);
 }
@@ -4690,9 +5017,8 @@ gboolean
 gst_value_intersect (GValue * dest, const GValue * value1,
     const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
-  GType ltype, type1, type2;
+  const GstValueDispatchEntry *entry;
+  GType ltype;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
@@ -4711,19 +5037,13 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     return TRUE;
   }
 
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
+  entry = gst_value_dispatch_lookup (G_VALUE_TYPE (value1),
+      G_VALUE_TYPE (value2));
 
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
-      return intersect_info->func (dest, value1, value2);
-    }
-    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
-      return intersect_info->func (dest, value2, value1);
-    }
+  if (entry && entry->intersect_func) {
+    if (entry->intersect_swap)
+      return entry->intersect_func (dest, value2, value1);
+    return entry->intersect_func (dest, value1, value2);
   }
   return FALSE;
 }
@@ -4754,6 +5074,7 @@ gst_value_register_intersect_func (GType type1, GType type2,
   intersect_info.func = func;
 
   g_array_append_val (gst_value_intersect_funcs, intersect_info);
+  gst_value_dispatch_rebuild ();
 }
 
 
@@ -4776,9 +5097,8 @@ gboolean
 gst_value_subtract (GValue * dest, const GValue * minuend,
     const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
-  GType ltype, mtype, stype;
+  const GstValueDispatchEntry *entry;
+  GType ltype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
   g_return_val_if_fail (G_IS_VALUE (subtrahend), FALSE);
@@ -4791,16 +5111,11 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
   if (G_VALUE_HOLDS (subtrahend, ltype))
     return gst_value_subtract_list (dest, minuend, subtrahend);
 
-  mtype = G_VALUE_TYPE (minuend);
-  stype = G_VALUE_TYPE (subtrahend);
+  entry = gst_value_dispatch_lookup (G_VALUE_TYPE (minuend),
+      G_VALUE_TYPE (subtrahend));
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype) {
-      return info->func (dest, minuend, subtrahend);
-    }
-  }
+  if (entry && entry->subtract_func)
+    return entry->subtract_func (dest, minuend, subtrahend);
 
   if (gst_value_compare (minuend, subtrahend) != GST_VALUE_EQUAL) {
     if (dest)
@@ -4837,9 +5152,8 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
 gboolean
 gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
-  GType ltype, mtype, stype;
+  const GstValueDispatchEntry *entry;
+  GType ltype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
   g_return_val_if_fail (G_IS_VALUE (subtrahend), FALSE);
@@ -4850,15 +5164,10 @@ gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
   if (G_VALUE_HOLDS (minuend, ltype) || G_VALUE_HOLDS (subtrahend, ltype))
     return TRUE;
 
-  mtype = G_VALUE_TYPE (minuend);
-  stype = G_VALUE_TYPE (subtrahend);
-
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype)
-      return TRUE;
-  }
+  entry = gst_value_dispatch_lookup (G_VALUE_TYPE (minuend),
+      G_VALUE_TYPE (subtrahend));
+  if (entry && entry->subtract_func)
+    return TRUE;
 
   return gst_value_can_compare (minuend, subtrahend);
 }
@@ -4889,6 +5198,7 @@ gst_value_register_subtract_func (GType minuend_type, GType subtrahend_type,
   info.func = func;
 
   g_array_append_val (gst_value_subtract_funcs, info);
+  gst_value_dispatch_rebuild ();
 }
 
 /**
@@ -4914,6 +5224,11 @@ gst_value_register (const GstValueTable * table)
   /* FIXME: we're not really doing the const justice, we assume the table is
    * static */
   gst_value_hash_add_type (table->type, table);
+
+  /* derived types might now resolve to the new table */
+  g_rw_lock_writer_lock (&compare_cache_lock);
+  g_hash_table_remove_all (gst_value_compare_cache);
+  g_rw_lock_writer_unlock (&compare_cache_lock);
 }
 
 /**
@@ -5037,6 +5352,943 @@ gst_value_deserialize (GValue * dest, const gchar * src)
   return FALSE;
 }
 
+/*************************
+ * binary serialization *
+ *************************/
+
+/* Binary form of values, structures, caps and tag lists. All data starts
+ * with a header of two magic bytes, the format version and the kind of the
+ * serialized object. Integers are stored as LEB128 varints (zigzag encoded
+ * when signed), floating point values as little endian IEEE 754 and strings
+ * as their length + 1 followed by the bytes, 0 for a NULL string. */
+#define BINARY_MAGIC_0 'G'
+#define BINARY_MAGIC_1 'B'
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 4
+
+/* maximum nesting of lists, arrays, structures and caps */
+#define BINARY_MAX_DEPTH 32
+
+enum
+{
+  BINARY_TYPE_BOOLEAN = 1,
+  BINARY_TYPE_CHAR,
+  BINARY_TYPE_UCHAR,
+  BINARY_TYPE_INT,
+  BINARY_TYPE_UINT,
+  BINARY_TYPE_LONG,
+  BINARY_TYPE_ULONG,
+  BINARY_TYPE_INT64,
+  BINARY_TYPE_UINT64,
+  BINARY_TYPE_FLOAT,
+  BINARY_TYPE_DOUBLE,
+  BINARY_TYPE_STRING,
+  BINARY_TYPE_ENUM,
+  BINARY_TYPE_FLAGS,
+  BINARY_TYPE_FRACTION,
+  BINARY_TYPE_INT_RANGE,
+  BINARY_TYPE_INT64_RANGE,
+  BINARY_TYPE_DOUBLE_RANGE,
+  BINARY_TYPE_FRACTION_RANGE,
+  BINARY_TYPE_BITMASK,
+  BINARY_TYPE_LIST,
+  BINARY_TYPE_ARRAY,
+  BINARY_TYPE_STRUCTURE,
+  BINARY_TYPE_CAPS,
+  BINARY_TYPE_CAPS_FEATURES,
+  /* any other type, stored as type name and gst_value_serialize() string */
+  BINARY_TYPE_OTHER
+};
+
+/* writing */
+
+static void
+binary_write_uint (GByteArray * a, guint64 v)
+{
+  guint8 buf[10];
+  guint n = 0;
+
+  do {
+    buf[n] = v & 0x7f;
+    v >>= 7;
+    if (v)
+      buf[n] |= 0x80;
+    n++;
+  } while (v);
+
+  g_byte_array_append (a, buf, n);
+}
+
+static inline void
+binary_write_int (GByteArray * a, gint64 v)
+{
+  binary_write_uint (a, ((guint64) v << 1) ^ (guint64) (v >> 63));
+}
+
+static inline void
+binary_write_byte (GByteArray * a, guint8 v)
+{
+  g_byte_array_append (a, &v, 1);
+}
+
+static void
+binary_write_double (GByteArray * a, gdouble d)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } u;
+
+  u.d = d;
+  u.u = GUINT64_TO_LE (u.u);
+  g_byte_array_append (a, (const guint8 *) &u.u, 8);
+}
+
+static void
+binary_write_string (GByteArray * a, const gchar * s)
+{
+  gsize len;
+
+  if (s == NULL) {
+    binary_write_uint (a, 0);
+    return;
+  }
+  len = strlen (s);
+  binary_write_uint (a, len + 1);
+  g_byte_array_append (a, (const guint8 *) s, len);
+}
+
+static void
+binary_write_features (GByteArray * a, const GstCapsFeatures * features)
+{
+  guint i, n;
+
+  /* 0 for no features, 1 for ANY, 2 for a list of features */
+  if (features == NULL) {
+    binary_write_byte (a, 0);
+  } else if (gst_caps_features_is_any (features)) {
+    binary_write_byte (a, 1);
+  } else {
+    binary_write_byte (a, 2);
+    n = gst_caps_features_get_size (features);
+    binary_write_uint (a, n);
+    for (i = 0; i < n; i++)
+      binary_write_string (a, gst_caps_features_get_nth (features, i));
+  }
+}
+
+static gboolean binary_write_structure (GByteArray * a,
+    const GstStructure * structure);
+static gboolean binary_write_caps (GByteArray * a, const GstCaps * caps);
+
+static gboolean
+binary_write_value (GByteArray * a, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint i, n;
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_BOOLEAN:
+      binary_write_byte (a, BINARY_TYPE_BOOLEAN);
+      binary_write_byte (a, g_value_get_boolean (value) ? 1 : 0);
+      return TRUE;
+    case G_TYPE_CHAR:
+      binary_write_byte (a, BINARY_TYPE_CHAR);
+      binary_write_int (a, g_value_get_schar (value));
+      return TRUE;
+    case G_TYPE_UCHAR:
+      binary_write_byte (a, BINARY_TYPE_UCHAR);
+      binary_write_uint (a, g_value_get_uchar (value));
+      return TRUE;
+    case G_TYPE_INT:
+      binary_write_byte (a, BINARY_TYPE_INT);
+      binary_write_int (a, g_value_get_int (value));
+      return TRUE;
+    case G_TYPE_UINT:
+      binary_write_byte (a, BINARY_TYPE_UINT);
+      binary_write_uint (a, g_value_get_uint (value));
+      return TRUE;
+    case G_TYPE_LONG:
+      binary_write_byte (a, BINARY_TYPE_LONG);
+      binary_write_int (a, g_value_get_long (value));
+      return TRUE;
+    case G_TYPE_ULONG:
+      binary_write_byte (a, BINARY_TYPE_ULONG);
+      binary_write_uint (a, g_value_get_ulong (value));
+      return TRUE;
+    case G_TYPE_INT64:
+      binary_write_byte (a, BINARY_TYPE_INT64);
+      binary_write_int (a, g_value_get_int64 (value));
+      return TRUE;
+    case G_TYPE_UINT64:
+      binary_write_byte (a, BINARY_TYPE_UINT64);
+      binary_write_uint (a, g_value_get_uint64 (value));
+      return TRUE;
+    case G_TYPE_FLOAT:
+      binary_write_byte (a, BINARY_TYPE_FLOAT);
+      binary_write_double (a, g_value_get_float (value));
+      return TRUE;
+    case G_TYPE_DOUBLE:
+      binary_write_byte (a, BINARY_TYPE_DOUBLE);
+      binary_write_double (a, g_value_get_double (value));
+      return TRUE;
+    case G_TYPE_STRING:
+      if (type != G_TYPE_STRING)
+        break;
+      binary_write_byte (a, BINARY_TYPE_STRING);
+      binary_write_string (a, g_value_get_string (value));
+      return TRUE;
+    case G_TYPE_ENUM:
+      binary_write_byte (a, BINARY_TYPE_ENUM);
+      binary_write_string (a, g_type_name (type));
+      binary_write_int (a, g_value_get_enum (value));
+      return TRUE;
+    case G_TYPE_FLAGS:
+      binary_write_byte (a, BINARY_TYPE_FLAGS);
+      binary_write_string (a, g_type_name (type));
+      binary_write_uint (a, g_value_get_flags (value));
+      return TRUE;
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_FRACTION) {
+    binary_write_byte (a, BINARY_TYPE_FRACTION);
+    binary_write_int (a, value->data[0].v_int);
+    binary_write_int (a, value->data[1].v_int);
+  } else if (type == GST_TYPE_INT_RANGE) {
+    binary_write_byte (a, BINARY_TYPE_INT_RANGE);
+    binary_write_int (a, gst_value_get_int_range_min (value));
+    binary_write_int (a, gst_value_get_int_range_max (value));
+    binary_write_int (a, gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    binary_write_byte (a, BINARY_TYPE_INT64_RANGE);
+    binary_write_int (a, gst_value_get_int64_range_min (value));
+    binary_write_int (a, gst_value_get_int64_range_max (value));
+    binary_write_int (a, gst_value_get_int64_range_step (value));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    binary_write_byte (a, BINARY_TYPE_DOUBLE_RANGE);
+    binary_write_double (a, gst_value_get_double_range_min (value));
+    binary_write_double (a, gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    binary_write_byte (a, BINARY_TYPE_FRACTION_RANGE);
+    binary_write_int (a, min->data[0].v_int);
+    binary_write_int (a, min->data[1].v_int);
+    binary_write_int (a, max->data[0].v_int);
+    binary_write_int (a, max->data[1].v_int);
+  } else if (type == GST_TYPE_BITMASK) {
+    binary_write_byte (a, BINARY_TYPE_BITMASK);
+    binary_write_uint (a, gst_value_get_bitmask (value));
+  } else if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    binary_write_byte (a, type == GST_TYPE_LIST ? BINARY_TYPE_LIST :
+        BINARY_TYPE_ARRAY);
+    n = VALUE_LIST_SIZE (value);
+    binary_write_uint (a, n);
+    for (i = 0; i < n; i++) {
+      if (!binary_write_value (a, VALUE_LIST_GET_VALUE (value, i)))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    binary_write_byte (a, BINARY_TYPE_STRUCTURE);
+    binary_write_byte (a, s != NULL);
+    if (s && !binary_write_structure (a, s))
+      return FALSE;
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    binary_write_byte (a, BINARY_TYPE_CAPS);
+    binary_write_byte (a, caps != NULL);
+    if (caps && !binary_write_caps (a, caps))
+      return FALSE;
+  } else if (type == GST_TYPE_CAPS_FEATURES) {
+    binary_write_byte (a, BINARY_TYPE_CAPS_FEATURES);
+    binary_write_features (a, gst_value_get_caps_features (value));
+  } else {
+    gchar *str = gst_value_serialize (value);
+
+    if (str == NULL)
+      return FALSE;
+    binary_write_byte (a, BINARY_TYPE_OTHER);
+    binary_write_string (a, g_type_name (type));
+    binary_write_string (a, str);
+    g_free (str);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+binary_write_structure (GByteArray * a, const GstStructure * structure)
+{
+  guint i, n;
+
+  binary_write_string (a, gst_structure_get_name (structure));
+  n = gst_structure_n_fields (structure);
+  binary_write_uint (a, n);
+  for (i = 0; i < n; i++) {
+    const gchar *name = gst_structure_nth_field_name (structure, i);
+
+    binary_write_string (a, name);
+    if (!binary_write_value (a, gst_structure_get_value (structure, name)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean
+binary_write_caps (GByteArray * a, const GstCaps * caps)
+{
+  guint i, n;
+
+  binary_write_byte (a, gst_caps_is_any (caps) ? 1 : 0);
+  n = gst_caps_get_size (caps);
+  binary_write_uint (a, n);
+  for (i = 0; i < n; i++) {
+    if (!binary_write_structure (a, gst_caps_get_structure (caps, i)))
+      return FALSE;
+    binary_write_features (a, gst_caps_get_features (caps, i));
+  }
+  return TRUE;
+}
+
+/* reading */
+
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  guint depth;
+} BinaryReader;
+
+static gboolean
+binary_read_uint (BinaryReader * r, guint64 * v)
+{
+  guint64 res = 0;
+  guint shift = 0;
+  guint8 b;
+
+  do {
+    if (r->size == 0 || shift > 63)
+      return FALSE;
+    b = *r->data++;
+    r->size--;
+    res |= (guint64) (b & 0x7f) << shift;
+    shift += 7;
+  } while (b & 0x80);
+
+  *v = res;
+  return TRUE;
+}
+
+static gboolean
+binary_read_int (BinaryReader * r, gint64 * v)
+{
+  guint64 u;
+
+  if (!binary_read_uint (r, &u))
+    return FALSE;
+
+  *v = (gint64) (u >> 1) ^ -(gint64) (u & 1);
+  return TRUE;
+}
+
+/* read a signed value that must fit in a gint */
+static gboolean
+binary_read_gint (BinaryReader * r, gint * v)
+{
+  gint64 i;
+
+  if (!binary_read_int (r, &i) || i < G_MININT || i > G_MAXINT)
+    return FALSE;
+
+  *v = i;
+  return TRUE;
+}
+
+static gboolean
+binary_read_byte (BinaryReader * r, guint8 * v)
+{
+  if (r->size == 0)
+    return FALSE;
+
+  *v = *r->data++;
+  r->size--;
+  return TRUE;
+}
+
+static gboolean
+binary_read_double (BinaryReader * r, gdouble * d)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } u;
+
+  if (r->size < 8)
+    return FALSE;
+
+  memcpy (&u.u, r->data, 8);
+  u.u = GUINT64_FROM_LE (u.u);
+  *d = u.d;
+  r->data += 8;
+  r->size -= 8;
+  return TRUE;
+}
+
+/* returns a newly allocated string in @s, which can be NULL */
+static gboolean
+binary_read_string (BinaryReader * r, gchar ** s)
+{
+  guint64 len;
+
+  if (!binary_read_uint (r, &len) || len > r->size + 1)
+    return FALSE;
+
+  if (len == 0) {
+    *s = NULL;
+    return TRUE;
+  }
+  len--;
+  if (!g_utf8_validate ((const gchar *) r->data, len, NULL))
+    return FALSE;
+
+  *s = g_strndup ((const gchar *) r->data, len);
+  r->data += len;
+  r->size -= len;
+  return TRUE;
+}
+
+/* read a non-NULL string and return its quark, without allocating for
+ * short strings */
+static gboolean
+binary_read_quark (BinaryReader * r, GQuark * q)
+{
+  gchar buf[64];
+  guint64 len;
+
+  if (!binary_read_uint (r, &len) || len == 0 || len > r->size + 1)
+    return FALSE;
+  len--;
+
+  if (!g_utf8_validate ((const gchar *) r->data, len, NULL))
+    return FALSE;
+
+  if (len < sizeof (buf)) {
+    memcpy (buf, r->data, len);
+    buf[len] = '\0';
+    *q = g_quark_from_string (buf);
+  } else {
+    gchar *str = g_strndup ((const gchar *) r->data, len);
+
+    *q = g_quark_from_string (str);
+    g_free (str);
+  }
+  r->data += len;
+  r->size -= len;
+  return TRUE;
+}
+
+static gboolean
+binary_read_type (BinaryReader * r, GType fundamental, GType * type)
+{
+  GQuark name;
+
+  if (!binary_read_quark (r, &name))
+    return FALSE;
+
+  *type = g_type_from_name (g_quark_to_string (name));
+  return *type != 0 && (fundamental == G_TYPE_INVALID ||
+      G_TYPE_FUNDAMENTAL (*type) == fundamental);
+}
+
+static gboolean
+binary_read_features (BinaryReader * r, GstCapsFeatures ** features)
+{
+  guint64 i, n;
+  guint8 kind;
+  GQuark id;
+
+  if (!binary_read_byte (r, &kind))
+    return FALSE;
+
+  switch (kind) {
+    case 0:
+      *features = NULL;
+      return TRUE;
+    case 1:
+      *features = gst_caps_features_new_any ();
+      return TRUE;
+    case 2:
+      if (!binary_read_uint (r, &n) || n > r->size)
+        return FALSE;
+      *features = gst_caps_features_new_empty ();
+      for (i = 0; i < n; i++) {
+        if (!binary_read_quark (r, &id)) {
+          gst_caps_features_free (*features);
+          return FALSE;
+        }
+        gst_caps_features_add_id (*features, id);
+      }
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+static GstStructure *binary_read_structure (BinaryReader * r);
+static GstCaps *binary_read_caps (BinaryReader * r);
+
+/* @value is uninitialized, it is only initialized when TRUE is returned */
+static gboolean
+binary_read_value (BinaryReader * r, GValue * value)
+{
+  guint8 tag, b;
+  guint64 u, i;
+  gint64 v, v2, v3;
+  gint n1, d1, n2, d2;
+  gdouble d, e;
+  gchar *str;
+  GType type;
+
+  if (!binary_read_byte (r, &tag))
+    return FALSE;
+
+  switch (tag) {
+    case BINARY_TYPE_BOOLEAN:
+      if (!binary_read_byte (r, &b) || b > 1)
+        return FALSE;
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, b);
+      break;
+    case BINARY_TYPE_CHAR:
+      if (!binary_read_int (r, &v) || v < G_MININT8 || v > G_MAXINT8)
+        return FALSE;
+      g_value_init (value, G_TYPE_CHAR);
+      g_value_set_schar (value, v);
+      break;
+    case BINARY_TYPE_UCHAR:
+      if (!binary_read_uint (r, &u) || u > G_MAXUINT8)
+        return FALSE;
+      g_value_init (value, G_TYPE_UCHAR);
+      g_value_set_uchar (value, u);
+      break;
+    case BINARY_TYPE_INT:
+      if (!binary_read_gint (r, &n1))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, n1);
+      break;
+    case BINARY_TYPE_UINT:
+      if (!binary_read_uint (r, &u) || u > G_MAXUINT)
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT);
+      g_value_set_uint (value, u);
+      break;
+    case BINARY_TYPE_LONG:
+      if (!binary_read_int (r, &v) || v < G_MINLONG || v > G_MAXLONG)
+        return FALSE;
+      g_value_init (value, G_TYPE_LONG);
+      g_value_set_long (value, v);
+      break;
+    case BINARY_TYPE_ULONG:
+      if (!binary_read_uint (r, &u) || u > G_MAXULONG)
+        return FALSE;
+      g_value_init (value, G_TYPE_ULONG);
+      g_value_set_ulong (value, u);
+      break;
+    case BINARY_TYPE_INT64:
+      if (!binary_read_int (r, &v))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT64);
+      g_value_set_int64 (value, v);
+      break;
+    case BINARY_TYPE_UINT64:
+      if (!binary_read_uint (r, &u))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT64);
+      g_value_set_uint64 (value, u);
+      break;
+    case BINARY_TYPE_FLOAT:
+      if (!binary_read_double (r, &d))
+        return FALSE;
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value, d);
+      break;
+    case BINARY_TYPE_DOUBLE:
+      if (!binary_read_double (r, &d))
+        return FALSE;
+      g_value_init (value, G_TYPE_DOUBLE);
+      g_value_set_double (value, d);
+      break;
+    case BINARY_TYPE_STRING:
+      if (!binary_read_string (r, &str))
+        return FALSE;
+      g_value_init (value, G_TYPE_STRING);
+      g_value_take_string (value, str);
+      break;
+    case BINARY_TYPE_ENUM:
+      if (!binary_read_type (r, G_TYPE_ENUM, &type) ||
+          !binary_read_gint (r, &n1))
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_enum (value, n1);
+      break;
+    case BINARY_TYPE_FLAGS:
+      if (!binary_read_type (r, G_TYPE_FLAGS, &type) ||
+          !binary_read_uint (r, &u) || u > G_MAXUINT)
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_flags (value, u);
+      break;
+    case BINARY_TYPE_FRACTION:
+      if (!binary_read_gint (r, &n1) || !binary_read_gint (r, &d1) ||
+          d1 <= 0 || n1 < -G_MAXINT)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION);
+      gst_value_set_fraction (value, n1, d1);
+      break;
+    case BINARY_TYPE_INT_RANGE:
+      if (!binary_read_int (r, &v) || !binary_read_int (r, &v2) ||
+          !binary_read_int (r, &v3) || v < G_MININT || v2 > G_MAXINT ||
+          v >= v2 || v3 <= 0 || v3 > G_MAXINT || v % v3 || v2 % v3)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (value, v, v2, v3);
+      break;
+    case BINARY_TYPE_INT64_RANGE:
+      if (!binary_read_int (r, &v) || !binary_read_int (r, &v2) ||
+          !binary_read_int (r, &v3) || v >= v2 || v3 <= 0 || v % v3 ||
+          v2 % v3)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT64_RANGE);
+      gst_value_set_int64_range_step (value, v, v2, v3);
+      break;
+    case BINARY_TYPE_DOUBLE_RANGE:
+      if (!binary_read_double (r, &d) || !binary_read_double (r, &e) ||
+          !(d < e))
+        return FALSE;
+      g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (value, d, e);
+      break;
+    case BINARY_TYPE_FRACTION_RANGE:
+      if (!binary_read_gint (r, &n1) || !binary_read_gint (r, &d1) ||
+          !binary_read_gint (r, &n2) || !binary_read_gint (r, &d2) ||
+          d1 <= 0 || d2 <= 0 || n1 < -G_MAXINT || n2 < -G_MAXINT ||
+          gst_util_fraction_compare (n1, d1, n2, d2) >= 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION_RANGE);
+      gst_value_set_fraction_range_full (value, n1, d1, n2, d2);
+      break;
+    case BINARY_TYPE_BITMASK:
+      if (!binary_read_uint (r, &u))
+        return FALSE;
+      g_value_init (value, GST_TYPE_BITMASK);
+      gst_value_set_bitmask (value, u);
+      break;
+    case BINARY_TYPE_LIST:
+    case BINARY_TYPE_ARRAY:{
+      GArray *array;
+
+      /* every item takes at least one byte */
+      if (!binary_read_uint (r, &u) || u > r->size ||
+          r->depth >= BINARY_MAX_DEPTH)
+        return FALSE;
+      g_value_init (value, tag == BINARY_TYPE_LIST ? GST_TYPE_LIST :
+          GST_TYPE_ARRAY);
+      array = value->data[0].v_pointer;
+      r->depth++;
+      for (i = 0; i < u; i++) {
+        GValue item = { 0, };
+
+        if (!binary_read_value (r, &item)) {
+          r->depth--;
+          g_value_unset (value);
+          return FALSE;
+        }
+        g_array_append_val (array, item);
+      }
+      r->depth--;
+      break;
+    }
+    case BINARY_TYPE_STRUCTURE:{
+      GstStructure *s = NULL;
+
+      if (!binary_read_byte (r, &b) || b > 1)
+        return FALSE;
+      if (b && !(s = binary_read_structure (r)))
+        return FALSE;
+      g_value_init (value, GST_TYPE_STRUCTURE);
+      g_value_take_boxed (value, s);
+      break;
+    }
+    case BINARY_TYPE_CAPS:{
+      GstCaps *caps = NULL;
+
+      if (!binary_read_byte (r, &b) || b > 1)
+        return FALSE;
+      if (b && !(caps = binary_read_caps (r)))
+        return FALSE;
+      g_value_init (value, GST_TYPE_CAPS);
+      g_value_take_boxed (value, caps);
+      break;
+    }
+    case BINARY_TYPE_CAPS_FEATURES:{
+      GstCapsFeatures *features;
+
+      if (!binary_read_features (r, &features))
+        return FALSE;
+      g_value_init (value, GST_TYPE_CAPS_FEATURES);
+      g_value_take_boxed (value, features);
+      break;
+    }
+    case BINARY_TYPE_OTHER:
+      if (!binary_read_type (r, G_TYPE_INVALID, &type) ||
+          !G_TYPE_IS_VALUE_TYPE (type) || G_TYPE_IS_ABSTRACT (type) ||
+          !binary_read_string (r, &str))
+        return FALSE;
+      if (str == NULL)
+        return FALSE;
+      g_value_init (value, type);
+      if (!gst_value_deserialize (value, str)) {
+        g_value_unset (value);
+        g_free (str);
+        return FALSE;
+      }
+      g_free (str);
+      break;
+    default:
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GstStructure *
+binary_read_structure (BinaryReader * r)
+{
+  GstStructure *structure;
+  GQuark name, field;
+  guint64 i, n;
+
+  if (r->depth >= BINARY_MAX_DEPTH || !binary_read_quark (r, &name) ||
+      !binary_read_uint (r, &n) || n > r->size)
+    return NULL;
+
+  r->depth++;
+  structure = gst_structure_new_id_empty (name);
+  for (i = 0; i < n; i++) {
+    GValue value = { 0, };
+
+    if (!binary_read_quark (r, &field) || !binary_read_value (r, &value)) {
+      gst_structure_free (structure);
+      structure = NULL;
+      break;
+    }
+    gst_structure_id_take_value (structure, field, &value);
+  }
+  r->depth--;
+
+  return structure;
+}
+
+static GstCaps *
+binary_read_caps (BinaryReader * r)
+{
+  GstCaps *caps;
+  GstStructure *structure;
+  GstCapsFeatures *features;
+  guint64 i, n;
+  guint8 any;
+
+  if (r->depth >= BINARY_MAX_DEPTH || !binary_read_byte (r, &any) || any > 1
+      || !binary_read_uint (r, &n) || n > r->size)
+    return NULL;
+
+  if (any) {
+    if (n != 0)
+      return NULL;
+    return gst_caps_new_any ();
+  }
+
+  r->depth++;
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < n; i++) {
+    if (!(structure = binary_read_structure (r))) {
+      gst_caps_unref (caps);
+      caps = NULL;
+      break;
+    }
+    if (!binary_read_features (r, &features)) {
+      gst_structure_free (structure);
+      gst_caps_unref (caps);
+      caps = NULL;
+      break;
+    }
+    gst_caps_append_structure_full (caps, structure, features);
+  }
+  r->depth--;
+
+  return caps;
+}
+
+/* entry points, also used by GstStructure, GstCaps and GstTagList */
+
+guint8 *
+_priv_gst_binary_serialize (gchar kind, gconstpointer object, gsize * size)
+{
+  GByteArray *a;
+  gboolean res;
+
+  a = g_byte_array_sized_new (64);
+  binary_write_byte (a, BINARY_MAGIC_0);
+  binary_write_byte (a, BINARY_MAGIC_1);
+  binary_write_byte (a, BINARY_VERSION);
+  binary_write_byte (a, kind);
+
+  switch (kind) {
+    case GST_BINARY_KIND_VALUE:
+      res = binary_write_value (a, object);
+      break;
+    case GST_BINARY_KIND_STRUCTURE:
+    case GST_BINARY_KIND_TAG_LIST:
+      res = binary_write_structure (a, object);
+      break;
+    case GST_BINARY_KIND_CAPS:
+      res = binary_write_caps (a, object);
+      break;
+    default:
+      g_assert_not_reached ();
+      res = FALSE;
+      break;
+  }
+
+  if (!res) {
+    g_byte_array_free (a, TRUE);
+    return NULL;
+  }
+
+  if (size)
+    *size = a->len;
+  return g_byte_array_free (a, FALSE);
+}
+
+/* returns the deserialized structure or caps, or TRUE for a value */
+gpointer
+_priv_gst_binary_deserialize (gchar kind, const guint8 * data, gsize size,
+    GValue * value)
+{
+  BinaryReader r;
+  gpointer res = NULL;
+
+  if (size < BINARY_HEADER_SIZE || data[0] != BINARY_MAGIC_0 ||
+      data[1] != BINARY_MAGIC_1 || data[2] != BINARY_VERSION ||
+      data[3] != kind) {
+    GST_WARNING ("no valid binary data of kind '%c'", kind);
+    return NULL;
+  }
+
+  r.data = data + BINARY_HEADER_SIZE;
+  r.size = size - BINARY_HEADER_SIZE;
+  r.depth = 0;
+
+  switch (kind) {
+    case GST_BINARY_KIND_VALUE:
+      if (binary_read_value (&r, value))
+        res = GINT_TO_POINTER (TRUE);
+      break;
+    case GST_BINARY_KIND_STRUCTURE:
+    case GST_BINARY_KIND_TAG_LIST:
+      res = binary_read_structure (&r);
+      break;
+    case GST_BINARY_KIND_CAPS:
+      res = binary_read_caps (&r);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+
+  if (res == NULL) {
+    GST_WARNING ("invalid binary data of kind '%c'", kind);
+  } else if (r.size != 0) {
+    GST_WARNING ("%" G_GSIZE_FORMAT " bytes of trailing binary data", r.size);
+    switch (kind) {
+      case GST_BINARY_KIND_VALUE:
+        g_value_unset (value);
+        break;
+      case GST_BINARY_KIND_STRUCTURE:
+      case GST_BINARY_KIND_TAG_LIST:
+        gst_structure_free (res);
+        break;
+      case GST_BINARY_KIND_CAPS:
+        gst_caps_unref (res);
+        break;
+    }
+    res = NULL;
+  }
+
+  return res;
+}
+
+/**
+ * gst_value_to_binary:
+ * @value: a #GValue to serialize
+ * @size: (out): location for the size of the returned data
+ *
+ * Serializes @value into a compact, versioned binary form that can be
+ * turned back into a value with gst_value_from_binary(). All fundamental
+ * types, the GStreamer value types and structures, caps and caps features
+ * are stored natively; other types are stored as their type name and the
+ * string returned by gst_value_serialize().
+ *
+ * The binary form is much faster to create and to parse than the string
+ * form and does not depend on the locale or the byte order of the machine.
+ *
+ * Returns: (transfer full) (array length=size): the serialized data, free
+ *     with g_free(), or %NULL if @value could not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_value_to_binary (const GValue * value, gsize * size)
+{
+  g_return_val_if_fail (G_IS_VALUE (value), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  return _priv_gst_binary_serialize (GST_BINARY_KIND_VALUE, value, size);
+}
+
+/**
+ * gst_value_from_binary:
+ * @dest: (out caller-allocates): an uninitialized #GValue
+ * @data: (array length=size): data created with gst_value_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes a value created with gst_value_to_binary(). On success @dest
+ * is initialized to the type of the serialized value.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_value_from_binary (GValue * dest, const guint8 * data, gsize size)
+{
+  g_return_val_if_fail (dest != NULL, FALSE);
+  g_return_val_if_fail (!G_IS_VALUE (dest), FALSE);
+  g_return_val_if_fail (data != NULL || size == 0, FALSE);
+
+  return _priv_gst_binary_deserialize (GST_BINARY_KIND_VALUE, data, size,
+      dest) != NULL;
+}
+
 /**
  * gst_value_is_fixed:
  * @value: the #GValue to check
@@ -5970,6 +7222,7 @@ _priv_gst_value_initialize (void)
 {
   gst_value_table = g_array_new (FALSE, FALSE, sizeof (GstValueTable));
   gst_value_hash = g_hash_table_new (NULL, NULL);
+  gst_value_compare_cache = g_hash_table_new (NULL, NULL);
   gst_value_union_funcs = g_array_new (FALSE, FALSE,
       sizeof (GstValueUnionInfo));
   gst_value_intersect_funcs = g_array_new (FALSE, FALSE,
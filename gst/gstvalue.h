@@ -414,6 +414,11 @@ void            gst_value_init_and_copy         (GValue                *dest,
 gchar *         gst_value_serialize             (const GValue          *value) G_GNUC_MALLOC;
 gboolean        gst_value_deserialize           (GValue                *dest,
                                                  const gchar           *src);
+guint8 *        gst_value_to_binary             (const GValue          *value,
+                                                 gsize                 *size) G_GNUC_MALLOC;
+gboolean        gst_value_from_binary           (GValue                *dest,
+                                                 const guint8          *data,
+                                                 gsize                  size);
 
 /* list */
 void            gst_value_list_append_value     (GValue         *value,
@@ -528,6 +533,7 @@ gboolean        gst_value_can_compare           (const GValue   *value1,
                                                  const GValue   *value2);
 gboolean        gst_value_is_subset             (const GValue   *value1,
                                                  const GValue   *value2);
+guint           gst_value_hash                  (const GValue   *value);
 
 /* union */
 gboolean        gst_value_union                 (GValue         *dest,
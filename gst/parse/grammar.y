@@ -719,7 +719,7 @@ linkpart:	reference		      { $$ = $1; }
 
 link:		linkpart LINK linkpart	      { $$ = $1;
 						if ($2) {
-						  $$->caps = gst_caps_from_string ($2);
+						  $$->caps = gst_caps_from_string_cached ($2);
 						  if ($$->caps == NULL)
 						    SET_ERROR (graph->error, GST_PARSE_ERROR_LINK, _("could not parse caps \"%s\""), $2);
 						  gst_parse_strfree ($2);
@@ -1,7 +1,8 @@
 /* GStreamer
  * Copyright (C) 2005 Andy Wingo <wingo@pobox.com>
  *
- * caps.c: benchmark for caps creation and destruction
+ * caps.c: benchmark for caps creation, destruction, normalization and
+ *         simplification
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Library General Public
@@ -24,6 +25,7 @@
 
 
 #define NUM_CAPS 10000
+#define NUM_SIMPLIFY 100
 
 #define AUDIO_FORMATS_ALL " { S8, U8, " \
     "S16LE, S16BE, U16LE, U16BE, " \
@@ -40,6 +42,56 @@
   "rate = (int) [ 1, MAX ], " \
   "channels = (int) [ 1, MAX ]"
 
+#define VIDEO_FORMATS_ALL "{ I420, YV12, YUY2, UYVY, AYUV, RGBx, BGRx, " \
+    "xRGB, xBGR, RGBA, BGRA, ARGB, ABGR, RGB, BGR, Y41B, Y42B, YVYU, " \
+    "Y444, v210, v216, NV12, NV21, GRAY8, GRAY16_BE, GRAY16_LE, v308, " \
+    "RGB16, BGR16, RGB15, BGR15, UYVP, A420, RGB8P, YUV9, YVU9, IYU1, " \
+    "ARGB64, AYUV64, r210, I420_10LE, I420_10BE }"
+
+/* what a decoder with several output memory types typically offers */
+#define VIDEO_DECODER_CAPS \
+  "video/x-raw, format = (string) " VIDEO_FORMATS_ALL ", " \
+  "width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ], " \
+  "framerate = (fraction) { 24/1, 25/1, 30/1, 50/1, 60/1 }; " \
+  "video/x-raw(memory:GLMemory), format = (string) { RGBA, NV12, I420 }, " \
+  "width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ], " \
+  "framerate = (fraction) { 24/1, 25/1, 30/1, 50/1, 60/1 }; " \
+  "video/x-raw(meta:GstVideoGLTextureUploadMeta), " \
+  "format = (string) { RGBA, BGRA }, " \
+  "width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ], " \
+  "framerate = (fraction) { 24/1, 25/1, 30/1, 50/1, 60/1 }"
+
+static void
+bench_simplify (const gchar * desc, GstCaps * caps, guint max_size,
+    guint max_comparisons)
+{
+  GstClockTime start, end, norm_time = 0, simplify_time = 0;
+  GstCaps *tmp;
+  guint n_norm = 0, n_simple = 0;
+  gint i;
+
+  for (i = 0; i < NUM_SIMPLIFY; i++) {
+    start = gst_util_get_timestamp ();
+    tmp = gst_caps_normalize_full (gst_caps_ref (caps), max_size);
+    end = gst_util_get_timestamp ();
+    norm_time += end - start;
+    n_norm = gst_caps_get_size (tmp);
+
+    start = gst_util_get_timestamp ();
+    tmp = gst_caps_simplify_full (tmp, max_comparisons);
+    end = gst_util_get_timestamp ();
+    simplify_time += end - start;
+    n_simple = gst_caps_get_size (tmp);
+
+    gst_caps_unref (tmp);
+  }
+
+  g_print ("%" GST_TIME_FORMAT " - %d normalize (%s, %u structures)\n",
+      GST_TIME_ARGS (norm_time), NUM_SIMPLIFY, desc, n_norm);
+  g_print ("%" GST_TIME_FORMAT " - %d simplify (%s, %u structures)\n",
+      GST_TIME_ARGS (simplify_time), NUM_SIMPLIFY, desc, n_simple);
+}
+
 
 gint
 main (gint argc, gchar * argv[])
@@ -71,5 +123,10 @@ main (gint argc, gchar * argv[])
   g_free (capses);
   gst_caps_unref (protocaps);
 
+  protocaps = gst_caps_from_string (VIDEO_DECODER_CAPS);
+  bench_simplify ("unbounded", protocaps, 0, 0);
+  bench_simplify ("bounded", protocaps, 64, 1000);
+  gst_caps_unref (protocaps);
+
   return 0;
 }
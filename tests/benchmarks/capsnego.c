@@ -26,6 +26,7 @@
  *  -c children: is the number of branches on each level
  *  -f <flavour>: can be a=udio/v=ideo and is conttrolling the kind of elements
  *                that are used.
+ *  -m: enables the caps operation cache and reports its hit/miss counters
  */
 
 #include <gst/gst.h>
@@ -208,6 +209,7 @@ main (gint argc, gchar * argv[])
   gint children = 3;
   gint flavour = FLAVOUR_AUDIO;
   const gchar *flavour_str = "audio";
+  gboolean use_cache = FALSE;
 
   gst_init (&argc, &argv);
 
@@ -238,13 +240,17 @@ main (gint argc, gchar * argv[])
               break;
           }
         }
+      } else if (!strcmp (argv[arg], "-m")) {
+        use_cache = TRUE;
       }
     }
   }
 
+  gst_caps_cache_set_enabled (use_cache);
+
   /* build pipeline */
-  g_print ("building %s pipeline with depth = %d and children = %d\n",
-      flavour_str, depth, children);
+  g_print ("building %s pipeline with depth = %d and children = %d%s\n",
+      flavour_str, depth, children, use_cache ? " (caps cache)" : "");
   start = gst_util_get_timestamp ();
   bin = GST_BIN (gst_pipeline_new ("pipeline"));
   sink = gst_element_factory_make ("fakesink", NULL);
@@ -271,6 +277,14 @@ main (gint argc, gchar * argv[])
   g_print ("%" GST_TIME_FORMAT " reached paused\n",
       GST_TIME_ARGS (end - start));
 
+  if (use_cache) {
+    guint64 hits, misses;
+
+    gst_caps_cache_get_stats (&hits, &misses);
+    g_print ("caps cache: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT
+        " misses\n", hits, misses);
+  }
+
   /* clean up */
 Error:
   gst_element_set_state (GST_ELEMENT (bin), GST_STATE_NULL);
@@ -0,0 +1,146 @@
+/* GStreamer
+ *
+ * gstatomicqueuestress.c: throughput of the GstAtomicQueue variants
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/gstatomicqueue.h>
+
+#define BATCH 16
+
+typedef struct
+{
+  GstAtomicQueue *aq;
+  guint n_items;
+  guint batch;
+  guint64 sum;
+} ThroughputData;
+
+static gpointer
+producer_thread (gpointer user_data)
+{
+  ThroughputData *td = user_data;
+  gpointer data[BATCH];
+  guint i, j, n;
+
+  for (i = 1; i <= td->n_items; i += n) {
+    n = MIN (td->batch, td->n_items - i + 1);
+    for (j = 0; j < n; j++)
+      data[j] = GUINT_TO_POINTER (i + j);
+    if (n == 1) {
+      while (!gst_atomic_queue_try_push (td->aq, data[0]))
+        g_thread_yield ();
+    } else {
+      guint pushed = 0;
+
+      while (pushed < n) {
+        pushed += gst_atomic_queue_push_many (td->aq, data + pushed,
+            n - pushed);
+        if (pushed < n)
+          g_thread_yield ();
+      }
+    }
+  }
+  return NULL;
+}
+
+static gpointer
+consumer_thread (gpointer user_data)
+{
+  ThroughputData *td = user_data;
+  gpointer data[BATCH];
+  guint i, j, n;
+
+  td->sum = 0;
+  for (i = 0; i < td->n_items; i += n) {
+    n = gst_atomic_queue_pop_many (td->aq, data,
+        MIN (td->batch, td->n_items - i));
+    if (n == 0) {
+      g_thread_yield ();
+      continue;
+    }
+    for (j = 0; j < n; j++)
+      td->sum += GPOINTER_TO_UINT (data[j]);
+  }
+  return NULL;
+}
+
+/* move n_items items through a queue from one producer to one consumer */
+static void
+run_throughput (const gchar * name, guint n_items, guint size,
+    GstAtomicQueueFlags flags, guint batch)
+{
+  ThroughputData td;
+  GThread *producer, *consumer;
+  GstClockTime start, elapsed;
+
+  td.aq = gst_atomic_queue_new_full (size, flags);
+  td.n_items = n_items;
+  td.batch = batch;
+
+  start = gst_util_get_timestamp ();
+  consumer = g_thread_new ("consumer", consumer_thread, &td);
+  producer = g_thread_new ("producer", producer_thread, &td);
+  g_thread_join (producer);
+  g_thread_join (consumer);
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (td.sum != ((guint64) n_items * (n_items + 1)) / 2)
+    g_print ("*** %s: lost items\n", name);
+
+  g_print ("*** %-10s batch %2u: %u items in %" GST_TIME_FORMAT
+      " - %.0f items/s\n", name, batch, n_items, GST_TIME_ARGS (elapsed),
+      n_items / (MAX (elapsed, 1) / (gdouble) GST_SECOND));
+
+  gst_atomic_queue_unref (td.aq);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstAtomicQueueFlags spsc = GST_ATOMIC_QUEUE_FLAG_BOUNDED |
+      GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER |
+      GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER;
+  gint n_items;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 2) {
+    g_print ("usage: %s <nitems>\n", argv[0]);
+    exit (-1);
+  }
+
+  n_items = atoi (argv[1]);
+  if (n_items <= 0) {
+    g_print ("number of items must be greater than 0\n");
+    exit (-2);
+  }
+
+  run_throughput ("unbounded", n_items, 32, GST_ATOMIC_QUEUE_FLAG_NONE, 1);
+  run_throughput ("unbounded", n_items, 32, GST_ATOMIC_QUEUE_FLAG_NONE, BATCH);
+  run_throughput ("mpmc ring", n_items, 1024, GST_ATOMIC_QUEUE_FLAG_BOUNDED,
+      1);
+  run_throughput ("mpmc ring", n_items, 1024, GST_ATOMIC_QUEUE_FLAG_BOUNDED,
+      BATCH);
+  run_throughput ("spsc ring", n_items, 1024, spsc, 1);
+  run_throughput ("spsc ring", n_items, 1024, spsc, BATCH);
+
+  return 0;
+}
@@ -23,10 +23,40 @@
 #include "gst/glib-compat-private.h"
 
 #define MAX_THREADS  1000
+#define MAX_METAS    8
 
 static guint64 nbbuffers;
+static guint nbmetas;
+static gboolean reserve;
+static const GstMetaInfo *meta_infos[MAX_METAS];
 static GMutex mutex;
 
+typedef struct
+{
+  GstMeta meta;
+  guint64 data[4];
+} StressMeta;
+
+static void
+register_metas (void)
+{
+  const gchar *tags[] = { NULL };
+  guint i;
+
+  for (i = 0; i < MAX_METAS; i++) {
+    gchar *api, *impl;
+    GType type;
+
+    api = g_strdup_printf ("StressMetaAPI%u", i);
+    impl = g_strdup_printf ("StressMeta%u", i);
+    type = gst_meta_api_type_register (api, tags);
+    meta_infos[i] = gst_meta_register (type, impl, sizeof (StressMeta),
+        NULL, NULL, NULL);
+    g_free (api);
+    g_free (impl);
+  }
+}
+
 
 static void *
 run_test (void *user_data)
@@ -35,6 +65,7 @@ run_test (void *user_data)
   guint64 nb;
   GstBuffer *buf;
   GstClockTime start, end;
+  guint i;
 
   g_mutex_lock (&mutex);
   g_mutex_unlock (&mutex);
@@ -44,7 +75,12 @@ run_test (void *user_data)
   g_assert (nbbuffers > 0);
 
   for (nb = nbbuffers; nb; nb--) {
-    buf = gst_buffer_new ();
+    if (reserve)
+      buf = gst_buffer_new_reserve_meta (meta_infos, nbmetas);
+    else
+      buf = gst_buffer_new ();
+    for (i = 0; i < nbmetas; i++)
+      gst_buffer_add_meta (buf, meta_infos[i], NULL);
     gst_buffer_unref (buf);
   }
 
@@ -70,13 +106,18 @@ main (gint argc, gchar * argv[])
   gst_init (&argc, &argv);
   g_mutex_init (&mutex);
 
-  if (argc != 3) {
-    g_print ("usage: %s <num_threads> <nbbuffers>\n", argv[0]);
+  if (argc < 3 || argc > 5) {
+    g_print ("usage: %s <num_threads> <nbbuffers> [nbmetas] [reserve]\n",
+        argv[0]);
     exit (-1);
   }
 
   num_threads = atoi (argv[1]);
   nbbuffers = atoi (argv[2]);
+  if (argc > 3)
+    nbmetas = atoi (argv[3]);
+  if (argc > 4)
+    reserve = atoi (argv[4]) != 0;
 
   if (num_threads <= 0 || num_threads > MAX_THREADS) {
     g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
@@ -88,11 +129,19 @@ main (gint argc, gchar * argv[])
     exit (-3);
   }
 
+  if (nbmetas > MAX_METAS) {
+    g_print ("number of metas must be between 0 and %d\n", MAX_METAS);
+    exit (-4);
+  }
+
+  register_metas ();
+
   g_mutex_lock (&mutex);
   /* Let's just make sure the GstBufferClass is loaded ... */
   tmp = gst_buffer_new ();
 
-  printf ("main(): Creating %d threads.\n", num_threads);
+  printf ("main(): Creating %d threads, %u metas per buffer%s.\n",
+      num_threads, nbmetas, reserve ? " (reserved)" : "");
   for (t = 0; t < num_threads; t++) {
     GError *error = NULL;
 
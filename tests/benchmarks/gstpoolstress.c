@@ -22,31 +22,104 @@
 #include <gst/gst.h>
 #include "gst/glib-compat-private.h"
 
+#define MAX_THREADS  64
+
+static guint64 nbuffers;
+static GstBufferPool *pool;
+static GMutex mutex;
+
+static gpointer
+run_test (gpointer user_data)
+{
+  guint64 nb;
+  GstBuffer *buf;
+
+  g_mutex_lock (&mutex);
+  g_mutex_unlock (&mutex);
+
+  for (nb = nbuffers; nb; nb--) {
+    if (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) != GST_FLOW_OK)
+      g_assert_not_reached ();
+    gst_buffer_unref (buf);
+  }
+  return NULL;
+}
+
+/* acquire and release nbuffers buffers in each of num_threads threads */
+static void
+run_threads (gint num_threads, guint cache_size)
+{
+  GThread *threads[MAX_THREADS];
+  GstStructure *conf;
+  GstClockTime start, end;
+  gint t;
+
+  pool = gst_buffer_pool_new ();
+
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, 1400, 0, 0);
+  gst_buffer_pool_config_set_thread_cache (conf, cache_size);
+  gst_buffer_pool_set_config (pool, conf);
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  g_mutex_lock (&mutex);
+  for (t = 0; t < num_threads; t++)
+    threads[t] = g_thread_new ("poolstresstest", run_test, NULL);
+
+  /* Signal all threads to start */
+  start = gst_util_get_timestamp ();
+  g_mutex_unlock (&mutex);
+
+  for (t = 0; t < num_threads; t++)
+    g_thread_join (threads[t]);
+  end = gst_util_get_timestamp ();
+
+  g_print ("*** %2d threads, thread-cache %3u: total %" GST_TIME_FORMAT
+      " - average %" GST_TIME_FORMAT "\n", num_threads, cache_size,
+      GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / (num_threads * nbuffers)));
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
 
 gint
 main (gint argc, gchar * argv[])
 {
   gint i;
   GstBuffer *tmp;
-  GstBufferPool *pool;
   GstClockTime start, end;
-  guint64 nbuffers;
   GstStructure *conf;
+  gint max_threads = 1;
+  guint cache_size = 32;
 
   gst_init (&argc, &argv);
+  g_mutex_init (&mutex);
 
-  if (argc != 2) {
-    g_print ("usage: %s <nbuffers>\n", argv[0]);
+  if (argc < 2 || argc > 4) {
+    g_print ("usage: %s <nbuffers> [max_threads] [thread_cache_size]\n",
+        argv[0]);
     exit (-1);
   }
 
   nbuffers = atoi (argv[1]);
+  if (argc > 2)
+    max_threads = atoi (argv[2]);
+  if (argc > 3)
+    cache_size = atoi (argv[3]);
 
   if (nbuffers <= 0) {
     g_print ("number of buffers must be greater than 0\n");
     exit (-3);
   }
 
+  if (max_threads <= 0 || max_threads > MAX_THREADS) {
+    g_print ("number of threads must be between 1 and %d\n", MAX_THREADS);
+    exit (-2);
+  }
+
   /* Let's just make sure the GstBufferClass is loaded ... */
   tmp = gst_buffer_new ();
   gst_buffer_unref (tmp);
@@ -86,5 +159,12 @@ main (gint argc, gchar * argv[])
   gst_buffer_pool_set_active (pool, FALSE);
   gst_object_unref (pool);
 
+  /* multi-thread scaling with and without the thread cache */
+  for (i = 1; i <= max_threads; i <<= 1) {
+    run_threads (i, 0);
+    if (cache_size > 0)
+      run_threads (i, cache_size);
+  }
+
   return 0;
 }
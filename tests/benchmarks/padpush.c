@@ -0,0 +1,107 @@
+/* GStreamer
+ *
+ * padpush.c: benchmark for the per-buffer cost of gst_pad_push()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#define NUM_BUFFERS 1000000
+
+static GstFlowReturn
+chain_func (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+probe_func (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+bench_push (const gchar * what, GstPad * src, GstBuffer * buffer)
+{
+  GstClockTime start, end;
+  gint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_BUFFERS; i++)
+    gst_pad_push (src, gst_buffer_ref (buffer));
+  end = gst_util_get_timestamp ();
+
+  g_print ("%" GST_TIME_FORMAT " - %d pushes %s, %" G_GUINT64_FORMAT
+      " ns per buffer\n", GST_TIME_ARGS (end - start), NUM_BUFFERS, what,
+      (end - start) / NUM_BUFFERS);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstPad *src, *sink;
+  GstSegment segment;
+  GstBuffer *buffer;
+  gulong id;
+
+  gst_init (&argc, &argv);
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, chain_func);
+
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+  if (GST_PAD_LINK_FAILED (gst_pad_link (src, sink)))
+    return EXIT_FAILURE;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (src, gst_event_new_stream_start ("padpush"));
+  gst_pad_push_event (src, gst_event_new_segment (&segment));
+
+  /* the same buffer is pushed all the time so that only the pad is measured */
+  buffer = gst_buffer_new ();
+
+  bench_push ("in steady state", src, buffer);
+
+  /* a probe makes every buffer take the lock and run the probe checks */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER, probe_func, NULL,
+      NULL);
+  bench_push ("with a probe", src, buffer);
+  gst_pad_remove_probe (src, id);
+
+  bench_push ("after removing the probe", src, buffer);
+
+  /* the probe is only called once per batch, the sink pad has no chainlist
+   * function so it chains the buffers of each list one by one */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER_LIST, probe_func,
+      NULL, NULL);
+  gst_pad_set_batching (src, 32, GST_CLOCK_TIME_NONE);
+  bench_push ("batched by 32 with a probe", src, buffer);
+  gst_pad_push_batch (src);
+  gst_pad_remove_probe (src, id);
+
+  gst_buffer_unref (buffer);
+
+  gst_pad_unlink (src, sink);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+
+  return EXIT_SUCCESS;
+}
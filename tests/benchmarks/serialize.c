@@ -0,0 +1,183 @@
+/* GStreamer
+ *
+ * serialize.c: benchmark for the string and binary forms of caps and
+ *              structures
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+#include <string.h>
+
+#define NUM_LOOPS 10000
+
+#define AUDIO_FORMATS_ALL " { S8, U8, " \
+    "S16LE, S16BE, U16LE, U16BE, " \
+    "S24_32LE, S24_32BE, U24_32LE, U24_32BE, " \
+    "S32LE, S32BE, U32LE, U32BE, " \
+    "S24LE, S24BE, U24LE, U24BE, " \
+    "S20LE, S20BE, U20LE, U20BE, " \
+    "S18LE, S18BE, U18LE, U18BE, " \
+    "F32LE, F32BE, F64LE, F64BE }"
+
+#define CAPS_STRING \
+  "audio/x-raw, " \
+  "format = (string) " AUDIO_FORMATS_ALL ", " \
+  "rate = (int) [ 1, MAX ], " \
+  "channels = (int) [ 1, MAX ], " \
+  "layout = (string) interleaved; " \
+  "video/x-raw, format = (string) { I420, YV12, YUY2, UYVY }, " \
+  "width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ], " \
+  "framerate = (fraction) [ 0/1, 2147483647/1 ], " \
+  "pixel-aspect-ratio = (fraction) 1/1"
+
+static GstStructure *
+create_stats (void)
+{
+  GstStructure *s;
+  gchar name[32];
+  gint i;
+
+  s = gst_structure_new_empty ("application/x-stats");
+  for (i = 0; i < 40; i++) {
+    g_snprintf (name, sizeof (name), "counter-%d", i);
+    gst_structure_set (s, name, G_TYPE_UINT64, (guint64) i * 1000003, NULL);
+    g_snprintf (name, sizeof (name), "average-%d", i);
+    gst_structure_set (s, name, G_TYPE_DOUBLE, i / 3.0, NULL);
+  }
+  return s;
+}
+
+static void
+bench_caps (GstCaps * caps)
+{
+  GstClockTime start, end;
+  GstCaps *tmp;
+  guint8 *data;
+  gchar *str;
+  gsize size;
+  gint i;
+
+  str = gst_caps_to_string (caps);
+  data = gst_caps_to_binary (caps, &size);
+  g_print ("caps: %u bytes as string, %u bytes as binary\n",
+      (guint) strlen (str), (guint) size);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++)
+    g_free (gst_caps_to_string (caps));
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_caps_to_string\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++)
+    g_free (gst_caps_to_binary (caps, &size));
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_caps_to_binary\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++) {
+    tmp = gst_caps_from_string (str);
+    gst_caps_unref (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_caps_from_string\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++) {
+    tmp = gst_caps_from_binary (data, size);
+    gst_caps_unref (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_caps_from_binary\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  g_free (data);
+  g_free (str);
+}
+
+static void
+bench_structure (GstStructure * s)
+{
+  GstClockTime start, end;
+  GstStructure *tmp;
+  guint8 *data;
+  gchar *str;
+  gsize size;
+  gint i;
+
+  str = gst_structure_to_string (s);
+  data = gst_structure_to_binary (s, &size);
+  g_print ("structure: %u bytes as string, %u bytes as binary\n",
+      (guint) strlen (str), (guint) size);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++)
+    g_free (gst_structure_to_string (s));
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_structure_to_string\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++)
+    g_free (gst_structure_to_binary (s, &size));
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_structure_to_binary\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++) {
+    tmp = gst_structure_from_string (str, NULL);
+    gst_structure_free (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_structure_from_string\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++) {
+    tmp = gst_structure_from_binary (data, size);
+    gst_structure_free (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d x gst_structure_from_binary\n",
+      GST_TIME_ARGS (end - start), NUM_LOOPS);
+
+  g_free (data);
+  g_free (str);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstCaps *caps;
+  GstStructure *s;
+
+  gst_init (&argc, &argv);
+
+  caps = gst_caps_from_string (CAPS_STRING);
+  bench_caps (caps);
+  gst_caps_unref (caps);
+
+  s = create_stats ();
+  bench_structure (s);
+  gst_structure_free (s);
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+/* GStreamer
+ *
+ * structure.c: benchmark for field access in structures of various sizes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#define NUM_LOOKUPS 1000000
+
+static const guint sizes[] = { 4, 8, 16, 32, 64, 100 };
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstStructure *s;
+  GstClockTime start, end;
+  GQuark *names;
+  guint i, j, n, nsizes, max;
+  gint val;
+  gulong found = 0;
+
+  gst_init (&argc, &argv);
+
+  nsizes = G_N_ELEMENTS (sizes);
+  max = sizes[nsizes - 1];
+
+  names = g_new (GQuark, max + 1);
+  for (i = 0; i <= max; i++) {
+    gchar *name = g_strdup_printf ("field-%u", i);
+
+    names[i] = g_quark_from_string (name);
+    g_free (name);
+  }
+
+  for (j = 0; j < nsizes; j++) {
+    n = sizes[j];
+
+    g_print ("%u fields\n", n);
+
+    s = gst_structure_new_empty ("bench");
+    start = gst_util_get_timestamp ();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+      gst_structure_id_set (s, names[i % n], G_TYPE_INT, i, NULL);
+    end = gst_util_get_timestamp ();
+    g_print ("  %" GST_TIME_FORMAT " - %d set\n",
+        GST_TIME_ARGS (end - start), NUM_LOOKUPS);
+
+    start = gst_util_get_timestamp ();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+      found += gst_structure_id_get (s, names[i % n], G_TYPE_INT, &val, NULL);
+    end = gst_util_get_timestamp ();
+    g_print ("  %" GST_TIME_FORMAT " - %d get\n",
+        GST_TIME_ARGS (end - start), NUM_LOOKUPS);
+
+    /* half of the lookups are for a field that does not exist */
+    start = gst_util_get_timestamp ();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+      found += gst_structure_id_has_field (s, names[(i & 1) ? max : i % n]);
+    end = gst_util_get_timestamp ();
+    g_print ("  %" GST_TIME_FORMAT " - %d has_field\n",
+        GST_TIME_ARGS (end - start), NUM_LOOKUPS);
+
+    gst_structure_free (s);
+  }
+
+  g_free (names);
+
+  /* make sure the lookups are not optimized away */
+  return found == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
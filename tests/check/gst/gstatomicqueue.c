@@ -31,6 +31,218 @@ GST_START_TEST (test_create_free)
 
 GST_END_TEST;
 
+GST_START_TEST (test_bounded)
+{
+  GstAtomicQueue *aq;
+  gpointer data[8];
+  guint i;
+
+  aq = gst_atomic_queue_new_full (4, GST_ATOMIC_QUEUE_FLAG_BOUNDED);
+  fail_unless (aq != NULL);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+  fail_unless (gst_atomic_queue_peek (aq) == NULL);
+
+  /* wrap around the ring a few times */
+  for (i = 1; i < 20; i++) {
+    fail_unless (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (i)));
+    fail_unless_equals_int (gst_atomic_queue_length (aq), 1);
+    fail_unless (gst_atomic_queue_peek (aq) == GUINT_TO_POINTER (i));
+    fail_unless (gst_atomic_queue_pop (aq) == GUINT_TO_POINTER (i));
+    fail_unless_equals_int (gst_atomic_queue_length (aq), 0);
+  }
+
+  /* fill up */
+  for (i = 1; i <= 4; i++)
+    fail_unless (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (i)));
+  fail_if (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (5)));
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 4);
+
+  /* batches are partial when there is no room */
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, data, 2), 2);
+  fail_unless (data[0] == GUINT_TO_POINTER (1));
+  fail_unless (data[1] == GUINT_TO_POINTER (2));
+  for (i = 0; i < 8; i++)
+    data[i] = GUINT_TO_POINTER (i + 5);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, data, 8), 2);
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, data, 8), 4);
+  for (i = 0; i < 4; i++)
+    fail_unless (data[i] == GUINT_TO_POINTER (i + 3));
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, data, 8), 0);
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_unbounded_batch)
+{
+  GstAtomicQueue *aq;
+  gpointer data[100];
+  guint i;
+
+  aq = gst_atomic_queue_new_full (4, GST_ATOMIC_QUEUE_FLAG_NONE);
+
+  for (i = 0; i < 100; i++)
+    data[i] = GUINT_TO_POINTER (i + 1);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, data, 100), 100);
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 100);
+  fail_unless (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (101)));
+
+  memset (data, 0, sizeof (data));
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, data, 100), 100);
+  for (i = 0; i < 100; i++)
+    fail_unless (data[i] == GUINT_TO_POINTER (i + 1));
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, data, 100), 1);
+  fail_unless (data[0] == GUINT_TO_POINTER (101));
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
+#define N_PRODUCERS  4
+#define N_CONSUMERS  3
+#define N_ITEMS      20000
+#define BATCH        16
+
+typedef struct
+{
+  GstAtomicQueue *aq;
+  guint batch;
+  guint total;
+  /* number of times each item was popped, item i + 1 is counted in
+   * seen[i] */
+  gint *seen;
+  volatile gint n_popped;
+  volatile gint next_producer;
+  guint64 sum;
+} ContentionData;
+
+G_LOCK_DEFINE_STATIC (sum_lock);
+
+static gpointer
+producer_thread (gpointer user_data)
+{
+  ContentionData *cd = user_data;
+  gpointer data[BATCH];
+  guint i, j, n, first;
+
+  /* every producer pushes its own range of items */
+  first = g_atomic_int_add (&cd->next_producer, 1) * N_ITEMS + 1;
+
+  for (i = 0; i < N_ITEMS; i += n) {
+    n = MIN (cd->batch, N_ITEMS - i);
+    for (j = 0; j < n; j++)
+      data[j] = GUINT_TO_POINTER (first + i + j);
+    if (n == 1) {
+      while (!gst_atomic_queue_try_push (cd->aq, data[0]))
+        g_thread_yield ();
+    } else {
+      guint pushed = 0;
+
+      while (pushed < n) {
+        pushed += gst_atomic_queue_push_many (cd->aq, data + pushed,
+            n - pushed);
+        if (pushed < n)
+          g_thread_yield ();
+      }
+    }
+  }
+  return NULL;
+}
+
+static gpointer
+consumer_thread (gpointer user_data)
+{
+  ContentionData *cd = user_data;
+  gpointer data[BATCH];
+  guint64 sum = 0;
+  guint j, n;
+
+  while ((guint) g_atomic_int_get (&cd->n_popped) < cd->total) {
+    if (cd->batch == 1) {
+      data[0] = gst_atomic_queue_pop (cd->aq);
+      n = data[0] ? 1 : 0;
+    } else {
+      n = gst_atomic_queue_pop_many (cd->aq, data, cd->batch);
+    }
+    if (n == 0) {
+      g_thread_yield ();
+      continue;
+    }
+    for (j = 0; j < n; j++) {
+      guint v = GPOINTER_TO_UINT (data[j]);
+
+      g_atomic_int_inc (&cd->seen[v - 1]);
+      sum += v;
+    }
+    g_atomic_int_add (&cd->n_popped, n);
+  }
+
+  G_LOCK (sum_lock);
+  cd->sum += sum;
+  G_UNLOCK (sum_lock);
+
+  return NULL;
+}
+
+/* push items from @n_producers threads and pop them in @n_consumers
+ * threads, each item must come out exactly once */
+static void
+run_contention (guint size, GstAtomicQueueFlags flags, guint n_producers,
+    guint n_consumers, guint batch)
+{
+  ContentionData cd;
+  GThread *producers[N_PRODUCERS], *consumers[N_CONSUMERS];
+  guint i, total = n_producers * N_ITEMS;
+
+  cd.aq = gst_atomic_queue_new_full (size, flags);
+  cd.batch = batch;
+  cd.total = total;
+  cd.seen = g_new0 (gint, total);
+  cd.n_popped = 0;
+  cd.next_producer = 0;
+  cd.sum = 0;
+
+  for (i = 0; i < n_consumers; i++)
+    consumers[i] = g_thread_new ("consumer", consumer_thread, &cd);
+  for (i = 0; i < n_producers; i++)
+    producers[i] = g_thread_new ("producer", producer_thread, &cd);
+  for (i = 0; i < n_producers; i++)
+    g_thread_join (producers[i]);
+  for (i = 0; i < n_consumers; i++)
+    g_thread_join (consumers[i]);
+
+  fail_unless_equals_int (cd.n_popped, total);
+  fail_unless_equals_uint64 (cd.sum, ((guint64) total * (total + 1)) / 2);
+  for (i = 0; i < total; i++)
+    fail_unless_equals_int (cd.seen[i], 1);
+  fail_unless_equals_int (gst_atomic_queue_length (cd.aq), 0);
+
+  g_free (cd.seen);
+  gst_atomic_queue_unref (cd.aq);
+}
+
+GST_START_TEST (test_contention)
+{
+  GstAtomicQueueFlags spsc = GST_ATOMIC_QUEUE_FLAG_BOUNDED |
+      GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER |
+      GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER;
+
+  run_contention (32, GST_ATOMIC_QUEUE_FLAG_NONE, N_PRODUCERS, N_CONSUMERS, 1);
+  run_contention (32, GST_ATOMIC_QUEUE_FLAG_NONE, N_PRODUCERS, N_CONSUMERS,
+      BATCH);
+  /* a small ring so that it is full and empty often */
+  run_contention (64, GST_ATOMIC_QUEUE_FLAG_BOUNDED, N_PRODUCERS,
+      N_CONSUMERS, 1);
+  run_contention (64, GST_ATOMIC_QUEUE_FLAG_BOUNDED, N_PRODUCERS,
+      N_CONSUMERS, BATCH);
+  run_contention (64, spsc, 1, 1, 1);
+  run_contention (64, spsc, 1, 1, BATCH);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_atomic_queue_suite (void)
 {
@@ -39,6 +251,9 @@ gst_atomic_queue_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_free);
+  tcase_add_test (tc_chain, test_bounded);
+  tcase_add_test (tc_chain, test_unbounded_batch);
+  tcase_add_test (tc_chain, test_contention);
 
   return s;
 }
@@ -1527,6 +1527,220 @@ GST_START_TEST (test_duration_unknown_overrides)
 
 GST_END_TEST;
 
+#define NUM_BRANCHES 8
+
+/* elements that wait in their NULL to READY state change until another
+ * element is changing state at the same time. The pool of the bin starts
+ * as many threads as needed, so a second element always arrives when the
+ * state changes run in parallel. */
+typedef struct
+{
+  GstElement parent;
+  gint start_seq;
+  gint done_seq;
+} GstStateTestElement;
+
+typedef struct
+{
+  GstElementClass parent_class;
+} GstStateTestElementClass;
+
+GType gst_state_test_element_get_type (void);
+
+G_DEFINE_TYPE (GstStateTestElement, gst_state_test_element, GST_TYPE_ELEMENT);
+
+static GMutex state_test_lock;
+static GCond state_test_cond;
+static gint state_test_seq;
+static gint state_test_inside;
+static gint state_test_max_inside;
+
+static GstStateChangeReturn
+gst_state_test_element_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstStateTestElement *self = (GstStateTestElement *) element;
+
+  if (transition == GST_STATE_CHANGE_NULL_TO_READY) {
+    g_mutex_lock (&state_test_lock);
+    self->start_seq = state_test_seq++;
+    state_test_inside++;
+    state_test_max_inside = MAX (state_test_max_inside, state_test_inside);
+    g_cond_broadcast (&state_test_cond);
+
+    while (state_test_max_inside < 2)
+      g_cond_wait (&state_test_cond, &state_test_lock);
+
+    self->done_seq = state_test_seq++;
+    state_test_inside--;
+    g_mutex_unlock (&state_test_lock);
+  }
+
+  return
+      GST_ELEMENT_CLASS (gst_state_test_element_parent_class)->change_state
+      (element, transition);
+}
+
+static void
+gst_state_test_element_class_init (GstStateTestElementClass * klass)
+{
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gstelement_class->change_state = gst_state_test_element_change_state;
+}
+
+static void
+gst_state_test_element_init (GstStateTestElement * self)
+{
+  gst_element_add_pad (GST_ELEMENT (self), gst_pad_new ("src", GST_PAD_SRC));
+  gst_element_add_pad (GST_ELEMENT (self), gst_pad_new ("sink",
+          GST_PAD_SINK));
+}
+
+GST_START_TEST (test_parallel_state_changes)
+{
+  GstElement *bin;
+  GstStateTestElement *src[NUM_BRANCHES], *sink[NUM_BRANCHES];
+  GstStateChangeReturn ret;
+  GstBus *bus;
+  gint i;
+
+  bin = gst_bin_new (NULL);
+  g_object_set (bin, "parallel-state-changes", TRUE, NULL);
+
+  bus = g_object_new (gst_bus_get_type (), NULL);
+  gst_element_set_bus (bin, bus);
+
+  for (i = 0; i < NUM_BRANCHES; i++) {
+    src[i] = g_object_new (gst_state_test_element_get_type (), NULL);
+    sink[i] = g_object_new (gst_state_test_element_get_type (), NULL);
+    gst_bin_add_many (GST_BIN (bin), GST_ELEMENT (src[i]),
+        GST_ELEMENT (sink[i]), NULL);
+    fail_unless (gst_element_link_pads (GST_ELEMENT (src[i]), "src",
+            GST_ELEMENT (sink[i]), "sink"));
+  }
+
+  state_test_seq = 0;
+  state_test_inside = 0;
+  state_test_max_inside = 0;
+
+  ret = gst_element_set_state (bin, GST_STATE_READY);
+  fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+
+  /* independent branches were inside their state change at the same time */
+  fail_unless (state_test_max_inside >= 2);
+  fail_unless_equals_int (state_test_inside, 0);
+
+  for (i = 0; i < NUM_BRANCHES; i++) {
+    fail_unless_equals_int (GST_STATE (src[i]), GST_STATE_READY);
+    fail_unless_equals_int (GST_STATE (sink[i]), GST_STATE_READY);
+    /* sinks still change state before the sources linked to them */
+    fail_unless (sink[i]->done_seq < src[i]->start_seq);
+  }
+
+  ret = gst_element_set_state (bin, GST_STATE_NULL);
+  fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+/* check that the durations of the last state change of @bin hold one entry
+ * for each of the @n_children children named in @names */
+static void
+check_state_change_durations (GstElement * bin, GstState old_state,
+    GstState new_state, const gchar ** names, guint n_children)
+{
+  GstStructure *s;
+  const GValue *durations;
+  GstState state;
+  guint i, j;
+
+  s = gst_bin_get_state_change_durations (GST_BIN (bin));
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_has_name (s, "GstBinStateChangeDurations"));
+  fail_unless (gst_structure_get_enum (s, "old-state", GST_TYPE_STATE,
+          (gint *) & state));
+  fail_unless_equals_int (state, old_state);
+  fail_unless (gst_structure_get_enum (s, "new-state", GST_TYPE_STATE,
+          (gint *) & state));
+  fail_unless_equals_int (state, new_state);
+
+  durations = gst_structure_get_value (s, "durations");
+  fail_unless (durations != NULL && GST_VALUE_HOLDS_ARRAY (durations));
+  fail_unless_equals_int (gst_value_array_get_size (durations), n_children);
+
+  for (i = 0; i < n_children; i++) {
+    gboolean found = FALSE;
+
+    for (j = 0; j < n_children && !found; j++) {
+      const GstStructure *child;
+      GstClockTime duration;
+
+      child = gst_value_get_structure (gst_value_array_get_value (durations,
+              j));
+      if (g_strcmp0 (gst_structure_get_string (child, "element"),
+              names[i]) != 0)
+        continue;
+
+      fail_unless (gst_structure_get_clock_time (child, "duration",
+              &duration));
+      fail_unless (GST_CLOCK_TIME_IS_VALID (duration));
+      found = TRUE;
+    }
+    fail_unless (found, "no duration for %s", names[i]);
+  }
+  gst_structure_free (s);
+}
+
+GST_START_TEST (test_state_change_durations)
+{
+  const gchar *names[] = { "src", "sink" };
+  GstElement *bin, *src, *sink;
+  GstStateChangeReturn ret;
+  gint parallel;
+
+  for (parallel = 0; parallel < 2; parallel++) {
+    bin = gst_bin_new (NULL);
+    g_object_set (bin, "parallel-state-changes", parallel, NULL);
+
+    src = gst_element_factory_make ("fakesrc", "src");
+    sink = gst_element_factory_make ("fakesink", "sink");
+    gst_bin_add_many (GST_BIN (bin), src, sink, NULL);
+    fail_unless (gst_element_link (src, sink));
+
+    /* nothing is measured before the first state change */
+    fail_unless (gst_bin_get_state_change_durations (GST_BIN (bin)) == NULL);
+
+    if (!parallel) {
+      /* serial state changes are only measured on request */
+      ret = gst_element_set_state (bin, GST_STATE_READY);
+      fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+      fail_unless (gst_bin_get_state_change_durations (GST_BIN (bin)) == NULL);
+      ret = gst_element_set_state (bin, GST_STATE_NULL);
+      fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+
+      g_object_set (bin, "measure-state-changes", TRUE, NULL);
+    }
+
+    ret = gst_element_set_state (bin, GST_STATE_READY);
+    fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+    check_state_change_durations (bin, GST_STATE_NULL, GST_STATE_READY,
+        names, G_N_ELEMENTS (names));
+
+    ret = gst_element_set_state (bin, GST_STATE_NULL);
+    fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+    check_state_change_durations (bin, GST_STATE_READY, GST_STATE_NULL,
+        names, G_N_ELEMENTS (names));
+
+    gst_object_unref (bin);
+  }
+}
+
+GST_END_TEST;
 
 
 static Suite *
@@ -1558,6 +1772,8 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_state_change_skip);
   tcase_add_test (tc_chain, test_duration_is_max);
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
+  tcase_add_test (tc_chain, test_parallel_state_changes);
+  tcase_add_test (tc_chain, test_state_change_durations);
 
   /* fails on OSX build bot for some reason, and is a bit silly anyway */
   if (0)
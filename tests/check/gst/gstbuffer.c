@@ -857,6 +857,101 @@ GST_START_TEST (test_fill)
 
 GST_END_TEST;
 
+GST_START_TEST (test_many_memory)
+{
+  GstBuffer *buf, *buf2;
+  GstMemory *mems[40];
+  GstMapInfo info;
+  guint8 data[40];
+  gint i;
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < 40; i++) {
+    mems[i] = gst_allocator_alloc (NULL, 1, NULL);
+    gst_memory_map (mems[i], &info, GST_MAP_WRITE);
+    info.data[0] = i;
+    gst_memory_unmap (mems[i], &info);
+    gst_buffer_append_memory (buf, mems[i]);
+  }
+
+  /* memory is not merged when going over the inline array */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 40);
+  fail_unless (gst_buffer_get_max_memory () >= 40);
+  for (i = 0; i < 40; i++)
+    fail_unless (gst_buffer_peek_memory (buf, i) == mems[i]);
+
+  fail_unless_equals_int (gst_buffer_extract (buf, 0, data, 40), 40);
+  for (i = 0; i < 40; i++)
+    fail_unless_equals_int (data[i], i);
+
+  /* insert in the middle of the spilled array */
+  gst_buffer_insert_memory (buf, 20, gst_allocator_alloc (NULL, 1, NULL));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 41);
+  fail_unless (gst_buffer_peek_memory (buf, 19) == mems[19]);
+  fail_unless (gst_buffer_peek_memory (buf, 21) == mems[20]);
+  fail_unless (gst_buffer_peek_memory (buf, 40) == mems[39]);
+
+  /* remove it again and shrink below the inline size */
+  gst_buffer_remove_memory (buf, 20);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 40);
+  gst_buffer_remove_memory_range (buf, 8, -1);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 8);
+  fail_unless (gst_buffer_peek_memory (buf, 7) == mems[7]);
+
+  /* appending buffers keeps all memory blocks */
+  buf2 = gst_buffer_new ();
+  for (i = 0; i < 20; i++)
+    gst_buffer_append_memory (buf2, gst_allocator_alloc (NULL, 1, NULL));
+  buf = gst_buffer_append (buf, buf2);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 28);
+  fail_unless (gst_buffer_peek_memory (buf, 0) == mems[0]);
+
+  /* copies keep the memory layout too */
+  buf2 = gst_buffer_copy (buf);
+  fail_unless_equals_int (gst_buffer_n_memory (buf2), 28);
+  fail_unless (gst_buffer_peek_memory (buf2, 0) == mems[0]);
+  gst_buffer_unref (buf2);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_max_memory)
+{
+  GstBuffer *buf;
+  GstMapInfo info;
+  guint i, max;
+
+  max = gst_buffer_get_max_memory ();
+  fail_unless (max > 16);
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < max; i++) {
+    GstMemory *mem = gst_allocator_alloc (NULL, 1, NULL);
+
+    gst_memory_map (mem, &info, GST_MAP_WRITE);
+    info.data[0] = i & 0xff;
+    gst_memory_unmap (mem, &info);
+    gst_buffer_append_memory (buf, mem);
+  }
+  fail_unless_equals_int (gst_buffer_n_memory (buf), max);
+
+  /* going over the limit merges the existing memory */
+  gst_buffer_append_memory (buf, gst_allocator_alloc (NULL, 1, NULL));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  fail_unless_equals_int (gst_buffer_get_size (buf), max + 1);
+
+  fail_unless (gst_buffer_map (buf, &info, GST_MAP_READ));
+  for (i = 0; i < max; i++)
+    fail_unless_equals_int (info.data[i], i & 0xff);
+  gst_buffer_unmap (buf, &info);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_suite (void)
 {
@@ -878,6 +973,8 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_map_range);
   tcase_add_test (tc_chain, test_find);
   tcase_add_test (tc_chain, test_fill);
+  tcase_add_test (tc_chain, test_many_memory);
+  tcase_add_test (tc_chain, test_max_memory);
 
   return s;
 }
@@ -0,0 +1,467 @@
+/* GStreamer
+ *
+ * unit test for GstBufferPool
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+static GstBufferPool *
+create_pool (guint size, guint min_buf, guint max_buf, guint cache_size)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+
+  gst_buffer_pool_config_set_params (conf, NULL, size, min_buf, max_buf);
+  gst_buffer_pool_config_set_thread_cache (conf, cache_size);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+
+  return pool;
+}
+
+GST_START_TEST (test_new_buffer_from_empty_pool)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, 0);
+  GstBuffer *buf = NULL;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (buf != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 10);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_config)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, 8);
+  GstStructure *conf;
+  guint cache_size = 0;
+
+  conf = gst_buffer_pool_get_config (pool);
+  fail_unless (gst_buffer_pool_config_get_thread_cache (conf, &cache_size));
+  fail_unless_equals_int (cache_size, 8);
+
+  /* no thread cache configured */
+  gst_structure_remove_field (conf, "thread-cache");
+  fail_unless (gst_buffer_pool_config_get_thread_cache (conf, &cache_size));
+  fail_unless_equals_int (cache_size, 0);
+  gst_structure_free (conf);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_recycle)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, 4);
+  GstBuffer *bufs[16];
+  GstBuffer *buf;
+  guint i, j;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL) ==
+        GST_FLOW_OK);
+  /* overflows the magazine to the shared queue */
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    gst_buffer_unref (bufs[i]);
+
+  /* all buffers we get back must be recycled ones */
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++) {
+    gboolean found = FALSE;
+
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+        GST_FLOW_OK);
+    for (j = 0; j < G_N_ELEMENTS (bufs); j++)
+      found |= (bufs[j] == buf);
+    fail_unless (found);
+    bufs[i] = buf;
+  }
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    gst_buffer_unref (bufs[i]);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+release_buffers (gpointer data)
+{
+  GstBuffer **bufs = data;
+
+  gst_buffer_unref (bufs[0]);
+  gst_buffer_unref (bufs[1]);
+
+  return NULL;
+}
+
+GST_START_TEST (test_thread_cache_bounded)
+{
+  GstBufferPool *pool = create_pool (10, 0, 2, 8);
+  GstBuffer *bufs[2];
+  GThread *thread;
+  gint i;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  for (i = 0; i < 2; i++)
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL) ==
+        GST_FLOW_OK);
+
+  /* the buffers end up in the cache of another thread, we must still be
+   * able to get them */
+  thread = g_thread_new ("release", release_buffers, bufs);
+  g_thread_join (thread);
+
+  for (i = 0; i < 2; i++)
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL) ==
+        GST_FLOW_OK);
+  for (i = 0; i < 2; i++)
+    gst_buffer_unref (bufs[i]);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+consume_buffers (gpointer data)
+{
+  GAsyncQueue **queues = data;
+  GstBuffer *buf;
+
+  /* release the buffers we get, acknowledge each one */
+  while ((buf = g_async_queue_pop (queues[0])) != (gpointer) queues) {
+    gst_buffer_unref (buf);
+    g_async_queue_push (queues[1], buf);
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_thread_cache_producer_consumer)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, 4);
+  GAsyncQueue *queues[2];
+  GHashTable *seen;
+  GThread *thread;
+  GstBuffer *buf;
+  gint i;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  queues[0] = g_async_queue_new ();
+  queues[1] = g_async_queue_new ();
+  seen = g_hash_table_new (NULL, NULL);
+  thread = g_thread_new ("consume", consume_buffers, queues);
+
+  /* buffers released in the consumer thread must be reused by the producer
+   * instead of piling up in the thread cache of the consumer */
+  for (i = 0; i < 64; i++) {
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+        GST_FLOW_OK);
+    g_hash_table_add (seen, buf);
+    g_async_queue_push (queues[0], buf);
+    g_async_queue_pop (queues[1]);
+  }
+  fail_unless_equals_int (g_hash_table_size (seen), 1);
+
+  g_async_queue_push (queues[0], queues);
+  g_thread_join (thread);
+  g_async_queue_unref (queues[0]);
+  g_async_queue_unref (queues[1]);
+  g_hash_table_destroy (seen);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+/* the NUMA node of the page at @data or -1 when unknown */
+static gint
+node_of_page (gpointer data)
+{
+#if defined(__linux__) && defined(__NR_get_mempolicy)
+  /* MPOL_F_NODE | MPOL_F_ADDR */
+  const gulong flags = (1 << 0) | (1 << 1);
+  gint node = -1;
+
+  if (syscall (__NR_get_mempolicy, &node, NULL, 0, data, flags) < 0)
+    return -1;
+
+  return node;
+#else
+  return -1;
+#endif
+}
+
+GST_START_TEST (test_numa_node)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstAllocationParams params;
+  GstBuffer *buf = NULL;
+  GstAllocator *allocator;
+
+  /* no mmap support */
+  if ((allocator = gst_allocator_find (GST_ALLOCATOR_MMAP)) == NULL) {
+    gst_structure_free (conf);
+    gst_object_unref (pool);
+    return;
+  }
+  gst_object_unref (allocator);
+
+  gst_allocation_params_init (&params);
+  gst_allocation_params_set_numa_node (&params, 0);
+  gst_buffer_pool_config_set_params (conf, NULL, 10, 0, 0);
+  gst_buffer_pool_config_set_allocator (conf, NULL, &params);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+
+  /* the pool picks an allocator that can place memory on a node */
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (gst_is_mmap_memory (gst_buffer_peek_memory (buf, 0)));
+
+  /* check that the memory really ended up on the node */
+  {
+    GstMapInfo info;
+    gint node;
+
+    fail_unless (gst_buffer_map (buf, &info, GST_MAP_WRITE));
+    memset (info.data, 0, info.size);
+    node = node_of_page (info.data);
+    gst_buffer_unmap (buf, &info);
+
+    if (node < 0)
+      g_print ("NUMA not available, skipping node placement check\n");
+    else
+      fail_unless_equals_int (node, 0);
+  }
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+acquire_buffer (gpointer data)
+{
+  GstBufferPool *pool = data;
+  GstBuffer *buf = NULL;
+
+  if (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  return buf;
+}
+
+GST_START_TEST (test_wait_for_release)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1, 0);
+  GstBuffer *buf = NULL, *buf2;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+
+  /* blocks until we release our buffer */
+  thread = g_thread_new ("acquire", acquire_buffer, pool);
+  g_usleep (G_USEC_PER_SEC / 10);
+  gst_buffer_unref (buf);
+
+  buf2 = g_thread_join (thread);
+  fail_unless (buf2 == buf);
+  gst_buffer_unref (buf2);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_wait_unblock_on_flush)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1, 0);
+  GstBuffer *buf = NULL;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+
+  /* blocks until the pool is deactivated */
+  thread = g_thread_new ("acquire", acquire_buffer, pool);
+  g_usleep (G_USEC_PER_SEC / 10);
+  gst_buffer_pool_set_active (pool, FALSE);
+
+  fail_unless (g_thread_join (thread) == NULL);
+  gst_buffer_unref (buf);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+/* freeing a list that holds the last references returns all buffers */
+GST_START_TEST (test_release_buffer_list)
+{
+  GstBufferPool *pool = create_pool (10, 0, 8, 0);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBufferList *list;
+  GstBuffer *buf, *extra, *bufs[7];
+  guint i;
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 8; i++) {
+    buf = NULL;
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+        GST_FLOW_OK);
+    gst_buffer_list_add (list, buf);
+  }
+  /* keep an extra ref on one of them, it must not be released */
+  extra = gst_buffer_ref (gst_buffer_list_get (list, 3));
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, &params) ==
+      GST_FLOW_EOS);
+
+  gst_buffer_list_unref (list);
+
+  /* all buffers but the extra one are back in the pool */
+  for (i = 0; i < 7; i++) {
+    bufs[i] = NULL;
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], &params) ==
+        GST_FLOW_OK);
+    fail_unless (bufs[i] != extra);
+  }
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, &params) ==
+      GST_FLOW_EOS);
+
+  for (i = 0; i < 7; i++)
+    gst_buffer_unref (bufs[i]);
+  gst_buffer_unref (extra);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static GstMiniObjectDisposeFunction buffer_dispose;
+static gint dispose_count;
+
+static gboolean
+counting_dispose (GstMiniObject * obj)
+{
+  dispose_count++;
+  return buffer_dispose (obj);
+}
+
+/* buffers with their own dispose function go through the normal unref */
+GST_START_TEST (test_release_buffer_list_dispose)
+{
+  GstBufferPool *pool = create_pool (10, 0, 2, 0);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBufferList *list;
+  GstBuffer *buf, *bufs[2];
+  guint i;
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 2; i++) {
+    buf = NULL;
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+        GST_FLOW_OK);
+    gst_buffer_list_add (list, buf);
+  }
+  buf = gst_buffer_list_get (list, 1);
+  buffer_dispose = GST_MINI_OBJECT_CAST (buf)->dispose;
+  GST_MINI_OBJECT_CAST (buf)->dispose = counting_dispose;
+
+  dispose_count = 0;
+  gst_buffer_list_unref (list);
+  fail_unless_equals_int (dispose_count, 1);
+
+  /* both buffers are back in the pool */
+  for (i = 0; i < 2; i++) {
+    bufs[i] = NULL;
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], &params) ==
+        GST_FLOW_OK);
+  }
+  for (i = 0; i < 2; i++) {
+    GST_MINI_OBJECT_CAST (bufs[i])->dispose = buffer_dispose;
+    gst_buffer_unref (bufs[i]);
+  }
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_buffer_pool_suite (void)
+{
+  Suite *s = suite_create ("GstBufferPool");
+  TCase *tc_chain = tcase_create ("buffer_pool tests");
+
+  tcase_set_timeout (tc_chain, 0);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_new_buffer_from_empty_pool);
+  tcase_add_test (tc_chain, test_thread_cache_config);
+  tcase_add_test (tc_chain, test_thread_cache_recycle);
+  tcase_add_test (tc_chain, test_thread_cache_bounded);
+  tcase_add_test (tc_chain, test_thread_cache_producer_consumer);
+  tcase_add_test (tc_chain, test_numa_node);
+  tcase_add_test (tc_chain, test_wait_for_release);
+  tcase_add_test (tc_chain, test_wait_unblock_on_flush);
+  tcase_add_test (tc_chain, test_release_buffer_list);
+  tcase_add_test (tc_chain, test_release_buffer_list_dispose);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_buffer_pool);
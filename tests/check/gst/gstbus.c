@@ -562,6 +562,72 @@ cb_bus_call (GstBus * bus, GstMessage * msg, gpointer data)
   return TRUE;
 }
 
+static void
+send_numbered_app_messages (gint first, gint n)
+{
+  GstStructure *s;
+  gint i;
+
+  for (i = first; i < first + n; i++) {
+    s = gst_structure_new ("test_message", "msg_id", G_TYPE_INT, i, NULL);
+    gst_bus_post (test_bus, gst_message_new_application (NULL, s));
+  }
+}
+
+static void
+pop_numbered_app_messages (gint first, gint n)
+{
+  GstMessage *m;
+  gint i, id;
+
+  for (i = first; i < first + n; i++) {
+    m = gst_bus_pop (test_bus);
+    fail_unless (m != NULL);
+    fail_unless (gst_structure_get_int (gst_message_get_structure (m),
+            "msg_id", &id));
+    fail_unless_equals_int (id, i);
+    gst_message_unref (m);
+  }
+}
+
+/* posting on a full bounded bus does not block and keeps the messages in
+ * order */
+GST_START_TEST (test_bounded_queue)
+{
+  GThread *thread;
+  GError *error = NULL;
+  guint queue_size;
+
+  test_bus = g_object_new (GST_TYPE_BUS, "queue-size", 4, NULL);
+  g_object_get (test_bus, "queue-size", &queue_size, NULL);
+  fail_unless_equals_int (queue_size, 4);
+
+  send_numbered_app_messages (0, 4);
+  fail_unless (gst_bus_have_pending (test_bus));
+  pop_numbered_app_messages (0, 4);
+  fail_if (gst_bus_have_pending (test_bus), "unexpected messages on bus");
+
+  /* more messages than the ring holds, without a consumer */
+  send_numbered_app_messages (0, 10);
+  pop_numbered_app_messages (0, 2);
+  send_numbered_app_messages (10, 3);
+  pop_numbered_app_messages (2, 11);
+  fail_if (gst_bus_have_pending (test_bus), "unexpected messages on bus");
+
+  thread = g_thread_try_new ("gst-chek", pop_thread, test_bus, &error);
+  fail_if (error != NULL);
+
+  send_10_app_messages ();
+
+  g_thread_join (thread);
+
+  fail_if (gst_bus_have_pending (test_bus), "unexpected messages on bus");
+
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_custom_main_context)
 {
   GMainContext *ctx;
@@ -629,6 +695,7 @@ gst_bus_suite (void)
   tcase_add_test (tc_chain, test_timed_pop_thread);
   tcase_add_test (tc_chain, test_timed_pop_filtered);
   tcase_add_test (tc_chain, test_timed_pop_filtered_with_timeout);
+  tcase_add_test (tc_chain, test_bounded_queue);
   tcase_add_test (tc_chain, test_custom_main_context);
   return s;
 }
@@ -109,14 +109,14 @@ GST_START_TEST (test_static_caps)
   /* caps creation */
   caps1 = gst_static_caps_get (&scaps);
   fail_unless (caps1 != NULL);
-  /* 1 refcount core, one from us */
-  fail_unless (GST_CAPS_REFCOUNT (caps1) == 2);
+  /* 2 refcounts core (static caps and string cache), one from us */
+  fail_unless (GST_CAPS_REFCOUNT (caps1) == 3);
 
   /* caps should be the same */
   caps2 = gst_static_caps_get (&scaps);
   fail_unless (caps2 != NULL);
-  /* 1 refcount core, two from us */
-  fail_unless (GST_CAPS_REFCOUNT (caps1) == 3);
+  /* 2 refcounts core, two from us */
+  fail_unless (GST_CAPS_REFCOUNT (caps1) == 4);
   /* caps must be equal */
   fail_unless (caps1 == caps2);
 
@@ -1083,6 +1083,287 @@ GST_START_TEST (test_features)
 
 GST_END_TEST;
 
+GST_START_TEST (test_operation_cache)
+{
+  GstCaps *c1, *c2, *c3, *r1, *r2;
+  guint64 hits, misses;
+
+  c1 = gst_caps_from_string ("video/x-raw, format=(string){ I420, YV12 }, "
+      "width=(int)[ 1, 1920 ]; audio/x-raw, rate=(int)44100");
+  c2 = gst_caps_from_string ("video/x-raw, format=(string)I420, "
+      "width=(int)320");
+
+  gst_caps_cache_set_enabled (TRUE);
+
+  /* writable caps are never cached */
+  fail_unless (gst_caps_can_intersect (c1, c2));
+  gst_caps_cache_get_stats (&hits, &misses);
+  fail_unless_equals_int (hits, 0);
+  fail_unless_equals_int (misses, 0);
+
+  /* take extra refs to make them read-only */
+  gst_caps_ref (c1);
+  gst_caps_ref (c2);
+
+  fail_unless (gst_caps_can_intersect (c1, c2));
+  fail_unless (gst_caps_can_intersect (c1, c2));
+  fail_unless (gst_caps_is_subset (c2, c1));
+  fail_unless (gst_caps_is_subset (c2, c1));
+  fail_if (gst_caps_is_subset (c1, c2));
+  fail_if (gst_caps_is_subset (c1, c2));
+  gst_caps_cache_get_stats (&hits, &misses);
+  fail_unless_equals_int (hits, 3);
+  fail_unless_equals_int (misses, 3);
+
+  r1 = gst_caps_intersect_full (c1, c2, GST_CAPS_INTERSECT_FIRST);
+  r2 = gst_caps_intersect_full (c1, c2, GST_CAPS_INTERSECT_FIRST);
+  fail_unless (r1 != r2);
+  fail_unless (gst_caps_is_equal (r1, r2));
+  fail_unless (gst_caps_is_equal (r1, c2));
+  gst_caps_unref (r2);
+  gst_caps_unref (r1);
+
+  /* different modes have separate entries */
+  r1 = gst_caps_intersect_full (c1, c2, GST_CAPS_INTERSECT_ZIG_ZAG);
+  fail_unless (gst_caps_is_equal (r1, c2));
+  gst_caps_unref (r1);
+
+  /* a cached result is a new caps owned by the caller */
+  r1 = gst_caps_intersect (c1, c2);
+  fail_unless (gst_caps_is_writable (r1));
+  gst_caps_set_simple (r1, "width", G_TYPE_INT, 640, NULL);
+  gst_caps_unref (r1);
+  r1 = gst_caps_intersect (c1, c2);
+  fail_unless (gst_caps_is_equal (r1, c2));
+  gst_caps_unref (r1);
+
+  /* the cache keeps the inputs alive and read-only */
+  gst_caps_unref (c2);
+  fail_if (gst_caps_is_writable (c2));
+
+  c3 = gst_caps_from_string ("audio/x-raw, rate=(int)48000");
+  gst_caps_ref (c3);
+  fail_if (gst_caps_can_intersect (c1, c3));
+  fail_if (gst_caps_can_intersect (c1, c3));
+  r1 = gst_caps_intersect (c1, c3);
+  fail_unless (gst_caps_is_empty (r1));
+  gst_caps_unref (r1);
+
+  /* disabling drops all entries and resets the counters */
+  gst_caps_cache_set_enabled (FALSE);
+  fail_unless (gst_caps_is_writable (c2));
+  gst_caps_cache_get_stats (&hits, &misses);
+  fail_unless_equals_int (hits, 0);
+  fail_unless_equals_int (misses, 0);
+
+  fail_unless (gst_caps_can_intersect (c1, c2));
+  gst_caps_cache_get_stats (&hits, &misses);
+  fail_unless_equals_int (misses, 0);
+
+  gst_caps_unref (c3);
+  gst_caps_unref (c3);
+  gst_caps_unref (c2);
+  gst_caps_unref (c1);
+  gst_caps_unref (c1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_hash_intern)
+{
+  GstCaps *c1, *c2, *c3, *i1, *i2, *i3;
+
+  /* field order does not matter */
+  c1 = gst_caps_from_string ("video/x-raw, format=(string)I420, "
+      "width=(int)320, framerate=(fraction)30/1");
+  c2 = gst_caps_from_string ("video/x-raw, framerate=(fraction)60/2, "
+      "width=(int)320, format=(string)I420");
+  c3 = gst_caps_from_string ("video/x-raw, format=(string)I420, "
+      "width=(int)640, framerate=(fraction)30/1");
+  fail_unless (gst_caps_is_strictly_equal (c1, c2));
+  fail_unless_equals_int (gst_caps_hash (c1), gst_caps_hash (c2));
+  fail_unless_equals_int (gst_structure_hash (gst_caps_get_structure (c1, 0)),
+      gst_structure_hash (gst_caps_get_structure (c2, 0)));
+  fail_if (gst_caps_hash (c1) == gst_caps_hash (c3));
+
+  /* ANY and EMPTY are different */
+  fail_if (gst_caps_is_strictly_equal (GST_CAPS_ANY, GST_CAPS_NONE));
+  fail_if (gst_caps_hash (GST_CAPS_ANY) == gst_caps_hash (GST_CAPS_NONE));
+
+  /* equal caps share one instance */
+  i1 = gst_caps_intern (c1);
+  fail_unless (i1 == c1);
+  fail_if (gst_caps_is_writable (i1));
+  i2 = gst_caps_intern (c2);
+  fail_unless (i2 == i1);
+  ASSERT_CAPS_REFCOUNT (i1, "interned", 3);
+  i3 = gst_caps_intern (c3);
+  fail_unless (i3 == c3);
+  fail_if (i3 == i1);
+
+  /* different interned fixed caps are never equal */
+  fail_if (gst_caps_is_equal (i1, i3));
+  fail_if (gst_caps_is_strictly_equal (i1, i3));
+  fail_unless (gst_caps_is_equal (i1, i2));
+
+  /* interning again is a no-op */
+  i1 = gst_caps_intern (i1);
+  fail_unless (i1 == i2);
+
+  /* modifying requires a copy */
+  c1 = gst_caps_make_writable (gst_caps_ref (i1));
+  fail_if (c1 == i1);
+  gst_caps_set_simple (c1, "width", G_TYPE_INT, 640, NULL);
+  c1 = gst_caps_intern (c1);
+  fail_unless (c1 == i3);
+
+  gst_caps_unref (c1);
+  gst_caps_unref (i1);
+  gst_caps_unref (i2);
+  gst_caps_unref (i3);
+
+  /* no features are the same as system memory */
+  c1 = gst_caps_from_string ("video/x-raw");
+  c2 = gst_caps_from_string ("video/x-raw(memory:SystemMemory)");
+  fail_unless (gst_caps_is_strictly_equal (c1, c2));
+  fail_unless_equals_int (gst_caps_hash (c1), gst_caps_hash (c2));
+  i1 = gst_caps_intern (c1);
+  i2 = gst_caps_intern (c2);
+  fail_unless (i1 == i2);
+  fail_unless (gst_caps_is_equal (i1, i2));
+  gst_caps_unref (i1);
+  gst_caps_unref (i2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_from_string_cached)
+{
+  const gchar *str = "video/x-raw, format=(string)I420, width=(int)320";
+  GstCaps *c1, *c2, *c3;
+  guint i;
+
+  c1 = gst_caps_from_string_cached (str);
+  fail_unless (c1 != NULL);
+  fail_if (gst_caps_is_writable (c1));
+
+  /* parsing the same string again returns the same caps */
+  c2 = gst_caps_from_string_cached (str);
+  fail_unless (c1 == c2);
+  gst_caps_unref (c2);
+
+  /* the normal function still returns new writable caps */
+  c3 = gst_caps_from_string (str);
+  fail_unless (c3 != c1);
+  fail_unless (gst_caps_is_writable (c3));
+  fail_unless (gst_caps_is_strictly_equal (c1, c3));
+  gst_caps_unref (c3);
+
+  c2 = gst_caps_from_string_cached ("ANY");
+  fail_unless (gst_caps_is_any (c2));
+  gst_caps_unref (c2);
+
+  fail_unless (gst_caps_from_string_cached ("video/x-raw, width=") == NULL);
+
+  /* filling the cache evicts the unused entries but keeps the ones in use */
+  for (i = 0; i < 1100; i++) {
+    gchar *s = g_strdup_printf ("video/x-raw, width=(int)%d", i);
+
+    gst_caps_unref (gst_caps_from_string_cached (s));
+    g_free (s);
+  }
+  c2 = gst_caps_from_string_cached (str);
+  fail_unless (c1 == c2);
+  gst_caps_unref (c2);
+
+  gst_caps_unref (c1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_simplify_normalize_budget)
+{
+  GstCaps *caps, *norm, *simple;
+
+  caps = gst_caps_from_string ("video/x-raw, format=(string){ I420, YV12, "
+      "NV12 }, framerate=(fraction){ 30/1, 25/1 }");
+
+  /* expanding needs 6 structures */
+  norm = gst_caps_normalize_full (gst_caps_ref (caps), 4);
+  fail_unless_equals_int (gst_caps_get_size (norm), 1);
+  fail_unless (gst_caps_is_equal (norm, caps));
+  gst_caps_unref (norm);
+
+  norm = gst_caps_normalize_full (gst_caps_ref (caps), 6);
+  fail_unless_equals_int (gst_caps_get_size (norm), 6);
+  fail_unless (gst_caps_is_equal (norm, caps));
+
+  /* a limited simplify still results in the same formats */
+  simple = gst_caps_simplify_full (gst_caps_copy (norm), 1);
+  fail_unless (gst_caps_get_size (simple) >= 5);
+  fail_unless (gst_caps_is_equal (simple, caps));
+  gst_caps_unref (simple);
+
+  simple = gst_caps_simplify_full (norm, 0);
+  fail_unless (gst_caps_get_size (simple) < 6);
+  fail_unless (gst_caps_is_equal (simple, caps));
+  gst_caps_unref (simple);
+  gst_caps_unref (caps);
+
+  /* structures with the same features are merged even when they are not
+   * next to each other */
+  caps = gst_caps_from_string ("video/x-raw(memory:GLMemory), format=I420; "
+      "video/x-raw, format=I420; video/x-raw(memory:GLMemory), format=YV12");
+  simple = gst_caps_simplify (gst_caps_ref (caps));
+  fail_unless_equals_int (gst_caps_get_size (simple), 2);
+  fail_unless (gst_caps_is_equal (simple, caps));
+  gst_caps_unref (simple);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_serialization)
+{
+  const gchar *strings[] = {
+    "ANY",
+    "EMPTY",
+    "audio/x-raw, format=(string){ S16LE, F32LE }, rate=(int)[ 1, 2147483647 ], "
+        "channels=(int)2, channel-mask=(bitmask)0x0000000000000003",
+    "video/x-raw(memory:SystemMemory, meta:Foo), format=(string)I420, "
+        "framerate=(fraction)[ 0/1, 60/1 ]; video/x-raw(ANY), width=(int)320",
+  };
+  GstCaps *caps, *copy;
+  guint8 *data;
+  gsize size;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++) {
+    caps = gst_caps_from_string (strings[i]);
+    fail_unless (caps != NULL, "could not parse %s", strings[i]);
+
+    data = gst_caps_to_binary (caps, &size);
+    fail_unless (data != NULL);
+    copy = gst_caps_from_binary (data, size);
+    fail_unless (copy != NULL);
+    fail_unless (gst_caps_is_strictly_equal (caps, copy));
+    fail_unless (gst_caps_is_any (caps) == gst_caps_is_any (copy));
+
+    /* not a structure */
+    fail_if (gst_structure_from_binary (data, size));
+    /* trailing garbage */
+    data = g_realloc (data, size + 1);
+    data[size] = 0;
+    fail_if (gst_caps_from_binary (data, size + 1));
+
+    g_free (data);
+    gst_caps_unref (copy);
+    gst_caps_unref (caps);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_caps_suite (void)
 {
@@ -1110,6 +1391,11 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_normalize);
   tcase_add_test (tc_chain, test_broken);
   tcase_add_test (tc_chain, test_features);
+  tcase_add_test (tc_chain, test_operation_cache);
+  tcase_add_test (tc_chain, test_hash_intern);
+  tcase_add_test (tc_chain, test_from_string_cached);
+  tcase_add_test (tc_chain, test_simplify_normalize_budget);
+  tcase_add_test (tc_chain, test_binary_serialization);
 
   return s;
 }
@@ -95,6 +95,59 @@ GST_START_TEST (test_from_to_string)
 
 GST_END_TEST;
 
+GST_START_TEST (test_equality)
+{
+  GstCapsFeatures *a, *b, *empty, *sysmem;
+  GstCapsFeatures *many[100], *copy;
+  gchar name[32];
+  gint i;
+
+  /* order does not matter */
+  a = gst_caps_features_new ("m:abc", "m:def", NULL);
+  b = gst_caps_features_new ("m:def", "m:abc", NULL);
+  fail_unless (gst_caps_features_is_equal (a, b));
+  gst_caps_features_remove (b, "m:abc");
+  fail_if (gst_caps_features_is_equal (a, b));
+  fail_unless (gst_caps_features_contains (b, "m:def"));
+  fail_if (gst_caps_features_contains (b, "m:abc"));
+  fail_if (gst_caps_features_contains (b,
+          GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY));
+
+  /* empty features mean system memory */
+  empty = gst_caps_features_new_empty ();
+  sysmem = gst_caps_features_new (GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY, NULL);
+  fail_unless (gst_caps_features_is_equal (empty, sysmem));
+  fail_unless (gst_caps_features_contains (empty,
+          GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY));
+  fail_if (gst_caps_features_is_equal (empty, b));
+  gst_caps_features_add (sysmem, "m:abc");
+  fail_if (gst_caps_features_is_equal (empty, sysmem));
+  fail_unless (gst_caps_features_contains (sysmem,
+          GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY));
+
+  gst_caps_features_free (a);
+  gst_caps_features_free (b);
+  gst_caps_features_free (empty);
+  gst_caps_features_free (sysmem);
+
+  /* more distinct features than fit in the fast representation */
+  for (i = 0; i < G_N_ELEMENTS (many); i++) {
+    g_snprintf (name, sizeof (name), "m:many%d", i);
+    many[i] = gst_caps_features_new ("m:common", name, NULL);
+  }
+  for (i = 0; i < G_N_ELEMENTS (many); i++) {
+    copy = gst_caps_features_copy (many[i]);
+    fail_unless (gst_caps_features_is_equal (many[i], copy));
+    if (i > 0)
+      fail_if (gst_caps_features_is_equal (many[i - 1], copy));
+    gst_caps_features_free (copy);
+  }
+  for (i = 0; i < G_N_ELEMENTS (many); i++)
+    gst_caps_features_free (many[i]);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_capsfeatures_suite (void)
 {
@@ -104,6 +157,7 @@ gst_capsfeatures_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_basic_operations);
   tcase_add_test (tc_chain, test_from_to_string);
+  tcase_add_test (tc_chain, test_equality);
 
   return s;
 }
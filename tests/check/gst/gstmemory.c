@@ -30,6 +30,10 @@
 # define RUNNING_ON_VALGRIND FALSE
 #endif
 
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
 #include <gst/check/gstcheck.h>
 
 GST_START_TEST (test_submemory)
@@ -508,6 +512,187 @@ GST_START_TEST (test_map_resize)
 
 GST_END_TEST;
 
+GST_START_TEST (test_slab_alloc)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem, *copy, *sub;
+  GstMapInfo info;
+  gsize sizes[] = { 1, 10, 100, 1000, 4000, 65536, 200000 };
+  guint i;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_SLAB);
+  fail_unless (allocator != NULL);
+
+  gst_allocation_params_init (&params);
+  params.align = 63;
+  params.prefix = 8;
+  params.padding = 8;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    mem = gst_allocator_alloc (allocator, sizes[i], &params);
+    fail_unless (mem != NULL);
+    fail_unless (mem->allocator == allocator);
+    fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+
+    fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+    fail_unless (info.size == sizes[i]);
+    fail_unless (info.maxsize >= sizes[i] + 16);
+    /* the prefix starts at the aligned address */
+    fail_unless (((((guintptr) info.data) - 8) & 63) == 0);
+    memset (info.data, i, info.size);
+    gst_memory_unmap (mem, &info);
+
+    copy = gst_memory_copy (mem, 0, -1);
+    fail_unless (copy->allocator == allocator);
+    fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+    fail_unless (info.size == sizes[i]);
+    fail_unless (info.data[info.size - 1] == i);
+    gst_memory_unmap (copy, &info);
+    gst_memory_unref (copy);
+
+    sub = gst_memory_share (mem, 0, 1);
+    gst_memory_unref (mem);
+    fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+    fail_unless (info.data[0] == i);
+    gst_memory_unmap (sub, &info);
+    gst_memory_unref (sub);
+  }
+
+  /* the header of the memory does not count in the size class */
+  gst_allocation_params_init (&params);
+  mem = gst_allocator_alloc (allocator, 16, &params);
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+  fail_unless (info.maxsize >= 16);
+  fail_unless (info.maxsize <= MAX (64, 2 * (16 + gst_memory_alignment)));
+  gst_memory_unmap (mem, &info);
+  gst_memory_unref (mem);
+
+  /* blocks are recycled */
+  mem = gst_allocator_alloc (allocator, 100, NULL);
+  gst_memory_unref (mem);
+  copy = gst_allocator_alloc (allocator, 100, NULL);
+  fail_unless (copy == mem);
+  gst_memory_unref (copy);
+
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mmap_alloc)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem, *sub;
+  GstMapInfo info;
+  gsize offset;
+  gint fd;
+
+  allocator = gst_mmap_allocator_new (GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES |
+      GST_MMAP_ALLOCATOR_FLAG_PREFAULT);
+  if (allocator == NULL)
+    return;
+
+  gst_allocation_params_init (&params);
+  params.align = 255;
+  params.prefix = 16;
+
+  /* big enough to try huge pages, falls back to normal pages */
+  mem = gst_allocator_alloc (allocator, 4 * 1024 * 1024, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_is_mmap_memory (mem));
+  fail_unless (gst_mmap_memory_get_fd (mem, NULL) == -1);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless (info.size == 4 * 1024 * 1024);
+  fail_unless (((((guintptr) info.data) - 16) & 255) == 0);
+  memset (info.data, 0xaa, info.size);
+  gst_memory_unmap (mem, &info);
+
+  sub = gst_memory_share (mem, 10, 10);
+  fail_unless (gst_is_mmap_memory (sub));
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0xaa);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+  gst_memory_unref (mem);
+  gst_object_unref (allocator);
+
+  /* memfd backed memory */
+  allocator = gst_mmap_allocator_new (GST_MMAP_ALLOCATOR_FLAG_MEMFD);
+  mem = gst_allocator_alloc (allocator, 1000, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  /* anonymous memory is zero filled */
+  fail_unless (info.data[0] == 0);
+  info.data[0] = 0x55;
+  gst_memory_unmap (mem, &info);
+
+  fd = gst_mmap_memory_get_fd (mem, &offset);
+#ifdef HAVE_UNISTD_H
+  if (fd >= 0) {
+    guint8 val = 0;
+
+    fail_unless (offset == 16);
+    fail_unless (pread (fd, &val, 1, offset) == 1);
+    fail_unless (val == 0x55);
+  }
+#endif
+  gst_memory_unref (mem);
+  gst_object_unref (allocator);
+
+  /* the registered allocator */
+  allocator = gst_allocator_find (GST_ALLOCATOR_MMAP);
+  fail_unless (allocator != NULL);
+  mem = gst_allocator_alloc (allocator, 100, NULL);
+  fail_unless (gst_is_mmap_memory (mem));
+  /* plain anonymous memory, no memfd */
+  fail_unless (gst_mmap_memory_get_fd (mem, NULL) == -1);
+  gst_memory_unref (mem);
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_numa_alloc)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem;
+  guint64 allocated = 0, first_page_local = 0;
+
+  gst_allocation_params_init (&params);
+  fail_unless_equals_int (gst_allocation_params_get_numa_node (&params), -1);
+  gst_allocation_params_set_numa_node (&params, 0);
+  fail_unless_equals_int (gst_allocation_params_get_numa_node (&params), 0);
+
+  allocator = gst_mmap_allocator_new (GST_MMAP_ALLOCATOR_FLAG_PREFAULT);
+  if (allocator == NULL)
+    return;
+
+  fail_unless (gst_mmap_allocator_get_numa_stats (allocator, 0, &allocated,
+          &first_page_local));
+  fail_unless (allocated == 0);
+
+  mem = gst_allocator_alloc (allocator, 100000, &params);
+  fail_unless (mem != NULL);
+  gst_memory_unref (mem);
+
+  fail_unless (gst_mmap_allocator_get_numa_stats (allocator, 0, &allocated,
+          &first_page_local));
+  fail_unless (allocated >= 100000);
+  fail_unless (first_page_local <= allocated);
+
+  /* not an mmap allocator */
+  gst_object_unref (allocator);
+  allocator = gst_allocator_find (GST_ALLOCATOR_SYSMEM);
+  fail_if (gst_mmap_allocator_get_numa_stats (allocator, 0, NULL, NULL));
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_memory_suite (void)
@@ -526,6 +711,9 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_map_nested);
   tcase_add_test (tc_chain, test_map_resize);
+  tcase_add_test (tc_chain, test_slab_alloc);
+  tcase_add_test (tc_chain, test_mmap_alloc);
+  tcase_add_test (tc_chain, test_numa_alloc);
 
   return s;
 }
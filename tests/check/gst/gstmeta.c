@@ -245,6 +245,121 @@ GST_START_TEST (test_meta_locked)
 
 GST_END_TEST;
 
+GST_START_TEST (test_meta_reserve)
+{
+  const GstMetaInfo *infos[1];
+  GstBuffer *buffer, *copy;
+  GstMetaTest *meta, *meta2;
+
+  infos[0] = GST_META_TEST_INFO;
+  buffer = gst_buffer_new_reserve_meta (infos, 1);
+  fail_if (buffer == NULL);
+
+  /* first meta uses the reserved space, right after the buffer */
+  meta = GST_META_TEST_ADD (buffer);
+  fail_if (meta == NULL);
+  fail_unless ((guint8 *) meta > (guint8 *) buffer);
+  meta->pts = 1000;
+  meta->dts = 2000;
+  meta->duration = 1000;
+  meta->clock_rate = 1000;
+
+  /* second one does not fit anymore */
+  meta2 = GST_META_TEST_ADD (buffer);
+  fail_if (meta2 == NULL);
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta2));
+
+  meta = GST_META_TEST_GET (buffer);
+  fail_if (meta == NULL);
+  fail_if (meta->pts != 1000);
+
+  copy = gst_buffer_copy (buffer);
+  meta2 = GST_META_TEST_GET (copy);
+  fail_if (meta2 == NULL);
+  fail_if (meta2->dts != 2000);
+  gst_buffer_unref (copy);
+
+  /* removing the reserved meta makes room for a new one */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta));
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  meta2 = GST_META_TEST_ADD (buffer);
+  fail_unless (meta2 == meta);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static gboolean
+foreach_meta_remove_first (GstBuffer * buffer, GstMeta ** meta,
+    gpointer user_data)
+{
+  if (*meta == user_data)
+    *meta = NULL;
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_lookup)
+{
+  GstBuffer *buffer;
+  GstMetaTest *meta1, *meta2;
+  GstMetaInfo static_info = { 0, };
+  gpointer state = NULL;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_if (buffer == NULL);
+
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (gst_buffer_iterate_meta_filtered (buffer, &state,
+          GST_META_TEST_API_TYPE) == NULL);
+
+  meta1 = GST_META_TEST_ADD (buffer);
+  meta2 = GST_META_TEST_ADD (buffer);
+  fail_if (meta1 == NULL || meta2 == NULL);
+
+  /* the last added meta is found first */
+  fail_unless (GST_META_TEST_GET (buffer) == meta2);
+
+  state = NULL;
+  fail_unless (gst_buffer_iterate_meta_filtered (buffer, &state,
+          GST_META_TEST_API_TYPE) == (GstMeta *) meta2);
+  fail_unless (gst_buffer_iterate_meta_filtered (buffer, &state,
+          GST_META_TEST_API_TYPE) == (GstMeta *) meta1);
+  fail_unless (gst_buffer_iterate_meta_filtered (buffer, &state,
+          GST_META_TEST_API_TYPE) == NULL);
+
+  state = NULL;
+  fail_unless (gst_buffer_iterate_meta_filtered (buffer, &state,
+          GST_TYPE_CAPS) == NULL);
+
+  /* removing the first one makes the other one visible */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta2));
+  fail_unless (GST_META_TEST_GET (buffer) == meta1);
+
+  meta2 = GST_META_TEST_ADD (buffer);
+  fail_unless (GST_META_TEST_GET (buffer) == meta2);
+  fail_unless (gst_buffer_foreach_meta (buffer, foreach_meta_remove_first,
+          meta2));
+  fail_unless (GST_META_TEST_GET (buffer) == meta1);
+
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta1));
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+
+  /* a meta info that was not created with gst_meta_register() */
+  static_info.api = GST_META_TEST_API_TYPE;
+  static_info.type = G_TYPE_POINTER;
+  static_info.size = sizeof (GstMetaTest);
+  meta1 = (GstMetaTest *) gst_buffer_add_meta (buffer, &static_info, NULL);
+  fail_if (meta1 == NULL);
+  fail_unless (GST_META_TEST_GET (buffer) == meta1);
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta1));
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffermeta_suite (void)
 {
@@ -254,6 +369,8 @@ gst_buffermeta_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_meta_test);
   tcase_add_test (tc_chain, test_meta_locked);
+  tcase_add_test (tc_chain, test_meta_reserve);
+  tcase_add_test (tc_chain, test_meta_lookup);
 
   return s;
 }
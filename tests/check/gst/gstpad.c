@@ -1714,6 +1714,535 @@ GST_START_TEST (test_sticky_events)
 
 GST_END_TEST;
 
+static gint accept_caps_count;
+
+static gboolean
+test_accept_caps_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ACCEPT_CAPS)
+    accept_caps_count++;
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static void
+push_caps_string (GstPad * pad, const gchar * str)
+{
+  GstCaps *caps;
+
+  caps = gst_caps_from_string (str);
+  fail_unless (gst_pad_push_event (pad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_skipped_negotiations)
+{
+  GstPad *srcpad, *sinkpad;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_query_function (sinkpad, test_accept_caps_query);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (srcpad, sinkpad)));
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")) == TRUE);
+
+  accept_caps_count = 0;
+  push_caps_string (srcpad, "foo/bar, width=(int)320");
+  fail_unless_equals_int (accept_caps_count, 1);
+  fail_unless_equals_int (gst_pad_get_skipped_negotiations (sinkpad), 0);
+
+  /* equal fixed caps are not queried again */
+  push_caps_string (srcpad, "foo/bar, width=(int)320");
+  fail_unless_equals_int (accept_caps_count, 1);
+  fail_unless_equals_int (gst_pad_get_skipped_negotiations (sinkpad), 1);
+
+  push_caps_string (srcpad, "foo/bar, width=(int)640");
+  fail_unless_equals_int (accept_caps_count, 2);
+  push_caps_string (srcpad, "foo/bar, width=(int)640");
+  fail_unless_equals_int (accept_caps_count, 2);
+  fail_unless_equals_int (gst_pad_get_skipped_negotiations (sinkpad), 2);
+
+  /* reconfiguration forgets the accepted caps */
+  gst_pad_mark_reconfigure (sinkpad);
+  push_caps_string (srcpad, "foo/bar, width=(int)640");
+  fail_unless_equals_int (accept_caps_count, 3);
+
+  /* unfixed caps are always queried */
+  push_caps_string (srcpad, "foo/bar, width=(int)[ 1, 10 ]");
+  push_caps_string (srcpad, "foo/bar, width=(int)[ 1, 10 ]");
+  fail_unless_equals_int (accept_caps_count, 5);
+  fail_unless_equals_int (gst_pad_get_skipped_negotiations (sinkpad), 2);
+
+  /* relinking forgets the accepted caps */
+  push_caps_string (srcpad, "foo/bar, width=(int)320");
+  fail_unless_equals_int (accept_caps_count, 6);
+  fail_unless (gst_pad_unlink (srcpad, sinkpad));
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (srcpad, sinkpad)));
+  push_caps_string (srcpad, "foo/bar, width=(int)320");
+  fail_unless_equals_int (accept_caps_count, 7);
+  fail_unless_equals_int (gst_pad_get_skipped_negotiations (sinkpad), 2);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_probe (GstPad * pad, GstPadProbeInfo * info, gpointer userdata)
+{
+  gint *count = userdata;
+
+  *count += 1;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstFlowReturn
+push_new_buffer (GstPad * pad)
+{
+  return gst_pad_push (pad, gst_buffer_new ());
+}
+
+GST_START_TEST (test_push_steady_state)
+{
+  GstPad *src, *sink;
+  gint count = 0;
+  gulong id;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  fail_if (src == NULL);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_if (sink == NULL);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  /* the first buffer takes the slow path, the others can skip the checks */
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  ASSERT_OBJECT_REFCOUNT (sink, "sink", 1);
+
+  /* new probes are called for the next buffer */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER, count_probe,
+      &count, NULL);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (count, 1);
+  gst_pad_remove_probe (src, id);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (count, 1);
+
+  id = gst_pad_add_probe (sink, GST_PAD_PROBE_TYPE_BUFFER, count_probe,
+      &count, NULL);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (count, 2);
+  gst_pad_remove_probe (sink, id);
+  fail_unless_equals_int (g_list_length (buffers), 7);
+
+  /* new sticky events are sent before the next buffer */
+  fail_unless (gst_pad_store_sticky_event (src,
+          gst_event_new_tag (gst_tag_list_new_empty ())) == GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless (gst_pad_get_sticky_event (sink, GST_EVENT_TAG, 0) != NULL);
+  gst_event_unref (gst_pad_get_sticky_event (sink, GST_EVENT_TAG, 0));
+
+  /* flushing is noticed */
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_start ()));
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_FLUSHING);
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_stop (TRUE)));
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 10);
+
+  /* and so is unlinking */
+  fail_unless (gst_pad_unlink (src, sink));
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_NOT_LINKED);
+  ASSERT_OBJECT_REFCOUNT (sink, "sink", 1);
+
+  gst_check_drop_buffers ();
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+static gint chained_lists, chained_buffers;
+
+static GstFlowReturn
+count_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  chained_buffers++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+count_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  chained_lists++;
+  chained_buffers += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+forward_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  return gst_pad_push (gst_pad_get_element_private (pad), buffer);
+}
+
+static GstPad *
+new_active_pad (const gchar * name, GstPadDirection direction)
+{
+  GstPad *pad = gst_pad_new (name, direction);
+
+  gst_pad_set_active (pad, TRUE);
+
+  return pad;
+}
+
+static void
+start_stream (GstPad * src)
+{
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+}
+
+static GstBuffer *
+new_timestamped_buffer (GstClockTime pts)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buffer) = pts;
+
+  return buffer;
+}
+
+GST_START_TEST (test_push_batching)
+{
+  GstPad *src, *sink, *midsink, *midsrc;
+  GstBufferList *list;
+  gint i;
+
+  src = new_active_pad ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, count_chain);
+  gst_pad_set_chain_list_function (sink, count_chain_list);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  start_stream (src);
+
+  chained_lists = chained_buffers = 0;
+  gst_pad_set_batching (src, 4, GST_CLOCK_TIME_NONE);
+
+  /* buffers are pushed as a list when the batch is full */
+  for (i = 0; i < 3; i++)
+    fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_buffers, 0);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 1);
+  fail_unless_equals_int (chained_buffers, 4);
+
+  /* and before serialized events */
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+  fail_unless_equals_int (chained_lists, 2);
+  fail_unless_equals_int (chained_buffers, 5);
+
+  /* and on request */
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push_batch (src), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push_batch (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 3);
+  fail_unless_equals_int (chained_buffers, 6);
+
+  /* or when the timestamps span the latency */
+  gst_pad_set_batching (src, 10, GST_SECOND);
+  fail_unless_equals_int (gst_pad_push (src, new_timestamped_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (src,
+          new_timestamped_buffer (GST_SECOND / 2)), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 3);
+  fail_unless_equals_int (gst_pad_push (src,
+          new_timestamped_buffer (GST_SECOND)), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 4);
+  fail_unless_equals_int (chained_buffers, 9);
+
+  /* flushing drops the batch */
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_stop (TRUE)));
+  fail_unless_equals_int (gst_pad_push_batch (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_buffers, 9);
+
+  /* or when the latency passed since the batch was started */
+  gst_pad_set_batching (src, 10, 10 * GST_MSECOND);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  g_usleep (20 * G_TIME_SPAN_MILLISECOND);
+  fail_unless_equals_int (chained_buffers, 9);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_buffers, 11);
+
+  /* a list-unaware element gets the buffers of a list one by one and its
+   * output is coalesced into one list */
+  gst_pad_unlink (src, sink);
+  midsink = gst_pad_new ("midsink", GST_PAD_SINK);
+  midsrc = new_active_pad ("midsrc", GST_PAD_SRC);
+  gst_pad_set_chain_function (midsink, forward_chain);
+  gst_pad_set_element_private (midsink, midsrc);
+  gst_pad_set_active (midsink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, midsink)));
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (midsrc, sink)));
+  start_stream (src);
+  start_stream (midsrc);
+
+  gst_pad_set_batching (src, 0, GST_CLOCK_TIME_NONE);
+  gst_pad_set_batching (midsrc, 100, GST_CLOCK_TIME_NONE);
+  chained_lists = chained_buffers = 0;
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 5; i++)
+    gst_buffer_list_add (list, gst_buffer_new ());
+  fail_unless_equals_int (gst_pad_push_list (src, list), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 1);
+  fail_unless_equals_int (chained_buffers, 5);
+
+  gst_pad_set_batching (midsrc, 0, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 1);
+  fail_unless_equals_int (chained_buffers, 6);
+
+  gst_object_unref (src);
+  gst_object_unref (sink);
+  gst_object_unref (midsrc);
+  gst_object_unref (midsink);
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+error_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_ERROR;
+}
+
+/* a batch that fails before a serialized event fails the event */
+GST_START_TEST (test_push_batching_error)
+{
+  GstPad *src, *sink;
+  GstEvent *event;
+
+  src = new_active_pad ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, count_chain);
+  gst_pad_set_chain_list_function (sink, error_chain_list);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  start_stream (src);
+
+  gst_pad_set_batching (src, 4, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+
+  /* the EOS does not reach the peer after its buffers went missing */
+  fail_if (gst_pad_push_event (src, gst_event_new_eos ()));
+  event = gst_pad_get_sticky_event (sink, GST_EVENT_EOS, 0);
+  fail_unless (event == NULL);
+
+  /* the error is reported once more and then cleared */
+  fail_unless_equals_int (gst_pad_push_batch (src), GST_FLOW_ERROR);
+  fail_unless_equals_int (gst_pad_push_batch (src), GST_FLOW_OK);
+
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_probe_mask)
+{
+  GstPad *src, *sink;
+  gint event_count = 0, buffer_count = 0;
+  gulong event_id, buffer_id, block_id;
+
+  src = new_active_pad ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  start_stream (src);
+
+  /* event probes are not called for buffers */
+  event_id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      count_probe, &event_count, NULL);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (event_count, 0);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+  fail_unless_equals_int (event_count, 1);
+
+  /* a buffer probe added next to it is */
+  buffer_id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER,
+      count_probe, &buffer_count, NULL);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (buffer_count, 1);
+  fail_unless_equals_int (event_count, 1);
+
+  /* until it is removed */
+  gst_pad_remove_probe (src, buffer_id);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (buffer_count, 1);
+
+  /* blocking on events does not block buffers */
+  block_id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BLOCK |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, count_probe, &event_count, NULL);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (event_count, 1);
+  fail_unless_equals_int (g_list_length (buffers), 6);
+  gst_pad_remove_probe (src, block_id);
+
+  gst_pad_remove_probe (src, event_id);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+  fail_unless_equals_int (event_count, 1);
+
+  gst_check_drop_buffers ();
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+static GArray *received_types;
+
+static gboolean
+record_event_handler (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstEventType type = GST_EVENT_TYPE (event);
+
+  g_array_append_val (received_types, type);
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static GstEvent *
+new_custom_sticky (gint i, gint value)
+{
+  gchar *name = g_strdup_printf ("custom-%d", i);
+  GstEvent *event;
+
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM_STICKY,
+      gst_structure_new (name, "value", G_TYPE_INT, value, NULL));
+  g_free (name);
+
+  return event;
+}
+
+GST_START_TEST (test_sticky_events_pending)
+{
+  GstPad *src, *sink;
+  GstEvent *event;
+  GstCaps *caps;
+  gint i, value;
+
+  src = new_active_pad ("src", GST_PAD_SRC);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_stream_start ("test")) == TRUE);
+  for (i = 0; i < 10; i++)
+    fail_unless (gst_pad_push_event (src, new_custom_sticky (i, 0)) == TRUE);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_tag (gst_tag_list_new_empty ())) == TRUE);
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  fail_unless (gst_pad_push_event (src, gst_event_new_caps (caps)) == TRUE);
+  gst_caps_unref (caps);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  /* the stored events can be found by type and index */
+  for (i = 0; i < 10; i++) {
+    event = gst_pad_get_sticky_event (src,
+        GST_EVENT_CUSTOM_DOWNSTREAM_STICKY, i);
+    fail_unless (event != NULL);
+    gst_event_unref (event);
+  }
+  fail_unless (gst_pad_get_sticky_event (src,
+          GST_EVENT_CUSTOM_DOWNSTREAM_STICKY, 10) == NULL);
+  fail_unless (gst_pad_get_sticky_event (src, GST_EVENT_EOS, 0) == NULL);
+
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+  gst_pad_set_event_function (sink, record_event_handler);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+
+  /* all events are sent in the order of their types */
+  received_types = g_array_new (FALSE, FALSE, sizeof (GstEventType));
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (received_types->len, 14);
+  fail_unless_equals_int (g_array_index (received_types, GstEventType, 0),
+      GST_EVENT_STREAM_START);
+  fail_unless_equals_int (g_array_index (received_types, GstEventType, 1),
+      GST_EVENT_CAPS);
+  fail_unless_equals_int (g_array_index (received_types, GstEventType, 2),
+      GST_EVENT_SEGMENT);
+  fail_unless_equals_int (g_array_index (received_types, GstEventType, 3),
+      GST_EVENT_TAG);
+  for (i = 4; i < 14; i++)
+    fail_unless_equals_int (g_array_index (received_types, GstEventType, i),
+        GST_EVENT_CUSTOM_DOWNSTREAM_STICKY);
+
+  /* only the replaced event is sent again */
+  g_array_set_size (received_types, 0);
+  fail_unless (gst_pad_store_sticky_event (src,
+          new_custom_sticky (5, 1)) == GST_FLOW_OK);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (received_types->len, 1);
+  fail_unless_equals_int (push_new_buffer (src), GST_FLOW_OK);
+  fail_unless_equals_int (received_types->len, 1);
+
+  event = gst_pad_get_sticky_event (src, GST_EVENT_CUSTOM_DOWNSTREAM_STICKY,
+      5);
+  fail_unless (gst_structure_get_int (gst_event_get_structure (event),
+          "value", &value));
+  fail_unless_equals_int (value, 1);
+  gst_event_unref (event);
+
+  g_array_free (received_types, TRUE);
+  gst_check_drop_buffers ();
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_pad_suite (void)
 {
@@ -1756,6 +2285,12 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
   tcase_add_test (tc_chain, test_sticky_events);
+  tcase_add_test (tc_chain, test_skipped_negotiations);
+  tcase_add_test (tc_chain, test_push_steady_state);
+  tcase_add_test (tc_chain, test_push_batching);
+  tcase_add_test (tc_chain, test_push_batching_error);
+  tcase_add_test (tc_chain, test_probe_mask);
+  tcase_add_test (tc_chain, test_sticky_events_pending);
 
   return s;
 }
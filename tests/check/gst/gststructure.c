@@ -607,6 +607,149 @@ GST_START_TEST (test_vararg_getters)
 
 GST_END_TEST;
 
+GST_START_TEST (test_many_fields)
+{
+  GstStructure *s;
+  gchar name[16];
+  gint i, val;
+
+  s = gst_structure_new_empty ("test/many");
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_set (s, name, G_TYPE_INT, i, NULL);
+    /* lookups in between build the index */
+    fail_unless (gst_structure_get_int (s, "field0", &val));
+    fail_unless_equals_int (val, 0);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, i);
+  }
+  fail_if (gst_structure_has_field (s, "field100"));
+
+  /* replacing keeps the position */
+  gst_structure_set (s, "field50", G_TYPE_INT, 500, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+  fail_unless_equals_string (gst_structure_nth_field_name (s, 50), "field50");
+  fail_unless (gst_structure_get_int (s, "field50", &val));
+  fail_unless_equals_int (val, 500);
+
+  /* removing keeps the insertion order */
+  for (i = 0; i < 100; i += 2) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_remove_field (s, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 50);
+  for (i = 0; i < 50; i++) {
+    g_snprintf (name, sizeof (name), "field%d", 2 * i + 1);
+    fail_unless_equals_string (gst_structure_nth_field_name (s, i), name);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, 2 * i + 1);
+    g_snprintf (name, sizeof (name), "field%d", 2 * i);
+    fail_if (gst_structure_has_field (s, name));
+  }
+
+  gst_structure_remove_all_fields (s);
+  fail_if (gst_structure_has_field (s, "field1"));
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_from_string_value_types)
+{
+  GstStructure *s;
+  const GValue *v;
+  gint num, den;
+  gboolean b;
+
+  s = gst_structure_from_string ("test, a=5, b=30/1, c=true, d=yes, "
+      "e=interleaved, f=1.5, g=0x10, h=max, i=1/max, j=\"5\", k=(string)foo, "
+      "l=(fraction)25, m=(int)-7, n=010, o=infinity, p=-2147483648, "
+      "r=(boolean)1;", NULL);
+  fail_unless (s != NULL);
+
+  fail_unless (gst_structure_get_int (s, "a", &num));
+  fail_unless_equals_int (num, 5);
+  fail_unless (gst_structure_get_fraction (s, "b", &num, &den));
+  fail_unless_equals_int (num, 30);
+  fail_unless_equals_int (den, 1);
+  fail_unless (gst_structure_get_boolean (s, "c", &b));
+  fail_unless (b);
+  fail_unless (gst_structure_get_boolean (s, "d", &b));
+  fail_unless (b);
+  fail_unless_equals_string (gst_structure_get_string (s, "e"), "interleaved");
+  v = gst_structure_get_value (s, "f");
+  fail_unless (G_VALUE_HOLDS_DOUBLE (v));
+  fail_unless (g_value_get_double (v) == 1.5);
+  fail_unless (gst_structure_get_int (s, "g", &num));
+  fail_unless_equals_int (num, 16);
+  fail_unless (gst_structure_get_int (s, "h", &num));
+  fail_unless_equals_int (num, G_MAXINT);
+  fail_unless (gst_structure_get_fraction (s, "i", &num, &den));
+  fail_unless_equals_int (num, 1);
+  fail_unless_equals_int (den, G_MAXINT);
+  /* quoted numbers are still numbers when no type is given */
+  fail_unless (gst_structure_get_int (s, "j", &num));
+  fail_unless_equals_int (num, 5);
+  fail_unless_equals_string (gst_structure_get_string (s, "k"), "foo");
+  fail_unless (gst_structure_get_fraction (s, "l", &num, &den));
+  fail_unless_equals_int (num, 25);
+  fail_unless_equals_int (den, 1);
+  fail_unless (gst_structure_get_int (s, "m", &num));
+  fail_unless_equals_int (num, -7);
+  /* octal notation */
+  fail_unless (gst_structure_get_int (s, "n", &num));
+  fail_unless_equals_int (num, 8);
+  fail_unless (G_VALUE_HOLDS_DOUBLE (gst_structure_get_value (s, "o")));
+  fail_unless (gst_structure_get_int (s, "p", &num));
+  fail_unless_equals_int (num, G_MININT);
+  fail_unless (gst_structure_get_boolean (s, "r", &b));
+  fail_unless (b);
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_serialization)
+{
+  GstStructure *s, *nested, *copy;
+  GstCaps *caps;
+  guint8 *data;
+  gsize size;
+
+  caps = gst_caps_from_string ("video/x-raw, width=(int)[ 16, 4096 ]");
+  nested = gst_structure_new ("stats", "bytes", G_TYPE_UINT64,
+      G_GUINT64_CONSTANT (1) << 40, "name", G_TYPE_STRING, "src", NULL);
+  s = gst_structure_new ("test", "nested", GST_TYPE_STRUCTURE, nested,
+      "caps", GST_TYPE_CAPS, caps, "rate", G_TYPE_DOUBLE, 1.25,
+      "framerate", GST_TYPE_FRACTION, 25, 1, NULL);
+  gst_structure_free (nested);
+  gst_caps_unref (caps);
+
+  data = gst_structure_to_binary (s, &size);
+  fail_unless (data != NULL);
+  copy = gst_structure_from_binary (data, size);
+  fail_unless (copy != NULL);
+  fail_unless (gst_structure_is_equal (s, copy));
+  /* field order is preserved */
+  fail_unless_equals_string (gst_structure_nth_field_name (copy, 2), "rate");
+  gst_structure_free (copy);
+
+  fail_if (gst_structure_from_binary (data, size - 1));
+  fail_if (gst_structure_from_binary (data, 0));
+  fail_if (gst_caps_from_binary (data, size));
+  g_free (data);
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -628,6 +771,9 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_structure_nested);
   tcase_add_test (tc_chain, test_structure_nested_from_and_to_string);
   tcase_add_test (tc_chain, test_vararg_getters);
+  tcase_add_test (tc_chain, test_many_fields);
+  tcase_add_test (tc_chain, test_from_string_value_types);
+  tcase_add_test (tc_chain, test_binary_serialization);
   return s;
 }
 
@@ -575,6 +575,8 @@ GST_START_TEST (test_serialization)
   GstSample *s1, *s2;
   GstCaps *c2;
   gchar *s;
+  guint8 *data;
+  gsize size;
 
   b1 = gst_buffer_new_allocate (NULL, 1, NULL);
   gst_buffer_memset (b1, 0, 0xb3, -1);
@@ -601,6 +603,15 @@ GST_START_TEST (test_serialization)
   gst_tag_list_unref (tags2);
   g_free (s);
 
+  data = gst_tag_list_to_binary (tags, &size);
+  fail_unless (data != NULL);
+  tags2 = gst_tag_list_new_from_binary (data, size);
+  fail_unless (tags2 != NULL);
+  fail_unless (gst_tag_list_is_equal (tags, tags2));
+  gst_tag_list_unref (tags2);
+  fail_if (gst_tag_list_new_from_binary (data, size - 1));
+  g_free (data);
+
   gst_sample_unref (s1);
   gst_sample_unref (s2);
   gst_tag_list_unref (tags);
@@ -190,6 +190,43 @@ GST_START_TEST (test_create)
 
 GST_END_TEST;
 
+static GMutex pool_mutex;
+static GCond pool_cond;
+
+static void
+pool_func (gpointer data)
+{
+  g_mutex_lock (&pool_mutex);
+  *(gboolean *) data = TRUE;
+  g_cond_signal (&pool_cond);
+  g_mutex_unlock (&pool_mutex);
+}
+
+GST_START_TEST (test_pool_numa_node)
+{
+  GstTaskPool *pool;
+  gboolean done = FALSE;
+
+  pool = gst_task_pool_new ();
+  fail_unless_equals_int (gst_task_pool_get_numa_node (pool), -1);
+  gst_task_pool_set_numa_node (pool, 0);
+  fail_unless_equals_int (gst_task_pool_get_numa_node (pool), 0);
+
+  gst_task_pool_prepare (pool, NULL);
+
+  /* node 0 always exists, the task should run pinned to it */
+  g_mutex_lock (&pool_mutex);
+  gst_task_pool_push (pool, pool_func, &done, NULL);
+  while (!done)
+    g_cond_wait (&pool_cond, &pool_mutex);
+  g_mutex_unlock (&pool_mutex);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_task_suite (void)
@@ -203,6 +240,7 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_lock);
   tcase_add_test (tc_chain, test_lock_start);
   tcase_add_test (tc_chain, test_join);
+  tcase_add_test (tc_chain, test_pool_numa_node);
 
   return s;
 }
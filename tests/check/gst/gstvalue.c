@@ -2806,6 +2806,281 @@ GST_START_TEST (test_stepped_int_range_ops)
 
 GST_END_TEST;
 
+GST_START_TEST (test_hash)
+{
+  GValue v1 = { 0, };
+  GValue v2 = { 0, };
+  GValue item = { 0, };
+
+  /* unordered lists */
+  g_value_init (&v1, GST_TYPE_LIST);
+  g_value_init (&v2, GST_TYPE_LIST);
+  g_value_init (&item, G_TYPE_STRING);
+  g_value_set_static_string (&item, "I420");
+  gst_value_list_append_value (&v1, &item);
+  g_value_set_static_string (&item, "YV12");
+  gst_value_list_append_value (&v1, &item);
+  gst_value_list_append_value (&v2, &item);
+  g_value_set_static_string (&item, "I420");
+  gst_value_list_append_value (&v2, &item);
+  fail_unless (gst_value_compare (&v1, &v2) == GST_VALUE_EQUAL);
+  fail_unless_equals_int (gst_value_hash (&v1), gst_value_hash (&v2));
+  g_value_unset (&v2);
+
+  /* a list with one item is equal to the item */
+  g_value_init (&v2, GST_TYPE_LIST);
+  gst_value_list_append_value (&v2, &item);
+  fail_unless (gst_value_compare (&v2, &item) == GST_VALUE_EQUAL);
+  fail_unless_equals_int (gst_value_hash (&v2), gst_value_hash (&item));
+  g_value_unset (&v2);
+  g_value_unset (&v1);
+  g_value_unset (&item);
+
+  /* a list of integers can be equal to a range */
+  g_value_init (&v1, GST_TYPE_LIST);
+  g_value_init (&item, G_TYPE_INT);
+  g_value_set_int (&item, 2);
+  gst_value_list_append_value (&v1, &item);
+  g_value_set_int (&item, 4);
+  gst_value_list_append_value (&v1, &item);
+  g_value_init (&v2, GST_TYPE_INT_RANGE);
+  gst_value_set_int_range_step (&v2, 2, 4, 2);
+  fail_unless (gst_value_compare (&v1, &v2) == GST_VALUE_EQUAL);
+  fail_unless_equals_int (gst_value_hash (&v1), gst_value_hash (&v2));
+  g_value_unset (&v2);
+  g_value_unset (&v1);
+  g_value_unset (&item);
+
+  /* equal fractions */
+  g_value_init (&v1, GST_TYPE_FRACTION);
+  g_value_init (&v2, GST_TYPE_FRACTION);
+  gst_value_set_fraction (&v1, 1, 2);
+  gst_value_set_fraction (&v2, 2, 4);
+  fail_unless_equals_int (gst_value_hash (&v1), gst_value_hash (&v2));
+  gst_value_set_fraction (&v2, 1, 3);
+  fail_if (gst_value_hash (&v1) == gst_value_hash (&v2));
+  g_value_unset (&v2);
+  g_value_unset (&v1);
+
+  /* -0.0 and 0.0 */
+  g_value_init (&v1, G_TYPE_DOUBLE);
+  g_value_init (&v2, G_TYPE_DOUBLE);
+  g_value_set_double (&v1, 0.0);
+  g_value_set_double (&v2, -0.0);
+  fail_unless (gst_value_compare (&v1, &v2) == GST_VALUE_EQUAL);
+  fail_unless_equals_int (gst_value_hash (&v1), gst_value_hash (&v2));
+  g_value_unset (&v2);
+  g_value_unset (&v1);
+}
+
+GST_END_TEST;
+
+static void
+check_binary_round_trip (const GValue * value)
+{
+  GValue copy = { 0, };
+  guint8 *data;
+  gsize size;
+
+  data = gst_value_to_binary (value, &size);
+  fail_unless (data != NULL);
+  fail_unless (gst_value_from_binary (&copy, data, size));
+  fail_unless (G_VALUE_TYPE (&copy) == G_VALUE_TYPE (value));
+  fail_unless (gst_value_compare (&copy, value) == GST_VALUE_EQUAL);
+
+  /* truncated data must be rejected */
+  while (size-- > 0) {
+    GValue v = { 0, };
+
+    fail_if (gst_value_from_binary (&v, data, size));
+    fail_if (G_IS_VALUE (&v));
+  }
+  g_free (data);
+  g_value_unset (&copy);
+}
+
+GST_START_TEST (test_dispatch)
+{
+  GValue i = { 0 }, r = { 0 }, f = { 0 }, f2 = { 0 }, s = { 0 }, dest = { 0 };
+
+  g_value_init (&i, G_TYPE_INT);
+  g_value_set_int (&i, 5);
+  g_value_init (&r, GST_TYPE_INT_RANGE);
+  gst_value_set_int_range (&r, 0, 10);
+  g_value_init (&s, G_TYPE_STRING);
+  g_value_set_string (&s, "foo");
+
+  /* functions registered for (int, int range) also apply when swapped */
+  fail_unless (gst_value_can_union (&i, &r));
+  fail_unless (gst_value_can_union (&r, &i));
+  fail_unless (gst_value_union (&dest, &r, &i));
+  fail_unless (GST_VALUE_HOLDS_INT_RANGE (&dest));
+  fail_unless_equals_int (gst_value_get_int_range_min (&dest), 0);
+  fail_unless_equals_int (gst_value_get_int_range_max (&dest), 10);
+  g_value_unset (&dest);
+
+  fail_unless (gst_value_can_intersect (&r, &i));
+  fail_unless (gst_value_intersect (&dest, &r, &i));
+  fail_unless (G_VALUE_HOLDS_INT (&dest));
+  fail_unless_equals_int (g_value_get_int (&dest), 5);
+  g_value_unset (&dest);
+
+  /* subtraction is not symmetric */
+  fail_unless (gst_value_can_subtract (&i, &r));
+  fail_if (gst_value_subtract (&dest, &i, &r));
+  fail_unless (gst_value_subtract (&dest, &r, &i));
+  fail_unless (GST_VALUE_HOLDS_LIST (&dest));
+  g_value_unset (&dest);
+
+  /* no registered functions */
+  fail_if (gst_value_can_union (&i, &s));
+  fail_if (gst_value_can_intersect (&i, &s));
+  fail_if (gst_value_intersect (NULL, &i, &s));
+
+  /* types derived from a registered type resolve to its compare function,
+   * also the second time when it is cached */
+  g_value_init (&f, GST_TYPE_FORMAT);
+  g_value_set_enum (&f, GST_FORMAT_TIME);
+  g_value_init (&f2, GST_TYPE_FORMAT);
+  g_value_set_enum (&f2, GST_FORMAT_BYTES);
+  fail_unless (gst_value_can_compare (&f, &f2));
+  fail_unless (gst_value_compare (&f, &f2) == GST_VALUE_GREATER_THAN);
+  fail_unless (gst_value_compare (&f, &f) == GST_VALUE_EQUAL);
+  fail_unless (gst_value_can_compare (&f, &f2));
+
+  g_value_unset (&i);
+  g_value_unset (&r);
+  g_value_unset (&s);
+  g_value_unset (&f);
+  g_value_unset (&f2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_serialization)
+{
+  GValue v = { 0, };
+  GValue item = { 0, };
+  guint8 *data;
+  gsize size;
+  gint i;
+
+  g_value_init (&v, G_TYPE_INT);
+  g_value_set_int (&v, G_MININT);
+  check_binary_round_trip (&v);
+  g_value_set_int (&v, -1);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, G_TYPE_UINT64);
+  g_value_set_uint64 (&v, G_MAXUINT64);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, G_TYPE_BOOLEAN);
+  g_value_set_boolean (&v, TRUE);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, G_TYPE_DOUBLE);
+  g_value_set_double (&v, 0.1);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, G_TYPE_FLOAT);
+  g_value_set_float (&v, -1.5);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, G_TYPE_STRING);
+  g_value_set_static_string (&v, "hello, \"world\" ;");
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_STATE);
+  g_value_set_enum (&v, GST_STATE_PAUSED);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_SEEK_FLAGS);
+  g_value_set_flags (&v, GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_FRACTION);
+  gst_value_set_fraction (&v, -30000, 1001);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_INT_RANGE);
+  gst_value_set_int_range_step (&v, -16, 64, 8);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_INT64_RANGE);
+  gst_value_set_int64_range (&v, G_MININT64, G_MAXINT64);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_DOUBLE_RANGE);
+  gst_value_set_double_range (&v, -1.0, 2.5);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_FRACTION_RANGE);
+  gst_value_set_fraction_range_full (&v, 0, 1, G_MAXINT, 1);
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  g_value_init (&v, GST_TYPE_BITMASK);
+  gst_value_set_bitmask (&v, G_GUINT64_CONSTANT (0x8000000000000003));
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  /* nested lists and arrays */
+  g_value_init (&v, GST_TYPE_ARRAY);
+  g_value_init (&item, GST_TYPE_LIST);
+  for (i = 0; i < 3; i++) {
+    GValue s = { 0, };
+
+    g_value_init (&s, G_TYPE_STRING);
+    g_value_take_string (&s, g_strdup_printf ("item%d", i));
+    gst_value_list_append_value (&item, &s);
+    gst_value_array_append_value (&v, &s);
+    g_value_unset (&s);
+  }
+  gst_value_array_append_value (&v, &item);
+  check_binary_round_trip (&item);
+  check_binary_round_trip (&v);
+  g_value_unset (&item);
+  g_value_unset (&v);
+
+  /* types without native encoding use the string form */
+  g_value_init (&v, GST_TYPE_DATE_TIME);
+  g_value_take_boxed (&v, gst_date_time_new (0.0, 2013, 5, 16, 10, 30, 15.0));
+  check_binary_round_trip (&v);
+  g_value_unset (&v);
+
+  /* corrupt data */
+  g_value_init (&v, G_TYPE_INT);
+  g_value_set_int (&v, 1);
+  data = gst_value_to_binary (&v, &size);
+  g_value_unset (&v);
+  data[0] = 'X';
+  fail_if (gst_value_from_binary (&v, data, size));
+  data[0] = 'G';
+  data[2] = 0xff;
+  fail_if (gst_value_from_binary (&v, data, size));
+  data[2] = 1;
+  fail_unless (gst_value_from_binary (&v, data, size));
+  g_value_unset (&v);
+  data[4] = 0xff;
+  fail_if (gst_value_from_binary (&v, data, size));
+  g_free (data);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_value_suite (void)
 {
@@ -2848,6 +3123,9 @@ gst_value_suite (void)
   tcase_add_test (tc_chain, test_stepped_range_collection);
   tcase_add_test (tc_chain, test_stepped_int_range_parsing);
   tcase_add_test (tc_chain, test_stepped_int_range_ops);
+  tcase_add_test (tc_chain, test_hash);
+  tcase_add_test (tc_chain, test_dispatch);
+  tcase_add_test (tc_chain, test_binary_serialization);
 
   return s;
 }
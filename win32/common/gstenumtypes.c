@@ -45,6 +45,30 @@ gst_allocator_flags_get_type (void)
   return (GType) id;
 }
 
+GType
+gst_mmap_allocator_flags_get_type (void)
+{
+  static gsize id = 0;
+  static const GFlagsValue values[] = {
+    {C_FLAGS (GST_MMAP_ALLOCATOR_FLAG_NONE), "GST_MMAP_ALLOCATOR_FLAG_NONE",
+        "none"},
+    {C_FLAGS (GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES),
+        "GST_MMAP_ALLOCATOR_FLAG_HUGE_PAGES", "huge-pages"},
+    {C_FLAGS (GST_MMAP_ALLOCATOR_FLAG_MEMFD), "GST_MMAP_ALLOCATOR_FLAG_MEMFD",
+        "memfd"},
+    {C_FLAGS (GST_MMAP_ALLOCATOR_FLAG_PREFAULT),
+        "GST_MMAP_ALLOCATOR_FLAG_PREFAULT", "prefault"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_flags_register_static ("GstMmapAllocatorFlags", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
 /* enumerations from "gstbin.h" */
 GType
 gst_bin_flags_get_type (void)
@@ -814,6 +838,31 @@ gst_iterator_item_get_type (void)
   return (GType) id;
 }
 
+/* enumerations from "gstatomicqueue.h" */
+GType
+gst_atomic_queue_flags_get_type (void)
+{
+  static gsize id = 0;
+  static const GFlagsValue values[] = {
+    {C_FLAGS (GST_ATOMIC_QUEUE_FLAG_NONE), "GST_ATOMIC_QUEUE_FLAG_NONE",
+        "none"},
+    {C_FLAGS (GST_ATOMIC_QUEUE_FLAG_BOUNDED), "GST_ATOMIC_QUEUE_FLAG_BOUNDED",
+        "bounded"},
+    {C_FLAGS (GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER),
+        "GST_ATOMIC_QUEUE_FLAG_SINGLE_PRODUCER", "single-producer"},
+    {C_FLAGS (GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER),
+        "GST_ATOMIC_QUEUE_FLAG_SINGLE_CONSUMER", "single-consumer"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_flags_register_static ("GstAtomicQueueFlags", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
 /* enumerations from "gstmessage.h" */
 GType
 gst_message_type_get_type (void)
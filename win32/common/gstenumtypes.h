@@ -15,6 +15,8 @@ GType gst_object_flags_get_type (void);
 /* enumerations from "gstallocator.h" */
 GType gst_allocator_flags_get_type (void);
 #define GST_TYPE_ALLOCATOR_FLAGS (gst_allocator_flags_get_type())
+GType gst_mmap_allocator_flags_get_type (void);
+#define GST_TYPE_MMAP_ALLOCATOR_FLAGS (gst_mmap_allocator_flags_get_type())
 
 /* enumerations from "gstbin.h" */
 GType gst_bin_flags_get_type (void);
@@ -102,6 +104,10 @@ GType gst_iterator_result_get_type (void);
 GType gst_iterator_item_get_type (void);
 #define GST_TYPE_ITERATOR_ITEM (gst_iterator_item_get_type())
 
+/* enumerations from "gstatomicqueue.h" */
+GType gst_atomic_queue_flags_get_type (void);
+#define GST_TYPE_ATOMIC_QUEUE_FLAGS (gst_atomic_queue_flags_get_type())
+
 /* enumerations from "gstmessage.h" */
 GType gst_message_type_get_type (void);
 #define GST_TYPE_MESSAGE_TYPE (gst_message_type_get_type())